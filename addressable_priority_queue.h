@@ -0,0 +1,363 @@
+/***********************************************************************
+ * Header:
+ *    ADDRESSABLE PRIORITY QUEUE
+ * Summary:
+ *    A priority queue that hands out a handle for every element so
+ *    the element can later be changed or removed in O(log n)
+ *
+ *    This will contain the class definition of:
+ *        addressable_priority_queue : A priority queue with handles
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <functional>   // for std::less
+#include <stdexcept>    // for std::out_of_range
+#include "compare_holder.h"
+#include "heap_hole.h"
+#include "vector.h"
+
+class TestAddressablePQueue;    // forward declaration for unit test class
+
+namespace custom
+{
+
+/*************************************************
+ * ADDRESSABLE P QUEUE
+ * A heap just like priority_queue, plus two side tables
+ * kept next to the container: which id sits in each
+ * slot, and which slot each id sits in. The id of a
+ * popped or erased element is given to the next new
+ * one, so a handle also carries the generation of its
+ * id: an old handle is never mistaken for the element
+ * that reused its id. A stale handle is not contained
+ * and update, erase and get throw on it.
+ *************************************************/
+template<class T, class Compare = std::less<T>, size_t Arity = 2>
+class addressable_priority_queue : private compare_holder<Compare>
+{
+   static_assert(Arity >= 2, "a heap needs at least two children per node");
+
+   friend class ::TestAddressablePQueue; // give the unit test class access to the privates
+
+public:
+   struct handle
+   {
+      size_t id;           // which side table entry
+      size_t generation;   // which use of that entry
+      bool operator == (const handle & rhs) const { return id == rhs.id && generation == rhs.generation; }
+      bool operator != (const handle & rhs) const { return !(*this == rhs); }
+   };
+
+   //
+   // construct
+   //
+
+   addressable_priority_queue() {}
+   explicit addressable_priority_queue(const Compare & compare) : compare_holder<Compare>(compare) {}
+
+   //
+   // Access
+   //
+   const T & top() const;                  // Get the maximum item
+   handle    top_handle() const;           // Get the handle of the maximum item
+   const T & get(handle h) const;          // Get the item behind a handle
+
+   //
+   // Insert
+   //
+   handle push(const T & t);
+   handle push(T && t);
+
+   //
+   // Update
+   //
+   void update(handle h, const T & t);     // Give an element a new value
+   void update(handle h, T && t);
+
+   //
+   // Remove
+   //
+   void pop();                             // Remove the top item
+   void erase(handle h);                   // Remove the item behind a handle
+
+   //
+   // Status
+   //
+   bool   contains(handle h) const;
+   size_t size()  const            { return container.size();  }
+   bool   empty() const            { return container.empty(); }
+
+private:
+   handle pushHandle();                    // add a slot for a new element, return its handle
+   handle handleOf(size_t id) const { handle h = { id, generations[id] }; return h; }
+   void   fix(size_t indexHeap);           // the element at indexHeap changed; restore the heap
+   void   remove(size_t indexHeap);        // remove the element at indexHeap
+   void   moveSlot(size_t indexTo, size_t indexFrom);
+   void   place(size_t indexTo, T && value, size_t id);
+   size_t percolateHoleDown(size_t indexHole, const T & value);
+   size_t percolateHoleUp(size_t indexHole, const T & value);
+   size_t indexBiggerChild(size_t indexHeap) const;
+   size_t checkHandle(handle h) const;
+
+   // heap index of the parent of a heap index
+   static size_t indexParent(size_t indexHeap) { return heap_hole<Arity>::indexParent(indexHeap); }
+
+   // does lhs belong below rhs in the heap?
+   bool compare(const T & lhs, const T & rhs) const
+   {
+      return this->comparator()(lhs, rhs);
+   }
+
+   custom::vector<T>      container;       // the heap itself
+   custom::vector<size_t> handles;         // slot (heap index - 1) -> id
+   custom::vector<size_t> positions;       // id -> heap index, 0 when not in the queue
+   custom::vector<size_t> generations;     // id -> generation of the handle now using it
+   custom::vector<size_t> freeIds;         // ids that may be given out again
+};
+
+/************************************************
+ * ADDRESSABLE P QUEUE :: TOP
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+const T & addressable_priority_queue <T, Compare, Arity> :: top() const
+{
+   if (empty())
+      throw std::out_of_range("std:out_of_range");
+   return container.front();
+}
+
+template <class T, class Compare, size_t Arity>
+typename addressable_priority_queue <T, Compare, Arity> :: handle
+addressable_priority_queue <T, Compare, Arity> :: top_handle() const
+{
+   if (empty())
+      throw std::out_of_range("std:out_of_range");
+   return handleOf(handles.front());
+}
+
+/************************************************
+ * ADDRESSABLE P QUEUE :: GET
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+const T & addressable_priority_queue <T, Compare, Arity> :: get(handle h) const
+{
+   return container[checkHandle(h) - 1];
+}
+
+/************************************************
+ * ADDRESSABLE P QUEUE :: PUSH
+ * Add to the bottom of the heap and percolate up
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+typename addressable_priority_queue <T, Compare, Arity> :: handle
+addressable_priority_queue <T, Compare, Arity> :: push(const T & t)
+{
+   handle h = pushHandle();
+   container.push_back(t);
+   fix(size());
+   return h;
+}
+
+template <class T, class Compare, size_t Arity>
+typename addressable_priority_queue <T, Compare, Arity> :: handle
+addressable_priority_queue <T, Compare, Arity> :: push(T && t)
+{
+   handle h = pushHandle();
+   container.push_back(std::move(t));
+   fix(size());
+   return h;
+}
+
+/************************************************
+ * ADDRESSABLE P QUEUE :: UPDATE
+ * Replace the value and percolate whichever way it needs
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+void addressable_priority_queue <T, Compare, Arity> :: update(handle h, const T & t)
+{
+   size_t indexHeap = checkHandle(h);
+   container[indexHeap - 1] = t;
+   fix(indexHeap);
+}
+
+template <class T, class Compare, size_t Arity>
+void addressable_priority_queue <T, Compare, Arity> :: update(handle h, T && t)
+{
+   size_t indexHeap = checkHandle(h);
+   container[indexHeap - 1] = std::move(t);
+   fix(indexHeap);
+}
+
+/************************************************
+ * ADDRESSABLE P QUEUE :: POP and ERASE
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+void addressable_priority_queue <T, Compare, Arity> :: pop()
+{
+   if (!empty())
+      remove(1);
+}
+
+template <class T, class Compare, size_t Arity>
+void addressable_priority_queue <T, Compare, Arity> :: erase(handle h)
+{
+   remove(checkHandle(h));
+}
+
+/************************************************
+ * ADDRESSABLE P QUEUE :: PUSH HANDLE
+ * Reuse a free id if there is one and point it
+ * at the slot that is about to be added
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+typename addressable_priority_queue <T, Compare, Arity> :: handle
+addressable_priority_queue <T, Compare, Arity> :: pushHandle()
+{
+   size_t id;
+   if (freeIds.empty())
+   {
+      id = positions.size();
+      positions.push_back(0);
+      generations.push_back(0);
+   }
+   else
+   {
+      id = freeIds.back();
+      freeIds.pop_back();
+   }
+   handles.push_back(id);
+   positions[id] = handles.size();
+   return handleOf(id);
+}
+
+/************************************************
+ * ADDRESSABLE P QUEUE :: REMOVE
+ * Retire the handle, fill the slot with the back
+ * element, then let that element percolate whichever
+ * way it needs
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+void addressable_priority_queue <T, Compare, Arity> :: remove(size_t indexHeap)
+{
+   size_t id = handles[indexHeap - 1];
+   positions[id] = 0;
+   generations[id]++;
+   freeIds.push_back(id);
+
+   if (indexHeap != size())
+   {
+      moveSlot(indexHeap, size());
+      container.pop_back();
+      handles.pop_back();
+      fix(indexHeap);
+   }
+   else
+   {
+      container.pop_back();
+      handles.pop_back();
+   }
+}
+
+/************************************************
+ * ADDRESSABLE P QUEUE :: FIX
+ * The element at indexHeap may be out of heap order
+ * in either direction. Move a hole rather than swapping.
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+void addressable_priority_queue <T, Compare, Arity> :: fix(size_t indexHeap)
+{
+   size_t indexUp = indexParent(indexHeap);
+   size_t indexHole;
+
+   if (indexUp && compare(container[indexUp - 1], container[indexHeap - 1]))
+   {
+      size_t id = handles[indexHeap - 1];
+      T value(std::move(container[indexHeap - 1]));
+      moveSlot(indexHeap, indexUp);
+      indexHole = percolateHoleUp(indexUp, value);
+      place(indexHole, std::move(value), id);
+   }
+   else
+   {
+      size_t indexBigger = indexBiggerChild(indexHeap);
+      if (!indexBigger || !compare(container[indexHeap - 1], container[indexBigger - 1]))
+         return;
+
+      size_t id = handles[indexHeap - 1];
+      T value(std::move(container[indexHeap - 1]));
+      moveSlot(indexHeap, indexBigger);
+      indexHole = percolateHoleDown(indexBigger, value);
+      place(indexHole, std::move(value), id);
+   }
+}
+
+/************************************************
+ * ADDRESSABLE P QUEUE :: MOVE SLOT and PLACE
+ * Every move in the heap also updates the side tables
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+void addressable_priority_queue <T, Compare, Arity> :: moveSlot(size_t indexTo, size_t indexFrom)
+{
+   container[indexTo - 1] = std::move(container[indexFrom - 1]);
+   handles[indexTo - 1] = handles[indexFrom - 1];
+   positions[handles[indexTo - 1]] = indexTo;
+}
+
+template <class T, class Compare, size_t Arity>
+void addressable_priority_queue <T, Compare, Arity> :: place(size_t indexTo, T && value, size_t id)
+{
+   container[indexTo - 1] = std::move(value);
+   handles[indexTo - 1] = id;
+   positions[id] = indexTo;
+}
+
+/************************************************
+ * ADDRESSABLE P QUEUE :: PERCOLATE HOLE
+ * The same heap_hole as priority_queue, with every
+ * move keeping the tables current
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+size_t addressable_priority_queue <T, Compare, Arity> :: percolateHoleDown(size_t indexHole, const T & value)
+{
+   return heap_hole<Arity>::percolateDown(container, indexHole, value, this->comparator(),
+      [this](size_t indexTo, size_t indexFrom) { moveSlot(indexTo, indexFrom); });
+}
+
+template <class T, class Compare, size_t Arity>
+size_t addressable_priority_queue <T, Compare, Arity> :: percolateHoleUp(size_t indexHole, const T & value)
+{
+   return heap_hole<Arity>::percolateUp(container, indexHole, value, this->comparator(),
+      [this](size_t indexTo, size_t indexFrom) { moveSlot(indexTo, indexFrom); });
+}
+
+template <class T, class Compare, size_t Arity>
+size_t addressable_priority_queue <T, Compare, Arity> :: indexBiggerChild(size_t indexHeap) const
+{
+   return heap_hole<Arity>::indexBiggerChild(container, indexHeap, this->comparator());
+}
+
+/************************************************
+ * ADDRESSABLE P QUEUE :: CONTAINS
+ * The id must be in use, and by this handle's element
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+bool addressable_priority_queue <T, Compare, Arity> :: contains(handle h) const
+{
+   return h.id < positions.size() && positions[h.id] != 0 && generations[h.id] == h.generation;
+}
+
+/************************************************
+ * ADDRESSABLE P QUEUE :: CHECK HANDLE
+ * Find where a handle lives, throwing if it is not here
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+size_t addressable_priority_queue <T, Compare, Arity> :: checkHandle(handle h) const
+{
+   if (!contains(h))
+      throw std::out_of_range("std:out_of_range");
+   return positions[h.id];
+}
+
+};
@@ -0,0 +1,449 @@
+/***********************************************************************
+ * Header:
+ *    ASYNC PRIORITY QUEUE
+ * Summary:
+ *    A priority_queue that coroutines can wait on: co_await q.pop()
+ *    suspends until there is an element and resumes the coroutine on
+ *    the executor it names. Needs C++20; empty before that.
+ *
+ *    This will contain the class definitions of:
+ *        async_priority_queue : A priority queue with an awaitable pop
+ *        event_loop           : A minimal executor that resumes in FIFO order
+ ************************************************************************/
+
+#pragma once
+
+#if __cplusplus >= 202002L || _MSVC_LANG >= 202002L
+
+#include <cassert>
+#include <coroutine>    // for std::coroutine_handle
+#include <optional>     // for std::optional
+#include <mutex>        // for std::mutex
+#include <deque>        // for std::deque
+#include <functional>   // for std::less
+#include "priority_queue.h"
+
+class TestAsyncPQueue;    // forward declaration for unit test class
+
+namespace custom
+{
+
+/*************************************************
+ * EVENT LOOP
+ * Coroutines posted here are resumed in the order
+ * they were posted, by whoever calls run(). post()
+ * and cancel() may be called from any thread.
+ *************************************************/
+class event_loop
+{
+public:
+   void post(std::coroutine_handle<> handle)
+   {
+      std::lock_guard<std::mutex> guard(lock);
+      ready.push_back(handle);
+   }
+
+   // take back a post that has not run yet; false if it is not waiting
+   bool cancel(std::coroutine_handle<> handle)
+   {
+      std::lock_guard<std::mutex> guard(lock);
+      for (std::deque<std::coroutine_handle<>>::iterator it = ready.begin(); it != ready.end(); ++it)
+         if (*it == handle)
+         {
+            ready.erase(it);
+            return true;
+         }
+      return false;
+   }
+
+   // resume until nothing is left, including what those resumed post; return how many
+   size_t run()
+   {
+      size_t num = 0;
+      std::coroutine_handle<> handle;
+      while (next(handle))
+      {
+         handle.resume();
+         num++;
+      }
+      return num;
+   }
+
+   size_t size() const
+   {
+      std::lock_guard<std::mutex> guard(lock);
+      return ready.size();
+   }
+
+private:
+   bool next(std::coroutine_handle<> & handle)
+   {
+      std::lock_guard<std::mutex> guard(lock);
+      if (ready.empty())
+         return false;
+      handle = ready.front();
+      ready.pop_front();
+      return true;
+   }
+
+   mutable std::mutex                  lock;
+   std::deque<std::coroutine_handle<>> ready;
+};
+
+/*************************************************
+ * ASYNC PRIORITY QUEUE
+ * co_await pop() gives a std::optional<T>: the best
+ * element, or nothing once the queue is closed and
+ * empty. A pop that has to wait joins the end of a
+ * list of waiters; there are only waiters while the
+ * heap is empty, so each push hands its element to
+ * the waiter that has waited longest and schedules
+ * it on the executor it asked for, or resumes it
+ * right there inside push() if it named none.
+ *
+ * The waiter lives in the coroutine frame. Destroying
+ * a coroutine suspended in pop() takes it off the
+ * list, so the queue never resumes a dead frame and
+ * never keeps one alive. That holds after a push has
+ * handed it an element too: the post to the executor
+ * is made under the queue lock and cancelled by the
+ * destructor under the same lock, and the element
+ * goes to the next waiter or back into the heap. An
+ * Executor so needs post(handle) and cancel(handle).
+ * Without an executor the pushing thread resumes the
+ * waiter at once, so only destroy such a coroutine
+ * when no other thread can be pushing to it.
+ * close() resumes every waiter with nothing, so none
+ * is left suspended forever.
+ *************************************************/
+template<class T, class Compare = std::less<T>, size_t Arity = 2>
+class async_priority_queue
+{
+   friend class ::TestAsyncPQueue; // give the unit test class access to the privates
+
+public:
+   class pop_awaiter;
+
+   //
+   // construct
+   //
+
+   explicit async_priority_queue(const Compare & compare = Compare()) :
+      heap(compare), head(nullptr), tail(nullptr), numWaiters(0), closed(false) {}
+   async_priority_queue(const async_priority_queue & rhs) = delete;
+   async_priority_queue & operator = (const async_priority_queue & rhs) = delete;
+  ~async_priority_queue() { assert(head == nullptr); }
+
+   //
+   // Insert. False once the queue is closed
+   //
+   bool push(const T & t) { return pushAny(t);            }
+   bool push(T && t)      { return pushAny(std::move(t)); }
+
+   //
+   // Remove
+   //
+   pop_awaiter pop() { return pop_awaiter(*this, nullptr, nullptr, nullptr); }
+   template <class Executor>
+   pop_awaiter pop(Executor & executor)
+   {
+      return pop_awaiter(*this, &executor,
+         [](void * executor, std::coroutine_handle<> handle)
+         {
+            static_cast<Executor *>(executor)->post(handle);
+         },
+         [](void * executor, std::coroutine_handle<> handle)
+         {
+            return static_cast<Executor *>(executor)->cancel(handle);
+         });
+   }
+   bool try_pop(T & t);
+
+   //
+   // Status
+   //
+   void   close();
+   bool   is_closed()   const;
+   size_t size()        const;
+   bool   empty()       const { return size() == 0; }
+   size_t num_waiters() const;
+
+   /*************************************************
+    * POP AWAITER
+    * What co_await q.pop() waits on. One per pop, in
+    * the coroutine frame; not copyable.
+    *************************************************/
+   class pop_awaiter
+   {
+      friend class async_priority_queue;
+
+   public:
+      pop_awaiter(const pop_awaiter & rhs) = delete;
+      pop_awaiter & operator = (const pop_awaiter & rhs) = delete;
+     ~pop_awaiter();
+
+      bool await_ready() const { return false; }
+      bool await_suspend(std::coroutine_handle<> handle);
+      std::optional<T> await_resume()
+      {
+         state = IDLE;     // running again, so nothing is on its way to us
+         return std::move(value);
+      }
+
+   private:
+      typedef void (*Schedule)(void * executor, std::coroutine_handle<> handle);
+      typedef bool (*Cancel)(void * executor, std::coroutine_handle<> handle);
+
+      // guarded by the queue lock once the waiter has suspended
+      enum State { IDLE,        // not suspended in this pop
+                   WAITING,     // on the waiter list
+                   POSTED,      // handed its value and posted to the executor
+                   RESUMING };  // handed its value; the pusher is resuming it
+
+      pop_awaiter(async_priority_queue & queue, void * executor, Schedule schedule, Cancel cancel) :
+         queue(queue), executor(executor), schedule(schedule), cancel(cancel),
+         pNext(nullptr), pPrev(nullptr), state(IDLE) {}
+
+      async_priority_queue &  queue;
+      void *                  executor;   // nullptr to resume inside push
+      Schedule                schedule;
+      Cancel                  cancel;
+      std::coroutine_handle<> handle;
+      std::optional<T>        value;
+      pop_awaiter *           pNext;
+      pop_awaiter *           pPrev;
+      State                   state;
+   };
+
+private:
+   template <class U>
+   bool pushAny(U && t);
+   template <class U>
+   pop_awaiter * handOff(U && t);         // hold the lock; a waiter to resume after unlocking
+   pop_awaiter * wake(pop_awaiter * waiter); // hold the lock; same
+   void link(pop_awaiter * waiter);       // hold the lock
+   void unlink(pop_awaiter * waiter);     // hold the lock
+
+   mutable std::mutex                        lock;
+   custom::priority_queue<T, Compare, Arity> heap;
+   pop_awaiter *                             head;        // waited longest
+   pop_awaiter *                             tail;
+   size_t                                    numWaiters;
+   bool                                      closed;
+};
+
+/************************************************
+ * ASYNC PRIORITY QUEUE :: PUSH
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+template <class U>
+bool async_priority_queue <T, Compare, Arity> :: pushAny(U && t)
+{
+   pop_awaiter * waiter;
+   {
+      std::lock_guard<std::mutex> guard(lock);
+      if (closed)
+         return false;
+      waiter = handOff(std::forward<U>(t));
+   }
+   if (waiter)
+      waiter->handle.resume();
+   return true;
+}
+
+/************************************************
+ * ASYNC PRIORITY QUEUE :: HAND OFF
+ * To the oldest waiter if there is one, else the heap
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+template <class U>
+typename async_priority_queue <T, Compare, Arity> :: pop_awaiter *
+async_priority_queue <T, Compare, Arity> :: handOff(U && t)
+{
+   pop_awaiter * waiter = head;
+   if (!waiter)
+   {
+      heap.push(std::forward<U>(t));
+      return nullptr;
+   }
+   unlink(waiter);
+   waiter->value.emplace(std::forward<U>(t));
+   return wake(waiter);
+}
+
+/************************************************
+ * ASYNC PRIORITY QUEUE :: WAKE
+ * A waiter just taken off the list with its value
+ * set. Post it now, under the lock, so its destructor
+ * can always take the post back; or mark it for the
+ * caller to resume once the lock is released.
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+typename async_priority_queue <T, Compare, Arity> :: pop_awaiter *
+async_priority_queue <T, Compare, Arity> :: wake(pop_awaiter * waiter)
+{
+   if (waiter->schedule)
+   {
+      waiter->state = pop_awaiter::POSTED;
+      waiter->schedule(waiter->executor, waiter->handle);
+      return nullptr;
+   }
+   waiter->state = pop_awaiter::RESUMING;
+   return waiter;
+}
+
+/************************************************
+ * ASYNC PRIORITY QUEUE :: TRY POP
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+bool async_priority_queue <T, Compare, Arity> :: try_pop(T & t)
+{
+   std::lock_guard<std::mutex> guard(lock);
+   if (heap.empty())
+      return false;
+   t = std::move(const_cast<T &>(heap.top()));
+   heap.pop();
+   return true;
+}
+
+/************************************************
+ * ASYNC PRIORITY QUEUE :: CLOSE
+ * Refuse pushes from now on, and resume every waiter
+ * with nothing, oldest first
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+void async_priority_queue <T, Compare, Arity> :: close()
+{
+   // one at a time: a waiter resumed here may destroy others still waiting
+   for (;;)
+   {
+      pop_awaiter * waiter;
+      {
+         std::lock_guard<std::mutex> guard(lock);
+         closed = true;
+         if (!head)
+            return;
+         waiter = head;
+         unlink(waiter);
+         waiter = wake(waiter);
+      }
+      if (waiter)
+         waiter->handle.resume();
+   }
+}
+
+template <class T, class Compare, size_t Arity>
+bool async_priority_queue <T, Compare, Arity> :: is_closed() const
+{
+   std::lock_guard<std::mutex> guard(lock);
+   return closed;
+}
+
+template <class T, class Compare, size_t Arity>
+size_t async_priority_queue <T, Compare, Arity> :: size() const
+{
+   std::lock_guard<std::mutex> guard(lock);
+   return heap.size();
+}
+
+template <class T, class Compare, size_t Arity>
+size_t async_priority_queue <T, Compare, Arity> :: num_waiters() const
+{
+   std::lock_guard<std::mutex> guard(lock);
+   return numWaiters;
+}
+
+/************************************************
+ * ASYNC PRIORITY QUEUE :: LINK / UNLINK
+ * A doubly linked list through the awaiters, so one
+ * in the middle can leave when its frame is destroyed
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+void async_priority_queue <T, Compare, Arity> :: link(pop_awaiter * waiter)
+{
+   waiter->pPrev = tail;
+   waiter->pNext = nullptr;
+   if (tail)
+      tail->pNext = waiter;
+   else
+      head = waiter;
+   tail = waiter;
+   waiter->state = pop_awaiter::WAITING;
+   numWaiters++;
+}
+
+template <class T, class Compare, size_t Arity>
+void async_priority_queue <T, Compare, Arity> :: unlink(pop_awaiter * waiter)
+{
+   if (waiter->pPrev)
+      waiter->pPrev->pNext = waiter->pNext;
+   else
+      head = waiter->pNext;
+   if (waiter->pNext)
+      waiter->pNext->pPrev = waiter->pPrev;
+   else
+      tail = waiter->pPrev;
+   waiter->pNext = waiter->pPrev = nullptr;
+   waiter->state = pop_awaiter::IDLE;
+   numWaiters--;
+}
+
+/************************************************
+ * POP AWAITER :: AWAIT SUSPEND
+ * Take the top without suspending if there is one,
+ * or give up if the queue is closed; otherwise wait
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+bool async_priority_queue <T, Compare, Arity> :: pop_awaiter :: await_suspend(std::coroutine_handle<> handle)
+{
+   std::lock_guard<std::mutex> guard(queue.lock);
+   if (!queue.heap.empty())
+   {
+      value.emplace(std::move(const_cast<T &>(queue.heap.top())));
+      queue.heap.pop();
+      return false;
+   }
+   if (queue.closed)
+      return false;
+
+   this->handle = handle;
+   queue.link(this);
+   return true;
+}
+
+/************************************************
+ * POP AWAITER :: DESTRUCTOR
+ * A frame destroyed while still waiting leaves the
+ * list. One destroyed after a push handed it an
+ * element but before the executor ran it takes the
+ * post back and passes the element on, so it is not
+ * lost.
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+async_priority_queue <T, Compare, Arity> :: pop_awaiter :: ~pop_awaiter()
+{
+   if (!handle)
+      return;
+
+   pop_awaiter * waiter = nullptr;
+   {
+      std::lock_guard<std::mutex> guard(queue.lock);
+      // resuming on another thread right now: the frame is not ours to destroy
+      assert(state != RESUMING);
+      if (state == WAITING)
+         queue.unlink(this);
+      else if (state == POSTED)
+      {
+         cancel(executor, handle);
+         state = IDLE;
+         if (value)
+            waiter = queue.handOff(std::move(*value));
+      }
+   }
+   if (waiter)
+      waiter->handle.resume();
+}
+
+};
+
+#endif // C++20
@@ -0,0 +1,140 @@
+/***********************************************************************
+ * Header:
+ *    BENCHMARK ASYNC PRIORITY QUEUE
+ * Summary:
+ *    Handing elements to waiting consumers: coroutines on a single
+ *    threaded event loop against threads blocked on the condition
+ *    variables of the blocking queue. Empty before C++20.
+ ************************************************************************/
+
+#pragma once
+
+#ifdef BENCHMARK
+
+#if __cplusplus >= 202002L || _MSVC_LANG >= 202002L
+
+#include "async_priority_queue.h"
+#include "blocking_priority_queue.h"
+#include "benchmark.h"
+
+#include <coroutine>    // for std::suspend_never
+#include <exception>    // for std::terminate
+#include <thread>       // for std::thread
+#include <vector>       // for std::vector
+
+class BenchAsyncPQueue : public Benchmark
+{
+public:
+   BenchAsyncPQueue(size_t num = 1000000) : num(num) {}
+
+   void run()
+   {
+      size_t batches[] = { 1, 64 };
+      for (size_t numConsumers = 1; numConsumers <= 4; numConsumers *= 4)
+      {
+         for (size_t i = 0; i < sizeof(batches) / sizeof(batches[0]); i++)
+            bench_async(numConsumers, batches[i]);
+         bench_blocking(numConsumers);
+      }
+   }
+
+private:
+   size_t num;   // elements handed over in each run
+
+   // a coroutine that runs at once and frees itself at the end
+   struct Detached
+   {
+      struct promise_type
+      {
+         Detached get_return_object() { return Detached(); }
+         std::suspend_never initial_suspend() noexcept { return {}; }
+         std::suspend_never final_suspend()   noexcept { return {}; }
+         void return_void() {}
+         void unhandled_exception() { std::terminate(); }
+      };
+   };
+
+   static Detached consumer(custom::async_priority_queue<uint64_t> & q,
+                            custom::event_loop & loop, uint64_t & sum)
+   {
+      for (;;)
+      {
+         std::optional<uint64_t> value = co_await q.pop(loop);
+         if (!value)
+            co_return;
+         sum += *value;
+      }
+   }
+
+   /***************************************
+    * ASYNC
+    * One thread: push a batch, then let the loop run
+    * the consumers it woke
+    ***************************************/
+   void bench_async(size_t numConsumers, size_t batch)
+   {
+      custom::async_priority_queue<uint64_t> q;
+      custom::event_loop loop;
+      uint64_t sum = 0;
+      for (size_t c = 0; c < numConsumers; c++)
+         consumer(q, loop, sum);
+
+      double ms = time([&]()
+      {
+         for (size_t i = 0; i < num; i++)
+         {
+            q.push(i);
+            if (i % batch == batch - 1)
+               loop.run();
+         }
+         q.close();
+         loop.run();
+      });
+      consume(sum);
+      report("AsyncPQueue", "event loop " + std::to_string(numConsumers) + " consumers batch " +
+             std::to_string(batch), num, ms);
+   }
+
+   /***************************************
+    * BLOCKING
+    * A producer thread and consumer threads waiting on
+    * condition variables
+    ***************************************/
+   void bench_blocking(size_t numConsumers)
+   {
+      custom::blocking_priority_queue<uint64_t> q(1024);
+      double ms = time([&]()
+      {
+         std::vector<std::thread> consumers;
+         for (size_t c = 0; c < numConsumers; c++)
+            consumers.push_back(std::thread([&q]()
+            {
+               uint64_t value;
+               uint64_t sum = 0;
+               while (q.pop_wait(value))
+                  sum += value;
+               consume(sum);
+            }));
+         for (size_t i = 0; i < num; i++)
+            q.push(i);
+         q.close();
+         for (size_t c = 0; c < consumers.size(); c++)
+            consumers[c].join();
+      });
+      report("AsyncPQueue", "condition variable " + std::to_string(numConsumers) + " consumers",
+             num, ms);
+   }
+};
+
+#else
+
+// coroutines need C++20: nothing to time
+class BenchAsyncPQueue
+{
+public:
+   void run() {}
+};
+
+#endif // C++20
+
+#endif // BENCHMARK
@@ -0,0 +1,99 @@
+/***********************************************************************
+ * Header:
+ *    BENCHMARK BOUNDED PRIORITY QUEUE
+ * Summary:
+ *    The best K of a stream of random keys: the bounded queue
+ *    against a min-heap priority_queue kept at K by hand
+ ************************************************************************/
+
+#pragma once
+
+#ifdef BENCHMARK
+
+#include "bounded_priority_queue.h"
+#include "priority_queue.h"
+#include "benchmark.h"
+
+#include <functional>   // for std::greater
+
+class BenchBoundedPQueue : public Benchmark
+{
+public:
+   BenchBoundedPQueue(size_t num = 10000000) : num(num) {}
+
+   void run()
+   {
+      custom::vector <uint64_t> keys;
+      keys.reserve(num);
+      for (size_t i = 0; i < num; i++)
+         keys.push_back(random());
+
+      for (size_t k = 10; k <= 100000; k *= 100)
+      {
+         bench_bounded(keys, k);
+         bench_pushPop(keys, k);
+         bench_pushThenPop(keys, k);
+      }
+   }
+
+private:
+   size_t num;   // length of the stream
+
+   /***************************************
+    * BOUNDED
+    ***************************************/
+   void bench_bounded(const custom::vector <uint64_t> & keys, size_t k)
+   {
+      custom::bounded_priority_queue <uint64_t> pq(k);
+      double ms = time([&]()
+      {
+         for (size_t i = 0; i < keys.size(); i++)
+            pq.push(keys[i]);
+      });
+      custom::vector <uint64_t> best = pq.extract_sorted();
+      consume(best[0]);
+      report("BoundedPQueue", "bounded k=" + std::to_string(k), keys.size(), ms);
+   }
+
+   /***************************************
+    * PUSH POP
+    * A min-heap that is filled to k, then fed
+    * through push_pop
+    ***************************************/
+   void bench_pushPop(const custom::vector <uint64_t> & keys, size_t k)
+   {
+      custom::priority_queue <uint64_t, std::greater<uint64_t>> pq;
+      double ms = time([&]()
+      {
+         for (size_t i = 0; i < keys.size(); i++)
+            if (pq.size() < k)
+               pq.push(keys[i]);
+            else
+               consume(pq.push_pop(keys[i]));
+         consume(pq.top());
+      });
+      report("BoundedPQueue", "priority_queue push_pop k=" + std::to_string(k), keys.size(), ms);
+   }
+
+   /***************************************
+    * PUSH THEN POP
+    * The same with a push and a pop each time
+    ***************************************/
+   void bench_pushThenPop(const custom::vector <uint64_t> & keys, size_t k)
+   {
+      custom::priority_queue <uint64_t, std::greater<uint64_t>> pq;
+      double ms = time([&]()
+      {
+         for (size_t i = 0; i < keys.size(); i++)
+         {
+            pq.push(keys[i]);
+            if (pq.size() > k)
+               pq.pop();
+         }
+         consume(pq.top());
+      });
+      report("BoundedPQueue", "priority_queue push, pop k=" + std::to_string(k), keys.size(), ms);
+   }
+};
+
+#endif // BENCHMARK
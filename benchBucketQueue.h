@@ -0,0 +1,74 @@
+/***********************************************************************
+ * Header:
+ *    BENCHMARK BUCKET QUEUE
+ * Summary:
+ *    Timing for the bucket queue against the array heap
+ ************************************************************************/
+
+#pragma once
+
+#ifdef BENCHMARK
+
+#include "bucket_queue.h"
+#include "priority_queue.h"
+#include "benchmark.h"
+
+#include <utility>   // for std::pair
+
+class BenchBucketQueue : public Benchmark
+{
+public:
+   BenchBucketQueue(size_t num = 2000000) : num(num) {}
+
+   void run()
+   {
+      // Hold with 256 QoS classes
+      bench_holdArray();
+      bench_holdBucket();
+   }
+
+private:
+   size_t num;   // number of pop/push pairs in each run
+
+   void bench_holdArray()
+   {
+      // the sequence number keeps equal priorities in FIFO order, as the bucket queue does
+      typedef std::pair<uint32_t, uint64_t> Item;
+      custom::priority_queue <Item> heap;
+      std::mt19937_64 rand(232);
+      uint64_t sequence = ~uint64_t(0);
+      for (size_t i = 0; i < num / 10; i++)
+         heap.push(Item(uint32_t(rand() % 256), sequence--));
+      double ms = time([&]()
+      {
+         for (size_t i = 0; i < num; i++)
+         {
+            consume(heap.top().second);
+            heap.pop();
+            heap.push(Item(uint32_t(rand() % 256), sequence--));
+         }
+      });
+      report("BucketQueue", "priority_queue hold 256 priorities", num * 2, ms);
+   }
+
+   void bench_holdBucket()
+   {
+      custom::bucket_queue <uint64_t, 256> q;
+      std::mt19937_64 rand(232);
+      uint64_t sequence = 0;
+      for (size_t i = 0; i < num / 10; i++)
+         q.push(rand() % 256, sequence++);
+      double ms = time([&]()
+      {
+         for (size_t i = 0; i < num; i++)
+         {
+            consume(q.top());
+            q.pop();
+            q.push(rand() % 256, sequence++);
+         }
+      });
+      report("BucketQueue", "bucket_queue hold 256 priorities", num * 2, ms);
+   }
+};
+
+#endif // BENCHMARK
@@ -0,0 +1,84 @@
+/***********************************************************************
+ * Header:
+ *    BENCHMARK BUFFERED PRIORITY QUEUE
+ * Summary:
+ *    Push storms from many threads, and mixed push/pop, for the
+ *    buffered queue against one heap behind a mutex
+ ************************************************************************/
+
+#pragma once
+
+#ifdef BENCHMARK
+
+#include "buffered_priority_queue.h"
+#include "benchmark.h"
+
+#include <thread>    // for std::thread
+#include <vector>    // for std::vector
+
+class BenchBufferedPQueue : public Benchmark
+{
+public:
+   BenchBufferedPQueue(size_t num = 4000000) : num(num) {}
+
+   void run()
+   {
+      size_t maxThreads = std::thread::hardware_concurrency();
+      if (maxThreads < 4)
+         maxThreads = 4;
+      size_t capacities[] = {16, 64, 256};
+      for (size_t numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+      {
+         LockedHeap<uint64_t> locked;
+         report("BufferedPQueue", "storm mutex heap " + std::to_string(numThreads) + " threads",
+                num, storm(locked, numThreads));
+         for (size_t i = 0; i < sizeof(capacities) / sizeof(capacities[0]); i++)
+         {
+            custom::buffered_priority_queue<uint64_t> q(capacities[i]);
+            report("BufferedPQueue", "storm b=" + std::to_string(capacities[i]) + " " +
+                   std::to_string(numThreads) + " threads", num, storm(q, numThreads));
+         }
+      }
+      for (size_t numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+      {
+         LockedHeap<uint64_t> locked;
+         report("BufferedPQueue", "hold mutex heap " + std::to_string(numThreads) + " threads",
+                num * 2, holdThreads(locked, numThreads, num));
+         custom::buffered_priority_queue<uint64_t> q(64);
+         report("BufferedPQueue", "hold b=64 " + std::to_string(numThreads) + " threads",
+                num * 2, holdThreads(q, numThreads, num));
+      }
+   }
+
+private:
+   size_t num;   // elements pushed in each run
+
+   /***************************************
+    * STORM
+    * Every thread pushes its share at once; time that,
+    * and the first pop that has to see all of it
+    ***************************************/
+   template <class Queue>
+   double storm(Queue & q, size_t numThreads)
+   {
+      uint64_t value = 0;
+      double ms = time([&]()
+      {
+         std::vector<std::thread> threads;
+         for (size_t t = 0; t < numThreads; t++)
+            threads.push_back(std::thread([&q, t, numThreads, this]()
+            {
+               std::mt19937_64 rand(232 + t);
+               for (size_t i = 0; i < num / numThreads; i++)
+                  q.push(rand());
+            }));
+         for (size_t t = 0; t < numThreads; t++)
+            threads[t].join();
+         q.try_pop(value);
+      });
+      consume(value);
+      return ms;
+   }
+};
+
+#endif // BENCHMARK
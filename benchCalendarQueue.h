@@ -0,0 +1,54 @@
+/***********************************************************************
+ * Header:
+ *    BENCHMARK CALENDAR QUEUE
+ * Summary:
+ *    Timing for the calendar queue against the array heap
+ ************************************************************************/
+
+#pragma once
+
+#ifdef BENCHMARK
+
+#include "calendar_queue.h"
+#include "priority_queue.h"
+#include "benchmark.h"
+
+class BenchCalendarQueue : public Benchmark
+{
+public:
+   BenchCalendarQueue(size_t num = 2000000) : num(num) {}
+
+   void run()
+   {
+      // Hold model: pop the earliest event, schedule one a random time later
+      bench_hold<custom::priority_queue <double, std::greater<double>>>("priority_queue hold 10k",  10000);
+      bench_hold<custom::calendar_queue <double>>                      ("calendar_queue hold 10k",  10000);
+      bench_hold<custom::priority_queue <double, std::greater<double>>>("priority_queue hold 1M", 1000000);
+      bench_hold<custom::calendar_queue <double>>                      ("calendar_queue hold 1M", 1000000);
+   }
+
+private:
+   size_t num;   // number of pop/push pairs in each run
+
+   template <class Queue>
+   void bench_hold(const std::string & name, size_t numPending)
+   {
+      Queue q;
+      std::mt19937_64 rand(232);
+      std::exponential_distribution<double> increment(1.0);
+      for (size_t i = 0; i < numPending; i++)
+         q.push(increment(rand));
+      double ms = time([&]()
+      {
+         for (size_t i = 0; i < num; i++)
+         {
+            double now = q.top();
+            q.pop();
+            q.push(now + increment(rand));
+         }
+      });
+      report("CalendarQueue", name, num * 2, ms);
+   }
+};
+
+#endif // BENCHMARK
@@ -0,0 +1,54 @@
+/***********************************************************************
+ * Header:
+ *    BENCHMARK COMBINING PRIORITY QUEUE
+ * Summary:
+ *    Flat combining against one heap behind a std::mutex
+ ************************************************************************/
+
+#pragma once
+
+#ifdef BENCHMARK
+
+#include "combining_priority_queue.h"
+#include "benchmark.h"
+
+#include <thread>    // for std::thread::hardware_concurrency
+
+class BenchCombiningPQueue : public Benchmark
+{
+public:
+   BenchCombiningPQueue(size_t num = 2000000) : num(num) {}
+
+   void run()
+   {
+      size_t maxThreads = std::thread::hardware_concurrency();
+      if (maxThreads < 4)
+         maxThreads = 4;
+      for (size_t numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+      {
+         bench_mutex(numThreads);
+         bench_combining(numThreads);
+      }
+   }
+
+private:
+   size_t num;   // total number of push/pop pairs, shared among the threads
+
+   void bench_mutex(size_t numThreads)
+   {
+      LockedHeap<uint64_t> q;
+      double ms = holdThreads(q, numThreads, num);
+      report("CombiningPQueue", "mutex heap " + std::to_string(numThreads) + " threads",
+             num * 2, ms);
+   }
+
+   void bench_combining(size_t numThreads)
+   {
+      custom::combining_priority_queue<uint64_t> q;
+      double ms = holdThreads(q, numThreads, num);
+      report("CombiningPQueue", "combining " + std::to_string(numThreads) + " threads",
+             num * 2, ms);
+   }
+};
+
+#endif // BENCHMARK
@@ -0,0 +1,124 @@
+/***********************************************************************
+ * Header:
+ *    BENCHMARK K-LSM PRIORITY QUEUE
+ * Summary:
+ *    Throughput and rank error of the k-LSM queue as k and the
+ *    number of threads grow
+ ************************************************************************/
+
+#pragma once
+
+#ifdef BENCHMARK
+
+#include "klsm_priority_queue.h"
+#include "benchmark.h"
+
+#include <atomic>    // for std::atomic
+#include <thread>    // for std::thread
+#include <vector>    // for std::vector
+
+class BenchKLSMPQueue : public Benchmark
+{
+public:
+   BenchKLSMPQueue(size_t num = 2000000, size_t numRank = 200000) : num(num), numRank(numRank) {}
+
+   void run()
+   {
+      size_t maxThreads = std::thread::hardware_concurrency();
+      if (maxThreads < 4)
+         maxThreads = 4;
+      size_t ks[] = {0, 16, 256, 4096};
+      for (size_t numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+      {
+         bench_mutex(numThreads);
+         for (size_t i = 0; i < sizeof(ks) / sizeof(ks[0]); i++)
+            bench_klsm(ks[i], numThreads);
+      }
+   }
+
+private:
+   size_t num;       // total number of push/pop pairs in the throughput runs
+   size_t numRank;   // number of keys in the rank error runs
+
+   void bench_mutex(size_t numThreads)
+   {
+      LockedHeap<uint64_t> q;
+      double ms = holdThreads(q, numThreads, num);
+      report("KLSMPQueue", "mutex heap " + std::to_string(numThreads) + " threads",
+             num * 2, ms);
+   }
+
+   void bench_klsm(size_t k, size_t numThreads)
+   {
+      std::string name = "k=" + std::to_string(k) + " " + std::to_string(numThreads) + " threads";
+      {
+         custom::klsm_priority_queue<uint64_t> q(k);
+         double ms = holdThreads(q, numThreads, num);
+         report("KLSMPQueue", "k-lsm " + name, num * 2, ms);
+      }
+      rankError(k, numThreads, name);
+   }
+
+   /***************************************
+    * RANK ERROR
+    * Every thread pushes its share of the keys 0..n-1,
+    * then all of them pop until the queue is empty, each
+    * pop stamped from one shared counter. Replaying the
+    * pops in stamp order, the rank error of a pop is how
+    * many keys still present were better than it.
+    ***************************************/
+   void rankError(size_t k, size_t numThreads, const std::string & name)
+   {
+      custom::klsm_priority_queue<uint64_t> q(k);
+      std::vector<uint64_t> popped(numRank);
+      std::atomic<size_t> stamp(0);
+      std::vector<std::thread> threads;
+      for (size_t t = 0; t < numThreads; t++)
+         threads.push_back(std::thread([&, t]()
+         {
+            for (size_t i = t; i < numRank; i += numThreads)
+               q.push((i * 2654435761u) % numRank);   // a permutation of 0..n-1 for odd n
+         }));
+      for (size_t t = 0; t < numThreads; t++)
+         threads[t].join();
+      threads.clear();
+      for (size_t t = 0; t < numThreads; t++)
+         threads.push_back(std::thread([&]()
+         {
+            uint64_t value;
+            while (q.try_pop(value))
+               popped[stamp++] = value;
+         }));
+      for (size_t t = 0; t < numThreads; t++)
+         threads[t].join();
+
+      // a Fenwick tree counts the keys still present above each key
+      std::vector<size_t> tree(numRank + 1, 0);
+      for (size_t i = 1; i <= numRank; i++)
+         for (size_t j = i; j <= numRank; j += j & (0 - j))
+            tree[j]++;
+      double total = 0.0;
+      size_t worst = 0;
+      size_t numPopped = stamp.load();
+      for (size_t i = 0; i < numPopped; i++)
+      {
+         size_t atMost = 0;
+         for (size_t j = popped[i] + 1; j > 0; j -= j & (0 - j))
+            atMost += tree[j];
+         size_t rank = (numPopped - i) - atMost;
+         total += rank;
+         worst = rank > worst ? rank : worst;
+         for (size_t j = popped[i] + 1; j <= numRank; j += j & (0 - j))
+            tree[j]--;
+      }
+
+      std::cout.setf(std::ios::fixed | std::ios::showpoint);
+      std::cout.precision(2);
+      std::cout << "KLSMPQueue:\t"
+                << std::left  << std::setw(36) << ("rank error " + name)
+                << std::right << std::setw(10) << total / numPopped << " mean  "
+                << std::setw(10) << worst << " max\n";
+   }
+};
+
+#endif // BENCHMARK
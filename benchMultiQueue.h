@@ -0,0 +1,56 @@
+/***********************************************************************
+ * Header:
+ *    BENCHMARK MULTI QUEUE
+ * Summary:
+ *    Thread scaling of the sharded queue against one heap behind a mutex
+ ************************************************************************/
+
+#pragma once
+
+#ifdef BENCHMARK
+
+#include "multi_queue.h"
+#include "priority_queue.h"
+#include "benchmark.h"
+
+#include <thread>    // for std::thread::hardware_concurrency
+
+class BenchMultiQueue : public Benchmark
+{
+public:
+   BenchMultiQueue(size_t num = 4000000) : num(num) {}
+
+   void run()
+   {
+      size_t maxThreads = std::thread::hardware_concurrency();
+      if (maxThreads < 4)
+         maxThreads = 4;
+      for (size_t numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+      {
+         bench_mutex(numThreads);
+         bench_multi(numThreads, 2);
+         bench_multi(numThreads, 4);
+      }
+   }
+
+private:
+   size_t num;   // total number of push/pop pairs, shared among the threads
+
+   void bench_mutex(size_t numThreads)
+   {
+      LockedHeap<uint64_t> q;
+      double ms = holdThreads(q, numThreads, num);
+      report("MultiQueue", "mutex heap " + std::to_string(numThreads) + " threads",
+             num * 2, ms);
+   }
+
+   void bench_multi(size_t numThreads, size_t shardsPerThread)
+   {
+      custom::multi_queue<uint64_t> q(numThreads, shardsPerThread);
+      double ms = holdThreads(q, numThreads, num);
+      report("MultiQueue", "multi_queue c=" + std::to_string(shardsPerThread) + " " +
+             std::to_string(numThreads) + " threads", num * 2, ms);
+   }
+};
+
+#endif // BENCHMARK
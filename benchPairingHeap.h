@@ -0,0 +1,119 @@
+/***********************************************************************
+ * Header:
+ *    BENCHMARK PAIRING HEAP
+ * Summary:
+ *    Timing for the pairing heap against the array heap
+ ************************************************************************/
+
+#pragma once
+
+#ifdef BENCHMARK
+
+#include "pairing_heap.h"
+#include "priority_queue.h"
+#include "benchmark.h"
+
+class BenchPairingHeap : public Benchmark
+{
+public:
+   BenchPairingHeap(size_t num = 1000000) : num(num) {}
+
+   void run()
+   {
+      // Insert heavy: four pushes for every pop
+      bench_insertHeavy<custom::priority_queue <uint64_t>>("priority_queue insert-heavy");
+      bench_insertHeavy<custom::pairing_heap <uint64_t>>  ("pairing_heap insert-heavy");
+
+      // Hold: pop one, push one a random distance below it
+      bench_hold<custom::priority_queue <uint64_t>>("priority_queue hold");
+      bench_hold<custom::pairing_heap <uint64_t>>  ("pairing_heap hold");
+
+      // Merge: combine many small heaps into one
+      bench_mergeArray();
+      bench_mergePairing();
+   }
+
+private:
+   size_t num;   // number of operations in each run
+
+   template <class Heap>
+   void bench_insertHeavy(const std::string & name)
+   {
+      Heap heap;
+      std::mt19937_64 rand(232);
+      double ms = time([&]()
+      {
+         for (size_t i = 0; i < num; i++)
+         {
+            heap.push(rand() % num);
+            if (i % 4 == 3)
+            {
+               consume(heap.top());
+               heap.pop();
+            }
+         }
+      });
+      report("PairingHeap", name, num * 5 / 4, ms);
+   }
+
+   template <class Heap>
+   void bench_hold(const std::string & name)
+   {
+      Heap heap;
+      std::mt19937_64 rand(232);
+      for (size_t i = 0; i < num / 10; i++)
+         heap.push(uint64_t(1) << 40 | rand() % num);
+      double ms = time([&]()
+      {
+         for (size_t i = 0; i < num; i++)
+         {
+            uint64_t top = heap.top();
+            heap.pop();
+            heap.push(top - rand() % 1000);
+         }
+      });
+      report("PairingHeap", name, num * 2, ms);
+   }
+
+   void bench_mergeArray()
+   {
+      const size_t numHeaps = 1000;
+      custom::vector <custom::priority_queue <uint64_t> *> heaps(numHeaps);
+      for (size_t i = 0; i < numHeaps; i++)
+         heaps[i] = new custom::priority_queue <uint64_t>;
+      for (size_t i = 0; i < num; i++)
+         heaps[i % numHeaps]->push(random() % num);
+      double ms = time([&]()
+      {
+         for (size_t i = 1; i < numHeaps; i++)
+            while (!heaps[i]->empty())
+            {
+               heaps[0]->push(heaps[i]->top());
+               heaps[i]->pop();
+            }
+      });
+      report("PairingHeap", "priority_queue merge 1000 heaps", num, ms);
+      for (size_t i = 0; i < numHeaps; i++)
+         delete heaps[i];
+   }
+
+   void bench_mergePairing()
+   {
+      const size_t numHeaps = 1000;
+      custom::vector <custom::pairing_heap <uint64_t> *> heaps(numHeaps);
+      for (size_t i = 0; i < numHeaps; i++)
+         heaps[i] = new custom::pairing_heap <uint64_t>;
+      for (size_t i = 0; i < num; i++)
+         heaps[i % numHeaps]->push(random() % num);
+      double ms = time([&]()
+      {
+         for (size_t i = 1; i < numHeaps; i++)
+            heaps[0]->merge(*heaps[i]);
+      });
+      report("PairingHeap", "pairing_heap merge 1000 heaps", num, ms);
+      for (size_t i = 0; i < numHeaps; i++)
+         delete heaps[i];
+   }
+};
+
+#endif // BENCHMARK
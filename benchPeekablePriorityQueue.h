@@ -0,0 +1,129 @@
+/***********************************************************************
+ * Header:
+ *    BENCHMARK PEEKABLE PRIORITY QUEUE
+ * Summary:
+ *    Writers pushing and popping while monitor threads read the top,
+ *    through the seqlock against through the writers' mutex
+ ************************************************************************/
+
+#pragma once
+
+#ifdef BENCHMARK
+
+#include "peekable_priority_queue.h"
+#include "benchmark.h"
+
+#include <atomic>    // for std::atomic
+#include <thread>    // for std::thread
+#include <vector>    // for std::vector
+
+class BenchPeekablePQueue : public Benchmark
+{
+public:
+   BenchPeekablePQueue(size_t num = 2000000) : num(num) {}
+
+   void run()
+   {
+      for (size_t numReaders = 0; numReaders <= 4; numReaders = numReaders ? numReaders * 2 : 1)
+      {
+         bench_locked(numReaders);
+         bench_peekable(numReaders);
+      }
+   }
+
+private:
+   size_t num;   // push/pop pairs shared between the two writers
+
+   /***************************************
+    * LOCKED
+    * A reader takes the writers' mutex to read the top
+    ***************************************/
+   void bench_locked(size_t numReaders)
+   {
+      LockedHeap<uint64_t> q;
+      bench("mutex top", numReaders, q, [&q](uint64_t & value)
+      {
+         std::lock_guard<std::mutex> guard(q.lock);
+         if (q.heap.empty())
+            return false;
+         value = q.heap.top();
+         return true;
+      });
+   }
+
+   /***************************************
+    * PEEKABLE
+    * A reader copies the published top
+    ***************************************/
+   void bench_peekable(size_t numReaders)
+   {
+      custom::peekable_priority_queue<uint64_t> q;
+      bench("seqlock peek", numReaders, q, [&q](uint64_t & value)
+      {
+         return q.peek(value);
+      });
+   }
+
+   /***************************************
+    * BENCH
+    * Two writers alternate push and pop; the readers
+    * read the top as fast as they can until the writers
+    * are done. Report the writers' throughput and the
+    * readers' reads.
+    ***************************************/
+   template <class Queue, class Read>
+   void bench(const std::string & name, size_t numReaders, Queue & q, Read read)
+   {
+      for (size_t i = 0; i < num / 10; i++)
+         q.push(random());
+
+      std::atomic<bool> done(false);
+      std::atomic<uint64_t> numReads(0);
+      std::vector<std::thread> readers;
+      for (size_t r = 0; r < numReaders; r++)
+         readers.push_back(std::thread([&done, &numReads, read]()
+         {
+            uint64_t value = 0;
+            uint64_t num = 0;
+            uint64_t sum = 0;
+            while (!done.load(std::memory_order_relaxed))
+            {
+               if (read(value))
+                  sum += value;
+               num++;
+            }
+            numReads += num;
+            consume(sum);
+         }));
+
+      double ms = time([&]()
+      {
+         std::vector<std::thread> writers;
+         for (size_t t = 0; t < 2; t++)
+            writers.push_back(std::thread([&q, t, this]()
+            {
+               std::mt19937_64 rand(232 + t);
+               uint64_t value = 0;
+               for (size_t i = 0; i < num / 2; i++)
+               {
+                  q.push(rand());
+                  q.try_pop(value);
+               }
+               consume(value);
+            }));
+         for (size_t t = 0; t < writers.size(); t++)
+            writers[t].join();
+      });
+      done.store(true);
+      for (size_t r = 0; r < readers.size(); r++)
+         readers[r].join();
+
+      std::string label = name + " " + std::to_string(numReaders) + " readers";
+      report("PeekablePQueue", label, num * 2, ms);
+      std::cout << "PeekablePQueue:\t" << std::left << std::setw(36) << label
+                << std::right << std::setw(10) << (ms > 0.0 ? numReads.load() / ms / 1000.0 : 0.0)
+                << " M reads/s\n";
+   }
+};
+
+#endif // BENCHMARK
@@ -0,0 +1,131 @@
+/***********************************************************************
+ * Header:
+ *    BENCHMARK PRIORITY EXECUTOR
+ * Summary:
+ *    Fork-join throughput of the work-stealing executor as the
+ *    workers grow, and how long urgent tasks wait behind a flood
+ *    of background tasks
+ ************************************************************************/
+
+#pragma once
+
+#ifdef BENCHMARK
+
+#include "priority_executor.h"
+#include "benchmark.h"
+
+#include <atomic>    // for std::atomic
+#include <chrono>    // for std::chrono::steady_clock
+#include <thread>    // for std::thread::hardware_concurrency
+
+class BenchPriorityExecutor : public Benchmark
+{
+public:
+   BenchPriorityExecutor(int depth = 18, size_t numFlood = 20000) :
+      depth(depth), numFlood(numFlood) {}
+
+   void run()
+   {
+      size_t maxThreads = std::thread::hardware_concurrency();
+      if (maxThreads < 4)
+         maxThreads = 4;
+      for (size_t numWorkers = 1; numWorkers <= maxThreads; numWorkers *= 2)
+      {
+         bench_forkJoin(numWorkers, custom::priority_executor::STEAL_RANDOM,  "random");
+         bench_forkJoin(numWorkers, custom::priority_executor::STEAL_RICHEST, "richest");
+      }
+      for (size_t numWorkers = 1; numWorkers <= maxThreads; numWorkers *= 2)
+      {
+         bench_inversion(numWorkers, true);
+         bench_inversion(numWorkers, false);
+      }
+   }
+
+private:
+   int    depth;      // the fork-join tree has 2^(depth+1)-1 tasks
+   size_t numFlood;   // background tasks in the inversion runs
+
+   /***************************************
+    * FORK JOIN
+    * A binary tree of tiny tasks, each spawning its two
+    * children: all the work starts on one worker and has
+    * to be stolen to spread
+    ***************************************/
+   void bench_forkJoin(size_t numWorkers, custom::priority_executor::steal_policy policy,
+                       const std::string & policyName)
+   {
+      custom::priority_executor e(numWorkers, policy);
+      std::atomic<uint64_t> sum(0);
+      double ms = time([&]()
+      {
+         e.submit(depth, [this, &e, &sum]() { fork(e, sum, depth); });
+         e.wait();
+      });
+      consume(sum.load());
+      report("PriorityExecutor", "fork-join " + policyName + " " +
+             std::to_string(numWorkers) + " workers", ((size_t)2 << depth) - 1, ms);
+   }
+
+   static void fork(custom::priority_executor & e, std::atomic<uint64_t> & sum, int depth)
+   {
+      if (depth == 0)
+      {
+         sum++;
+         return;
+      }
+      // a bigger subtree has a higher priority, so thieves take the big pieces
+      for (int i = 0; i < 2; i++)
+         e.submit(depth - 1, [&e, &sum, depth]() { fork(e, sum, depth - 1); });
+   }
+
+   /***************************************
+    * PRIORITY INVERSION
+    * Queue a flood of background tasks, then submit one
+    * urgent task for every hundred of them while they run.
+    * With priorities the urgent ones jump the flood; with
+    * everything at one priority they wait their turn.
+    ***************************************/
+   void bench_inversion(size_t numWorkers, bool usePriorities)
+   {
+      typedef std::chrono::steady_clock clock;
+      custom::priority_executor e(numWorkers);
+      std::atomic<uint64_t> sum(0);
+      std::atomic<int64_t> totalWait(0);   // nanoseconds
+      size_t numUrgent = numFlood / 100;
+
+      double ms = time([&]()
+      {
+         for (size_t i = 0; i < numFlood; i++)
+            e.submit(0, [&sum, i]()
+            {
+               uint64_t x = i | 1;
+               for (int j = 0; j < 2000; j++)   // a few microseconds of work
+                  x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+               sum += x;
+            });
+         for (size_t i = 0; i < numUrgent; i++)
+         {
+            clock::time_point submitted = clock::now();
+            e.submit(usePriorities ? 1 : 0, [&totalWait, submitted]()
+            {
+               totalWait += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                 clock::now() - submitted).count();
+            });
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+         }
+         e.wait();
+      });
+      consume(sum.load());
+
+      std::cout.setf(std::ios::fixed | std::ios::showpoint);
+      std::cout.precision(2);
+      std::cout << "PriorityExecutor:\t"
+                << std::left  << std::setw(36)
+                << (std::string(usePriorities ? "urgent first " : "one priority ") +
+                    std::to_string(numWorkers) + " workers")
+                << std::right << std::setw(10) << ms << " ms  "
+                << std::setw(10) << totalWait.load() / 1e6 / numUrgent << " ms urgent wait\n";
+   }
+};
+
+#endif // BENCHMARK
@@ -0,0 +1,322 @@
+/***********************************************************************
+ * Header:
+ *    BENCHMARK PRIORITY QUEUE
+ * Summary:
+ *    Timing for the priority queue
+ ************************************************************************/
+
+#pragma once
+
+#ifdef BENCHMARK
+
+#include "priority_queue.h"
+#include "benchmark.h"
+
+#include <iterator>   // for std::make_move_iterator
+#include <vector>     // for std::vector
+
+class BenchPQueue : public Benchmark
+{
+public:
+   BenchPQueue(size_t num = 1000000) : num(num) {}
+
+   void run()
+   {
+      // Arity
+      bench_arity<int>("int");
+      bench_arity<double>("double");
+      bench_arity<Payload64>("payload64");
+
+      // Batches
+      bench_batch(10000);
+      bench_batch(100000);
+      bench_batch(1000000);
+
+      // Bulk build
+      bench_build(false);
+      bench_build(true);
+
+      // Exchange
+      bench_exchange(1000);
+      bench_exchange(100000);
+
+      // Merge
+      for (size_t ratio = 1; ratio <= 4096; ratio *= 16)
+         bench_merge(ratio);
+   }
+
+private:
+   size_t num;   // number of elements in each heap
+
+   /***************************************
+    * ARITY
+    * Push num random keys then pop them all
+    ***************************************/
+   template <class T>
+   void bench_arity(const std::string & type)
+   {
+      custom::vector <uint64_t> keys;
+      keys.reserve(num);
+      for (size_t i = 0; i < num; i++)
+         keys.push_back(random() % (num * 4));
+
+      bench_pushPop<T, 2>(keys, type + " arity 2");
+      bench_pushPop<T, 4>(keys, type + " arity 4");
+      bench_pushPop<T, 8>(keys, type + " arity 8");
+   }
+
+   template <class T, size_t Arity>
+   void bench_pushPop(const custom::vector <uint64_t> & keys, const std::string & name)
+   {
+      custom::priority_queue <T, std::less<T>, Arity> pq;
+      double ms = time([&]()
+      {
+         for (size_t i = 0; i < keys.size(); i++)
+            pq.push(T(keys[i]));
+         while (!pq.empty())
+         {
+            consume(keyOf(pq.top()));
+            pq.pop();
+         }
+      });
+      report("PQueue", name, keys.size() * 2, ms);
+   }
+
+   /***************************************
+    * BUILD
+    * num keys into an empty heap: pushed one at a time,
+    * through the range constructor by copy and by move.
+    * Random keys barely sift up; ascending ones, like a
+    * sorted snapshot, sift all the way every time.
+    ***************************************/
+   void bench_build(bool ascending)
+   {
+      std::vector <Payload64> keys;
+      keys.reserve(num);
+      for (size_t i = 0; i < num; i++)
+         keys.push_back(Payload64(ascending ? i : random()));
+      std::string order = ascending ? " ascending" : " random";
+
+      {
+         custom::priority_queue <Payload64> pq;
+         double ms = time([&]()
+         {
+            for (size_t i = 0; i < keys.size(); i++)
+               pq.push(keys[i]);
+         });
+         consume(keyOf(pq.top()));
+         report("PQueue", "build by push" + order, num, ms);
+      }
+      {
+         double ms = time([&]()
+         {
+            custom::priority_queue <Payload64> pq(keys.begin(), keys.end());
+            consume(keyOf(pq.top()));
+         });
+         report("PQueue", "build range copy" + order, num, ms);
+      }
+      {
+         double ms = time([&]()
+         {
+            custom::priority_queue <Payload64> pq(std::make_move_iterator(keys.begin()),
+                                                  std::make_move_iterator(keys.end()));
+            consume(keyOf(pq.top()));
+         });
+         report("PQueue", "build range move" + order, num, ms);
+      }
+   }
+
+   /***************************************
+    * EXCHANGE
+    * The steady state of a scheduler and of a top-k
+    * filter over num random keys, with k in the heap:
+    * pop then push against replace_top, and push then
+    * pop against push_pop
+    ***************************************/
+   void bench_exchange(size_t k)
+   {
+      custom::vector <uint64_t> keys;
+      for (size_t i = 0; i < num; i++)
+         keys.push_back(random());
+      custom::vector <uint64_t> start;
+      for (size_t i = 0; i < k; i++)
+         start.push_back(random());
+      std::string size = " k=" + std::to_string(k);
+
+      // scheduler: always take the top, always put something back
+      {
+         custom::priority_queue <uint64_t> pq(start);
+         double ms = time([&]()
+         {
+            for (size_t i = 0; i < keys.size(); i++)
+            {
+               consume(pq.top());
+               pq.pop();
+               pq.push(keys[i]);
+            }
+         });
+         report("PQueue", "pop then push" + size, num, ms);
+      }
+      {
+         custom::priority_queue <uint64_t> pq(start);
+         double ms = time([&]()
+         {
+            for (size_t i = 0; i < keys.size(); i++)
+               consume(pq.replace_top(keys[i]));
+         });
+         report("PQueue", "replace_top" + size, num, ms);
+      }
+
+      // top k largest: a min-heap of the best so far, each key pushed and the worst popped
+      {
+         custom::priority_queue <uint64_t, std::greater<uint64_t>> pq(start);
+         double ms = time([&]()
+         {
+            for (size_t i = 0; i < keys.size(); i++)
+            {
+               pq.push(keys[i]);
+               consume(pq.top());
+               pq.pop();
+            }
+         });
+         report("PQueue", "push then pop" + size, num, ms);
+      }
+      {
+         custom::priority_queue <uint64_t, std::greater<uint64_t>> pq(start);
+         double ms = time([&]()
+         {
+            for (size_t i = 0; i < keys.size(); i++)
+               consume(pq.push_pop(keys[i]));
+         });
+         report("PQueue", "push_pop" + size, num, ms);
+      }
+   }
+
+   /***************************************
+    * MERGE
+    * Fold a small heap into one ratio times its size,
+    * num keys between them: merge, one push per element
+    * of the small one, and always rebuilding from both
+    ***************************************/
+   void bench_merge(size_t ratio)
+   {
+      size_t numSmall = num / (ratio + 1);
+      custom::vector <uint64_t> keysLarge;
+      custom::vector <uint64_t> keysSmall;
+      for (size_t i = 0; i < num - numSmall; i++)
+         keysLarge.push_back(random());
+      for (size_t i = 0; i < numSmall; i++)
+         keysSmall.push_back(random());
+      const custom::priority_queue <uint64_t> large(keysLarge);
+      const custom::priority_queue <uint64_t> small(keysSmall);
+      std::string label = " 1:" + std::to_string(ratio);
+
+      {
+         custom::priority_queue <uint64_t> pq(large);
+         custom::priority_queue <uint64_t> rhs(small);
+         double ms = time([&]()
+         {
+            pq.merge(std::move(rhs));
+         });
+         consume(pq.top());
+         report("PQueue", "merge" + label, numSmall, ms);
+      }
+      {
+         custom::priority_queue <uint64_t> pq(large);
+         custom::priority_queue <uint64_t> rhs(small);
+         double ms = time([&]()
+         {
+            while (!rhs.empty())
+            {
+               pq.push(rhs.top());
+               rhs.pop();
+            }
+         });
+         consume(pq.top());
+         report("PQueue", "merge by push" + label, numSmall, ms);
+      }
+      {
+         // what merge would cost if it always heapified: everything, rebuilt
+         custom::vector <uint64_t> both(keysLarge);
+         for (size_t i = 0; i < keysSmall.size(); i++)
+            both.push_back(keysSmall[i]);
+         uint64_t top = 0;
+         double ms = time([&]()
+         {
+            custom::priority_queue <uint64_t> pq(std::move(both));
+            top = pq.top();
+         });
+         consume(top);
+         report("PQueue", "merge by rebuild" + label, numSmall, ms);
+      }
+   }
+
+   /***************************************
+    * BATCH
+    * Push then pop k keys against a heap of num keys:
+    * one at a time, as one batch on one thread, and as
+    * one batch on every core
+    ***************************************/
+   void bench_batch(size_t k)
+   {
+      custom::vector <uint64_t> keys;
+      for (size_t i = 0; i < num; i++)
+         keys.push_back(random());
+      custom::vector <uint64_t> batch;
+      for (size_t i = 0; i < k; i++)
+         batch.push_back(random());
+      custom::priority_queue <uint64_t> base(std::move(keys));
+      std::string size = " k=" + std::to_string(k);
+
+      {
+         custom::priority_queue <uint64_t> pq(base);
+         double ms = time([&]()
+         {
+            for (size_t i = 0; i < batch.size(); i++)
+               pq.push(batch[i]);
+         });
+         report("PQueue", "push one by one" + size, k, ms);
+      }
+      for (size_t numThreads = 1; numThreads < 3; numThreads++)
+      {
+         custom::priority_queue <uint64_t> pq(base);
+         double ms = time([&]()
+         {
+            pq.push_batch(batch.begin(), batch.end(), numThreads == 1 ? 1 : 0);
+         });
+         report("PQueue", std::string(numThreads == 1 ? "push_batch 1 thread" : "push_batch all cores") + size,
+                k, ms);
+      }
+
+      {
+         custom::priority_queue <uint64_t> pq(base);
+         custom::vector <uint64_t> out;
+         out.reserve(k);
+         double ms = time([&]()
+         {
+            for (size_t i = 0; i < k; i++)
+            {
+               out.push_back(pq.top());
+               pq.pop();
+            }
+         });
+         consume(out[0]);
+         report("PQueue", "pop one by one" + size, k, ms);
+      }
+      for (size_t numThreads = 1; numThreads < 3; numThreads++)
+      {
+         custom::priority_queue <uint64_t> pq(base);
+         custom::vector <uint64_t> out;
+         out.reserve(k);
+         double ms = time([&]()
+         {
+            pq.pop_batch(k, out, numThreads == 1 ? 1 : 0);
+         });
+         consume(out[0]);
+         report("PQueue", std::string(numThreads == 1 ? "pop_batch 1 thread" : "pop_batch all cores") + size,
+                k, ms);
+      }
+   }
+};
+
+#endif // BENCHMARK
@@ -0,0 +1,73 @@
+/***********************************************************************
+ * Header:
+ *    BENCHMARK RADIX HEAP
+ * Summary:
+ *    Timing for the radix heap against the array heap
+ ************************************************************************/
+
+#pragma once
+
+#ifdef BENCHMARK
+
+#include "radix_heap.h"
+#include "priority_queue.h"
+#include "benchmark.h"
+
+#include <utility>   // for std::pair
+
+class BenchRadixHeap : public Benchmark
+{
+public:
+   BenchRadixHeap(size_t num = 2000000) : num(num) {}
+
+   void run()
+   {
+      // Monotone hold: pop the minimum, push something a little later
+      bench_holdArray(1000);
+      bench_holdRadix(1000);
+      bench_holdArray(1000000);
+      bench_holdRadix(1000000);
+   }
+
+private:
+   size_t num;   // number of pop/push pairs in each run
+
+   void bench_holdArray(uint64_t range)
+   {
+      typedef std::pair<uint64_t, uint32_t> Item;
+      custom::priority_queue <Item, std::greater<Item>> heap;
+      std::mt19937_64 rand(232);
+      for (size_t i = 0; i < num / 10; i++)
+         heap.push(Item(rand() % range, uint32_t(i)));
+      double ms = time([&]()
+      {
+         for (size_t i = 0; i < num; i++)
+         {
+            Item item = heap.top();
+            heap.pop();
+            heap.push(Item(item.first + rand() % range, item.second));
+         }
+      });
+      report("RadixHeap", "priority_queue hold range " + std::to_string(range), num * 2, ms);
+   }
+
+   void bench_holdRadix(uint64_t range)
+   {
+      custom::radix_heap <uint64_t, uint32_t> heap;
+      std::mt19937_64 rand(232);
+      for (size_t i = 0; i < num / 10; i++)
+         heap.push(rand() % range, uint32_t(i));
+      double ms = time([&]()
+      {
+         for (size_t i = 0; i < num; i++)
+         {
+            std::pair<uint64_t, uint32_t> item = heap.top();
+            heap.pop();
+            heap.push(item.first + rand() % range, item.second);
+         }
+      });
+      report("RadixHeap", "radix_heap hold range " + std::to_string(range), num * 2, ms);
+   }
+};
+
+#endif // BENCHMARK
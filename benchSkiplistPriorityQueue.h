@@ -0,0 +1,54 @@
+/***********************************************************************
+ * Header:
+ *    BENCHMARK SKIPLIST PRIORITY QUEUE
+ * Summary:
+ *    Throughput of the lock-free skiplist against one heap behind a mutex
+ ************************************************************************/
+
+#pragma once
+
+#ifdef BENCHMARK
+
+#include "skiplist_priority_queue.h"
+#include "benchmark.h"
+
+#include <thread>    // for std::thread::hardware_concurrency
+
+class BenchSkiplistPQueue : public Benchmark
+{
+public:
+   BenchSkiplistPQueue(size_t num = 2000000) : num(num) {}
+
+   void run()
+   {
+      size_t maxThreads = std::thread::hardware_concurrency();
+      if (maxThreads < 4)
+         maxThreads = 4;
+      for (size_t numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+      {
+         bench_mutex(numThreads);
+         bench_skiplist(numThreads);
+      }
+   }
+
+private:
+   size_t num;   // total number of push/pop pairs, shared among the threads
+
+   void bench_mutex(size_t numThreads)
+   {
+      LockedHeap<uint64_t> q;
+      double ms = holdThreads(q, numThreads, num);
+      report("SkiplistPQueue", "mutex heap " + std::to_string(numThreads) + " threads",
+             num * 2, ms);
+   }
+
+   void bench_skiplist(size_t numThreads)
+   {
+      custom::skiplist_priority_queue<uint64_t> q;
+      double ms = holdThreads(q, numThreads, num);
+      report("SkiplistPQueue", "skiplist " + std::to_string(numThreads) + " threads",
+             num * 2, ms);
+   }
+};
+
+#endif // BENCHMARK
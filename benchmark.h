@@ -0,0 +1,150 @@
+/***********************************************************************
+ * Header:
+ *    BENCHMARK
+ * Summary:
+ *    The base class to all the benchmark classes
+ ************************************************************************/
+
+#pragma once
+
+#ifdef BENCHMARK
+
+#include <iostream>  // for std::cout
+#include <iomanip>   // for std::setw
+#include <chrono>    // for std::chrono::steady_clock
+#include <random>    // for std::mt19937_64
+#include <cstdint>   // for uint64_t
+#include <string>    // for std::string
+#include <mutex>     // for std::mutex
+#include <thread>    // for std::thread
+#include <vector>    // for std::vector
+#include "priority_queue.h"
+
+/*************************************************************
+ * PAYLOAD
+ * A 64-byte record with a key, one cache line per element
+ *************************************************************/
+struct Payload64
+{
+   uint64_t key;
+   char     pad[56];
+
+   Payload64() : key(0), pad{} {}
+   Payload64(uint64_t key) : key(key), pad{} {}
+   bool operator <  (const Payload64 & rhs) const { return key <  rhs.key; }
+   bool operator >  (const Payload64 & rhs) const { return key >  rhs.key; }
+   bool operator == (const Payload64 & rhs) const { return key == rhs.key; }
+};
+
+/*************************************************************
+ * LOCKED HEAP
+ * One priority_queue behind one mutex: what the concurrent
+ * queues are measured against
+ *************************************************************/
+template <class T>
+struct LockedHeap
+{
+   std::mutex lock;
+   custom::priority_queue<T> heap;
+
+   void push(const T & t)
+   {
+      std::lock_guard<std::mutex> guard(lock);
+      heap.push(t);
+   }
+   bool try_pop(T & t)
+   {
+      std::lock_guard<std::mutex> guard(lock);
+      if (heap.empty())
+         return false;
+      t = heap.top();
+      heap.pop();
+      return true;
+   }
+};
+
+class Benchmark
+{
+public:
+   Benchmark() : random(232) {}
+
+protected:
+   std::mt19937_64 random;   // fixed seed so every run sees the same data
+
+   /*************************************************************
+    * TIME
+    * Run a piece of code once and return the milliseconds it took
+    *************************************************************/
+   template <class Function>
+   static double time(Function function)
+   {
+      auto begin = std::chrono::steady_clock::now();
+      function();
+      auto end = std::chrono::steady_clock::now();
+      return std::chrono::duration<double, std::milli>(end - begin).count();
+   }
+
+   /*************************************************************
+    * HOLD THREADS
+    * Prefill a concurrent queue, then let every thread alternate
+    * try_pop and push until num pairs are done between them
+    *************************************************************/
+   template <class Queue>
+   double holdThreads(Queue & q, size_t numThreads, size_t num)
+   {
+      for (size_t i = 0; i < num / 10; i++)
+         q.push(random());
+
+      return time([&]()
+      {
+         std::vector<std::thread> threads;
+         for (size_t t = 0; t < numThreads; t++)
+            threads.push_back(std::thread([&q, t, numThreads, num]()
+            {
+               std::mt19937_64 rand(232 + t);
+               uint64_t value = 0;
+               uint64_t sum = 0;
+               for (size_t i = 0; i < num / numThreads; i++)
+               {
+                  if (q.try_pop(value))
+                     sum += value;
+                  q.push(rand());
+               }
+               consume(sum);
+            }));
+         for (size_t t = 0; t < numThreads; t++)
+            threads[t].join();
+      });
+   }
+
+   /*************************************************************
+    * REPORT
+    * Display one line of results
+    *************************************************************/
+   static void report(const std::string & suite, const std::string & name,
+                      size_t numOperations, double milliseconds)
+   {
+      std::cout.setf(std::ios::fixed | std::ios::showpoint);
+      std::cout.precision(2);
+      std::cout << suite << ":\t"
+                << std::left  << std::setw(36) << name
+                << std::right << std::setw(10) << milliseconds << " ms  "
+                << std::setw(10) << (milliseconds > 0.0 ? numOperations / milliseconds / 1000.0 : 0.0)
+                << " Mops/s\n";
+   }
+
+   /*************************************************************
+    * CHECKSUM
+    * Keep the optimizer from discarding results we never read
+    *************************************************************/
+   static void consume(uint64_t value)
+   {
+      static volatile uint64_t sink;
+      sink = sink + value;
+   }
+   template <class T>
+   static uint64_t keyOf(const T & t)         { return (uint64_t)t; }
+   static uint64_t keyOf(const Payload64 & t) { return t.key;       }
+};
+
+#endif // BENCHMARK
@@ -0,0 +1,46 @@
+/***********************************************************************
+ * Header:
+ *    BITS
+ * Summary:
+ *    Portable bit scanning for the integer-keyed queues
+ ************************************************************************/
+
+#pragma once
+
+#include <cstdint>   // for uint64_t
+#include <cstddef>   // for size_t
+
+#ifdef _MSC_VER
+#include <intrin.h>  // for _BitScanReverse64
+#endif
+
+namespace custom
+{
+
+/************************************************
+ * BIT WIDTH
+ * The number of bits needed to hold x: 0 for 0,
+ * 1 for 1, 2 for 2..3, ... 64 for the top bit set
+ ***********************************************/
+inline size_t bit_width(uint64_t x)
+{
+   if (x == 0)
+      return 0;
+#if defined(__GNUC__) || defined(__clang__)
+   return 64 - __builtin_clzll(x);
+#elif defined(_MSC_VER) && defined(_WIN64)
+   unsigned long index;
+   _BitScanReverse64(&index, x);
+   return index + 1;
+#else
+   size_t width = 0;
+   while (x)
+   {
+      x >>= 1;
+      width++;
+   }
+   return width;
+#endif
+}
+
+};
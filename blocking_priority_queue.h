@@ -0,0 +1,308 @@
+/***********************************************************************
+ * Header:
+ *    BLOCKING PRIORITY QUEUE
+ * Summary:
+ *    A bounded priority_queue for handing work between threads:
+ *    producers wait while it is full, consumers while it is empty
+ *
+ *    This will contain the class definition of:
+ *        blocking_priority_queue : A thread-safe priority queue with a capacity
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <mutex>                // for std::mutex, std::unique_lock
+#include <condition_variable>   // for std::condition_variable
+#include <chrono>               // for std::chrono::duration
+#include <functional>           // for std::less
+#include "priority_queue.h"
+#include "vector.h"
+
+class TestBlockingPQueue;    // forward declaration for unit test class
+
+namespace custom
+{
+
+/*************************************************
+ * BLOCKING PRIORITY QUEUE
+ * One lock and two condition variables: producers wait
+ * on notFull, consumers on notEmpty. Every push wakes
+ * at most one consumer and every pop at most one
+ * producer, and only if one is actually waiting, so no
+ * thread wakes up just to go back to sleep. close()
+ * wakes everyone: pushes fail from then on, and pops
+ * drain what is left and then fail.
+ *************************************************/
+template<class T, class Compare = std::less<T>, size_t Arity = 2>
+class blocking_priority_queue
+{
+   friend class ::TestBlockingPQueue; // give the unit test class access to the privates
+
+public:
+
+   //
+   // construct
+   //
+
+   explicit blocking_priority_queue(size_t capacity, const Compare & compare = Compare()) :
+      heap(compare), capacity(capacity ? capacity : 1), closed(false),
+      numWaitingProducers(0), numWaitingConsumers(0) {}
+   blocking_priority_queue(const blocking_priority_queue & rhs) = delete;
+   blocking_priority_queue & operator = (const blocking_priority_queue & rhs) = delete;
+
+   //
+   // Insert. False if the queue is closed
+   //
+   bool push(const T & t);               // wait for room
+   bool push(T && t);
+   bool try_push(const T & t);           // false if full
+   bool try_push(T && t);
+
+   //
+   // Remove. False if the queue is closed and empty
+   //
+   bool pop_wait(T & t);                 // wait for an element
+   template <class Rep, class Period>
+   bool pop_wait(T & t, const std::chrono::duration<Rep, Period> & timeout);   // false on timeout
+   bool try_pop(T & t);                  // false if empty
+   size_t pop_n(custom::vector<T> & out, size_t n);   // append up to n, best first
+
+   //
+   // Status
+   //
+   void   close();
+   bool   is_closed() const;
+   size_t size()  const;
+   bool   empty() const { return size() == 0; }
+   size_t max_size() const { return capacity; }
+
+private:
+   template <class U>
+   bool pushWait(U && t);
+   template <class U>
+   bool pushTry(U && t);
+   void take(T & t);                     // pop the top; hold the lock
+   void wakeConsumer();                  // after a push; hold the lock
+   void wakeProducers(size_t numFreed);  // after popping numFreed; hold the lock
+
+   mutable std::mutex                        lock;
+   std::condition_variable                   notFull;
+   std::condition_variable                   notEmpty;
+   custom::priority_queue<T, Compare, Arity> heap;
+   size_t                                    capacity;
+   bool                                      closed;
+   size_t                                    numWaitingProducers;
+   size_t                                    numWaitingConsumers;
+};
+
+/************************************************
+ * BLOCKING PRIORITY QUEUE :: PUSH
+ * Wait until there is room or the queue closes
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+bool blocking_priority_queue <T, Compare, Arity> :: push(const T & t)
+{
+   return pushWait(t);
+}
+
+template <class T, class Compare, size_t Arity>
+bool blocking_priority_queue <T, Compare, Arity> :: push(T && t)
+{
+   return pushWait(std::move(t));
+}
+
+template <class T, class Compare, size_t Arity>
+template <class U>
+bool blocking_priority_queue <T, Compare, Arity> :: pushWait(U && t)
+{
+   std::unique_lock<std::mutex> guard(lock);
+   while (!closed && heap.size() >= capacity)
+   {
+      numWaitingProducers++;
+      notFull.wait(guard);
+      numWaitingProducers--;
+   }
+   if (closed)
+      return false;
+
+   heap.push(std::forward<U>(t));
+   wakeConsumer();
+   return true;
+}
+
+/************************************************
+ * BLOCKING PRIORITY QUEUE :: TRY PUSH
+ * Never wait
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+bool blocking_priority_queue <T, Compare, Arity> :: try_push(const T & t)
+{
+   return pushTry(t);
+}
+
+template <class T, class Compare, size_t Arity>
+bool blocking_priority_queue <T, Compare, Arity> :: try_push(T && t)
+{
+   return pushTry(std::move(t));
+}
+
+template <class T, class Compare, size_t Arity>
+template <class U>
+bool blocking_priority_queue <T, Compare, Arity> :: pushTry(U && t)
+{
+   std::lock_guard<std::mutex> guard(lock);
+   if (closed || heap.size() >= capacity)
+      return false;
+
+   heap.push(std::forward<U>(t));
+   wakeConsumer();
+   return true;
+}
+
+/************************************************
+ * BLOCKING PRIORITY QUEUE :: POP WAIT
+ * Wait until there is an element, the queue closes,
+ * or the timeout runs out
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+bool blocking_priority_queue <T, Compare, Arity> :: pop_wait(T & t)
+{
+   std::unique_lock<std::mutex> guard(lock);
+   while (!closed && heap.empty())
+   {
+      numWaitingConsumers++;
+      notEmpty.wait(guard);
+      numWaitingConsumers--;
+   }
+   if (heap.empty())
+      return false;
+
+   take(t);
+   wakeProducers(1);
+   return true;
+}
+
+template <class T, class Compare, size_t Arity>
+template <class Rep, class Period>
+bool blocking_priority_queue <T, Compare, Arity> :: pop_wait(T & t,
+                                   const std::chrono::duration<Rep, Period> & timeout)
+{
+   auto deadline = std::chrono::steady_clock::now() + timeout;
+   std::unique_lock<std::mutex> guard(lock);
+   while (!closed && heap.empty())
+   {
+      numWaitingConsumers++;
+      std::cv_status status = notEmpty.wait_until(guard, deadline);
+      numWaitingConsumers--;
+      if (status == std::cv_status::timeout)
+         break;
+   }
+   if (heap.empty())
+      return false;
+
+   take(t);
+   wakeProducers(1);
+   return true;
+}
+
+/************************************************
+ * BLOCKING PRIORITY QUEUE :: TRY POP
+ * Never wait
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+bool blocking_priority_queue <T, Compare, Arity> :: try_pop(T & t)
+{
+   std::lock_guard<std::mutex> guard(lock);
+   if (heap.empty())
+      return false;
+
+   take(t);
+   wakeProducers(1);
+   return true;
+}
+
+/************************************************
+ * BLOCKING PRIORITY QUEUE :: POP N
+ * Move up to n elements out under one lock, best
+ * first, and wake as many producers as there is now
+ * room for. Never waits; returns how many it took.
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+size_t blocking_priority_queue <T, Compare, Arity> :: pop_n(custom::vector<T> & out, size_t n)
+{
+   std::lock_guard<std::mutex> guard(lock);
+   size_t numTaken = 0;
+   for (; numTaken < n && !heap.empty(); numTaken++)
+   {
+      T t;
+      take(t);
+      out.push_back(std::move(t));
+   }
+   wakeProducers(numTaken);
+   return numTaken;
+}
+
+/************************************************
+ * BLOCKING PRIORITY QUEUE :: CLOSE
+ * Wake every waiter so it can see the queue closed
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+void blocking_priority_queue <T, Compare, Arity> :: close()
+{
+   std::lock_guard<std::mutex> guard(lock);
+   closed = true;
+   notFull.notify_all();
+   notEmpty.notify_all();
+}
+
+template <class T, class Compare, size_t Arity>
+bool blocking_priority_queue <T, Compare, Arity> :: is_closed() const
+{
+   std::lock_guard<std::mutex> guard(lock);
+   return closed;
+}
+
+template <class T, class Compare, size_t Arity>
+size_t blocking_priority_queue <T, Compare, Arity> :: size() const
+{
+   std::lock_guard<std::mutex> guard(lock);
+   return heap.size();
+}
+
+/************************************************
+ * BLOCKING PRIORITY QUEUE :: TAKE
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+void blocking_priority_queue <T, Compare, Arity> :: take(T & t)
+{
+   t = std::move(const_cast<T &>(heap.top()));
+   heap.pop();
+}
+
+/************************************************
+ * BLOCKING PRIORITY QUEUE :: WAKE
+ * Only signal a condition somebody is waiting on, and
+ * only as many times as there are elements or slots
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+void blocking_priority_queue <T, Compare, Arity> :: wakeConsumer()
+{
+   if (numWaitingConsumers)
+      notEmpty.notify_one();
+}
+
+template <class T, class Compare, size_t Arity>
+void blocking_priority_queue <T, Compare, Arity> :: wakeProducers(size_t numFreed)
+{
+   if (numFreed >= numWaitingProducers)
+   {
+      if (numWaitingProducers)
+         notFull.notify_all();
+   }
+   else
+      for (size_t i = 0; i < numFreed; i++)
+         notFull.notify_one();
+}
+
+};
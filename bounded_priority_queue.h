@@ -0,0 +1,231 @@
+/***********************************************************************
+ * Header:
+ *    BOUNDED PRIORITY QUEUE
+ * Summary:
+ *    Keeps the best K elements of a stream in storage that is
+ *    allocated once and never grows
+ *
+ *    This will contain the class definition of:
+ *        bounded_priority_queue : A top-K priority queue
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <functional>   // for std::less
+#include <stdexcept>    // for std::out_of_range
+#include "compare_holder.h"
+#include "vector.h"
+
+class TestBoundedPQueue;    // forward declaration for unit test class
+
+namespace custom
+{
+
+/*************************************************
+ * BOUNDED P QUEUE
+ * Best means what priority_queue would put on top, so
+ * std::less keeps the K largest. The heap is upside
+ * down: the worst element kept is at the root, where
+ * a candidate is compared against it once. Anything
+ * not better is turned away with that one compare;
+ * anything better takes the root's place and sifts
+ * down. Once full the queue never grows or shrinks.
+ *************************************************/
+template<class T, class Compare = std::less<T>, size_t Arity = 2>
+class bounded_priority_queue : private compare_holder<Compare>
+{
+   static_assert(Arity >= 2, "a heap needs at least two children per node");
+
+   friend class ::TestBoundedPQueue; // give the unit test class access to the privates
+
+public:
+
+   //
+   // construct
+   //
+
+   explicit bounded_priority_queue(size_t capacity, const Compare & compare = Compare()) :
+      compare_holder<Compare>(compare), numCapacity(capacity)
+   {
+      container.reserve(capacity);
+   }
+
+   //
+   // Access
+   //
+   const T & worst() const;             // what a candidate has to beat once full
+
+   //
+   // Insert. True if t was kept
+   //
+   bool push(const T & t);
+   bool push(T && t);
+
+   //
+   // Remove
+   //
+   custom::vector<T> extract_sorted();  // everything kept, best first; leaves the queue empty
+   void clear() { container.clear(); }
+
+   //
+   // Status
+   //
+   size_t size()     const { return container.size();         }
+   size_t capacity() const { return numCapacity;              }
+   bool   empty()    const { return container.empty();        }
+   bool   full()     const { return size() == numCapacity;    }
+
+private:
+   template <class U>
+   bool pushAny(U && t);
+   size_t percolateHoleDown(size_t indexHole, size_t numHeap, const T & value);
+   size_t percolateHoleUp(size_t indexHole, const T & value);
+   size_t indexWorstChild(size_t indexHeap, size_t numHeap) const;
+
+   // heap index of the first child and the parent of a heap index
+   static size_t indexChild(size_t indexHeap)  { return Arity * (indexHeap - 1) + 2; }
+   static size_t indexParent(size_t indexHeap) { return indexHeap > 1 ? (indexHeap - 2) / Arity + 1 : 0; }
+
+   // is lhs worse than rhs, so nearer the root?
+   bool worse(const T & lhs, const T & rhs) const
+   {
+      return this->comparator()(lhs, rhs);
+   }
+
+   custom::vector<T> container;   // the heap, worst on top; reserved to numCapacity
+   size_t            numCapacity; // K
+};
+
+/************************************************
+ * BOUNDED P QUEUE :: WORST
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+const T & bounded_priority_queue <T, Compare, Arity> :: worst() const
+{
+   if (empty())
+      throw std::out_of_range("std:out_of_range");
+   return container.front();
+}
+
+/************************************************
+ * BOUNDED P QUEUE :: PUSH
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+bool bounded_priority_queue <T, Compare, Arity> :: push(const T & t)
+{
+   return pushAny(t);
+}
+
+template <class T, class Compare, size_t Arity>
+bool bounded_priority_queue <T, Compare, Arity> :: push(T && t)
+{
+   return pushAny(std::move(t));
+}
+
+/************************************************
+ * BOUNDED P QUEUE :: PUSH ANY
+ * Fill up to K with ordinary pushes into the room
+ * reserved up front. After that, one compare against
+ * the root decides; a tie loses, so among equals the
+ * ones that came first stay.
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+template <class U>
+bool bounded_priority_queue <T, Compare, Arity> :: pushAny(U && t)
+{
+   if (!full())
+   {
+      container.push_back(std::forward<U>(t));
+      size_t indexUp = indexParent(size());
+      if (indexUp && worse(container.back(), container[indexUp - 1]))
+      {
+         T value(std::move(container.back()));
+         container.back() = std::move(container[indexUp - 1]);
+         container[percolateHoleUp(indexUp, value) - 1] = std::move(value);
+      }
+      return true;
+   }
+
+   if (numCapacity == 0 || !worse(container.front(), t))
+      return false;
+
+   T value(std::forward<U>(t));
+   container[percolateHoleDown(1, size(), value) - 1] = std::move(value);
+   return true;
+}
+
+/************************************************
+ * BOUNDED P QUEUE :: EXTRACT SORTED
+ * Heapsort in place: swap the worst to the end of the
+ * shrinking heap until it is gone, which leaves the
+ * container best first. Then hand over the container
+ * itself, so the result is the storage the queue
+ * filled, and reserve fresh room for the next round.
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+custom::vector<T> bounded_priority_queue <T, Compare, Arity> :: extract_sorted()
+{
+   for (size_t numHeap = size(); numHeap > 1; numHeap--)
+   {
+      T value(std::move(container[numHeap - 1]));
+      container[numHeap - 1] = std::move(container.front());
+      container[percolateHoleDown(1, numHeap - 1, value) - 1] = std::move(value);
+   }
+
+   custom::vector<T> sorted(std::move(container));
+   container.reserve(numCapacity);
+   return sorted;
+}
+
+/************************************************
+ * BOUNDED P QUEUE :: PERCOLATE HOLE
+ * As in priority_queue, with the first numHeap slots
+ * the heap so extract_sorted can shrink it in place
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+size_t bounded_priority_queue <T, Compare, Arity> :: percolateHoleDown(size_t indexHole, size_t numHeap, const T & value)
+{
+   size_t indexWorst;
+   while ((indexWorst = indexWorstChild(indexHole, numHeap)) &&
+          worse(container[indexWorst - 1], value))
+   {
+      container[indexHole - 1] = std::move(container[indexWorst - 1]);
+      indexHole = indexWorst;
+   }
+   return indexHole;
+}
+
+template <class T, class Compare, size_t Arity>
+size_t bounded_priority_queue <T, Compare, Arity> :: percolateHoleUp(size_t indexHole, const T & value)
+{
+   size_t indexUp;
+   while ((indexUp = indexParent(indexHole)) &&
+          worse(value, container[indexUp - 1]))
+   {
+      container[indexHole - 1] = std::move(container[indexUp - 1]);
+      indexHole = indexUp;
+   }
+   return indexHole;
+}
+
+/************************************************
+ * BOUNDED P QUEUE :: INDEX WORST CHILD
+ * The child that belongs nearest the root, or 0 for a leaf
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+size_t bounded_priority_queue <T, Compare, Arity> :: indexWorstChild(size_t indexHeap, size_t numHeap) const
+{
+   size_t indexFirst = indexChild(indexHeap);
+   if (indexFirst > numHeap)
+      return 0;
+
+   size_t indexWorst = indexFirst;
+   size_t indexLast = indexFirst + Arity - 1 < numHeap ? indexFirst + Arity - 1 : numHeap;
+   for (size_t index = indexFirst + 1; index <= indexLast; index++)
+      if (worse(container[index - 1], container[indexWorst - 1]))
+         indexWorst = index;
+   return indexWorst;
+}
+
+};
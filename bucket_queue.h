@@ -0,0 +1,204 @@
+/***********************************************************************
+ * Header:
+ *    BUCKET QUEUE
+ * Summary:
+ *    A priority queue for a small, fixed range of integer priorities
+ *    with O(1) push and pop
+ *
+ *    This will contain the class definition of:
+ *        bucket_queue           : A FIFO queue for every priority
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>      // for uint64_t
+#include <stdexcept>    // for std::out_of_range
+#include "vector.h"
+#include "bits.h"
+
+class TestBucketQueue;    // forward declaration for unit test class
+
+namespace custom
+{
+
+/*************************************************
+ * BUCKET QUEUE
+ * One FIFO bucket per priority 0..NumPriorities-1, and
+ * a bitmap with a bit set for every non-empty bucket.
+ * A summary word has a bit set for every non-zero bitmap
+ * word, so finding the highest priority is two bit scans
+ * no matter how many buckets there are. Like
+ * priority_queue, the highest priority comes out first;
+ * equal priorities come out in the order they went in.
+ *************************************************/
+template<class T, size_t NumPriorities = 256>
+class bucket_queue
+{
+   static_assert(NumPriorities > 0 && NumPriorities <= 64 * 64,
+                 "the summary word covers at most 4096 priorities");
+
+   friend class ::TestBucketQueue; // give the unit test class access to the privates
+
+public:
+
+   //
+   // construct
+   //
+
+   bucket_queue() : summary(0), numElements(0)
+   {
+      for (size_t i = 0; i < NUM_WORDS; i++)
+         bitmap[i] = 0;
+   }
+
+   //
+   // Access
+   //
+   const T & top() const;              // the oldest element with the highest priority
+   size_t    top_priority() const;
+
+   //
+   // Insert
+   //
+   void push(size_t priority, const T & t);
+   void push(size_t priority, T && t);
+
+   //
+   // Remove
+   //
+   void pop();
+
+   //
+   // Status
+   //
+   size_t size()  const { return numElements;      }
+   bool   empty() const { return numElements == 0; }
+
+private:
+   enum { NUM_WORDS = (NumPriorities + 63) / 64,
+          MIN_COMPACT = 32 };    // do not bother sliding buckets with fewer popped slots
+
+   // a FIFO: the live elements are items[head..size)
+   struct Bucket
+   {
+      Bucket() : head(0) {}
+      custom::vector<T> items;
+      size_t            head;
+   };
+
+   Bucket & checkPriority(size_t priority);
+   void     mark(size_t priority);
+   void     unmark(size_t priority);
+
+   Bucket   buckets[NumPriorities];
+   uint64_t bitmap[NUM_WORDS];     // bit p set when bucket p is not empty
+   uint64_t summary;               // bit w set when bitmap[w] is not zero
+   size_t   numElements;
+};
+
+/************************************************
+ * BUCKET QUEUE :: TOP
+ * Scan the summary, then the bitmap word it points to
+ ***********************************************/
+template <class T, size_t NumPriorities>
+size_t bucket_queue <T, NumPriorities> :: top_priority() const
+{
+   if (empty())
+      throw std::out_of_range("std:out_of_range");
+   size_t word = bit_width(summary) - 1;
+   return word * 64 + bit_width(bitmap[word]) - 1;
+}
+
+template <class T, size_t NumPriorities>
+const T & bucket_queue <T, NumPriorities> :: top() const
+{
+   const Bucket & bucket = buckets[top_priority()];
+   return bucket.items[bucket.head];
+}
+
+/************************************************
+ * BUCKET QUEUE :: PUSH
+ * Append to the back of the bucket
+ ***********************************************/
+template <class T, size_t NumPriorities>
+void bucket_queue <T, NumPriorities> :: push(size_t priority, const T & t)
+{
+   checkPriority(priority).items.push_back(t);
+   mark(priority);
+   numElements++;
+}
+
+template <class T, size_t NumPriorities>
+void bucket_queue <T, NumPriorities> :: push(size_t priority, T && t)
+{
+   checkPriority(priority).items.push_back(std::move(t));
+   mark(priority);
+   numElements++;
+}
+
+/************************************************
+ * BUCKET QUEUE :: POP
+ * Take from the front of the highest bucket. An empty
+ * bucket is reset; a bucket that never empties slides
+ * its live elements down once half of it is popped.
+ ***********************************************/
+template <class T, size_t NumPriorities>
+void bucket_queue <T, NumPriorities> :: pop()
+{
+   if (empty())
+      return;
+
+   size_t priority = top_priority();
+   Bucket & bucket = buckets[priority];
+   bucket.head++;
+   numElements--;
+
+   if (bucket.head == bucket.items.size())
+   {
+      bucket.items.clear();
+      bucket.head = 0;
+      unmark(priority);
+   }
+   else if (bucket.head >= MIN_COMPACT && bucket.head * 2 >= bucket.items.size())
+   {
+      size_t numLive = bucket.items.size() - bucket.head;
+      for (size_t i = 0; i < numLive; i++)
+         bucket.items[i] = std::move(bucket.items[bucket.head + i]);
+      bucket.items.resize(numLive);
+      bucket.head = 0;
+   }
+}
+
+/************************************************
+ * BUCKET QUEUE :: MARK and UNMARK
+ * Keep the bitmap and its summary in step
+ ***********************************************/
+template <class T, size_t NumPriorities>
+void bucket_queue <T, NumPriorities> :: mark(size_t priority)
+{
+   bitmap[priority / 64] |= uint64_t(1) << (priority % 64);
+   summary |= uint64_t(1) << (priority / 64);
+}
+
+template <class T, size_t NumPriorities>
+void bucket_queue <T, NumPriorities> :: unmark(size_t priority)
+{
+   bitmap[priority / 64] &= ~(uint64_t(1) << (priority % 64));
+   if (!bitmap[priority / 64])
+      summary &= ~(uint64_t(1) << (priority / 64));
+}
+
+/************************************************
+ * BUCKET QUEUE :: CHECK PRIORITY
+ ***********************************************/
+template <class T, size_t NumPriorities>
+typename bucket_queue <T, NumPriorities> :: Bucket &
+bucket_queue <T, NumPriorities> :: checkPriority(size_t priority)
+{
+   if (priority >= NumPriorities)
+      throw std::out_of_range("std:out_of_range");
+   return buckets[priority];
+}
+
+};
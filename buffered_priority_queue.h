@@ -0,0 +1,293 @@
+/***********************************************************************
+ * Header:
+ *    BUFFERED PRIORITY QUEUE
+ * Summary:
+ *    A priority_queue shared by many threads in which every thread
+ *    appends its pushes to a small unsorted buffer of its own. The
+ *    buffers go into the shared heap in bulk, when one fills up or
+ *    when a pop needs them.
+ *
+ *    This will contain the class definition of:
+ *        buffered_priority_queue : A push-friendly, exactly ordered queue
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <atomic>       // for std::atomic
+#include <mutex>        // for std::mutex
+#include <functional>   // for std::less
+#include <iterator>     // for std::make_move_iterator
+#include "priority_queue.h"
+#include "thread_slots.h"
+#include "vector.h"
+
+class TestBufferedPQueue;    // forward declaration for unit test class
+
+namespace custom
+{
+
+/*************************************************
+ * BUFFERED PRIORITY QUEUE
+ * A push only takes the pushing thread's own buffer
+ * lock, which nobody else wants unless a pop is under
+ * way, and costs an append. A full buffer is merged
+ * into the heap under the heap lock. Before every pop
+ * all the buffers are merged, so a pop sees every push
+ * that has returned and the order is exact. A merge
+ * heapifies once when the batch is big next to the
+ * heap and sifts each element up otherwise. Threads
+ * past MAX_BUFFERS push straight into the heap. A
+ * thread that exits merges its buffer and frees it for
+ * the next thread.
+ *************************************************/
+template<class T, class Compare = std::less<T>, size_t Arity = 2>
+class buffered_priority_queue
+{
+   friend class ::TestBufferedPQueue; // give the unit test class access to the privates
+
+public:
+
+   //
+   // construct
+   //
+
+   explicit buffered_priority_queue(size_t bufferCapacity = 64, const Compare & compare = Compare()) :
+      bufferCapacity(bufferCapacity ? bufferCapacity : 1), buffers(new Buffer[MAX_BUFFERS]),
+      slots(this, &release), numClaimed(0), heap(compare), numHeap(0) {}
+   buffered_priority_queue(const buffered_priority_queue & rhs) = delete;
+   buffered_priority_queue & operator = (const buffered_priority_queue & rhs) = delete;
+  ~buffered_priority_queue() { slots.close(); delete [] buffers; }
+
+   //
+   // Insert
+   //
+   void push(const T & t);
+   void push(T && t);
+
+   //
+   // Remove
+   //
+   bool try_pop(T & t);    // false when the queue was empty
+   void flush();           // merge every buffer into the heap now
+
+   //
+   // Status. Only a snapshot while other threads are working
+   //
+   size_t size()  const;
+   bool   empty() const { return size() == 0; }
+   size_t buffer_capacity() const { return bufferCapacity; }
+
+private:
+   enum { MAX_BUFFERS = 128 };     // threads past this push straight into the heap
+
+   // one thread's pushes, on its own cache line
+   struct alignas(64) Buffer
+   {
+      Buffer() : claimed(false), numItems(0) {}
+      std::atomic<bool>   claimed;
+      std::mutex          lock;
+      custom::vector<T>   items;
+      std::atomic<size_t> numItems;   // read without the lock by flush
+   };
+
+   template <class U>
+   void    pushBuffered(U && t);
+   Buffer * buffer();                  // this thread's buffer, or nullptr if none are left
+   static void release(void * queue, void * buffer);   // the thread that owned buffer has exited
+   void    drain(Buffer & b);          // move b into the batch; hold both locks
+   void    mergeBatch();               // move the batch into the heap; hold heapLock
+   void    flushAll();                 // hold heapLock
+
+   size_t                                    bufferCapacity;
+   Buffer *                                  buffers;
+   thread_slots                              slots;        // which buffer each thread claimed
+   std::atomic<size_t>                       numClaimed;   // buffers past this were never used
+   std::mutex                                heapLock;     // always taken before a buffer lock
+   custom::priority_queue<T, Compare, Arity> heap;
+   custom::vector<T>                         batch;        // reused from one merge to the next
+   std::atomic<size_t>                       numHeap;
+};
+
+/************************************************
+ * BUFFERED PRIORITY QUEUE :: PUSH
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+void buffered_priority_queue <T, Compare, Arity> :: push(const T & t)
+{
+   pushBuffered(t);
+}
+
+template <class T, class Compare, size_t Arity>
+void buffered_priority_queue <T, Compare, Arity> :: push(T && t)
+{
+   pushBuffered(std::move(t));
+}
+
+/************************************************
+ * BUFFERED PRIORITY QUEUE :: PUSH BUFFERED
+ * Append under our own lock. When that fills the
+ * buffer, let go and come back in lock order, heap
+ * first, to merge it: the elements stay visible in
+ * the buffer the whole time.
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+template <class U>
+void buffered_priority_queue <T, Compare, Arity> :: pushBuffered(U && t)
+{
+   Buffer * b = buffer();
+   if (!b)
+   {
+      std::lock_guard<std::mutex> guard(heapLock);
+      heap.push(std::forward<U>(t));
+      numHeap.store(heap.size());
+      return;
+   }
+
+   {
+      std::lock_guard<std::mutex> guard(b->lock);
+      b->items.push_back(std::forward<U>(t));
+      b->numItems.store(b->items.size());
+      if (b->items.size() < bufferCapacity)
+         return;
+   }
+
+   std::lock_guard<std::mutex> guardHeap(heapLock);
+   std::lock_guard<std::mutex> guard(b->lock);
+   drain(*b);   // a pop may have beaten us to it
+   mergeBatch();
+}
+
+/************************************************
+ * BUFFERED PRIORITY QUEUE :: TRY POP
+ * Merge every buffer, then take the top
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+bool buffered_priority_queue <T, Compare, Arity> :: try_pop(T & t)
+{
+   std::lock_guard<std::mutex> guard(heapLock);
+   flushAll();
+   if (heap.empty())
+      return false;
+
+   t = std::move(const_cast<T &>(heap.top()));
+   heap.pop();
+   numHeap.store(heap.size());
+   return true;
+}
+
+/************************************************
+ * BUFFERED PRIORITY QUEUE :: FLUSH
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+void buffered_priority_queue <T, Compare, Arity> :: flush()
+{
+   std::lock_guard<std::mutex> guard(heapLock);
+   flushAll();
+}
+
+template <class T, class Compare, size_t Arity>
+void buffered_priority_queue <T, Compare, Arity> :: flushAll()
+{
+   size_t num = numClaimed.load();
+   for (size_t i = 0; i < num; i++)
+      if (buffers[i].numItems.load() > 0)
+      {
+         std::lock_guard<std::mutex> guard(buffers[i].lock);
+         drain(buffers[i]);
+      }
+   mergeBatch();
+}
+
+/************************************************
+ * BUFFERED PRIORITY QUEUE :: SIZE
+ * No shared counter for the buffers: pushes would
+ * all fight over its cache line
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+size_t buffered_priority_queue <T, Compare, Arity> :: size() const
+{
+   size_t num = numHeap.load();
+   size_t numUsed = numClaimed.load();
+   for (size_t i = 0; i < numUsed; i++)
+      num += buffers[i].numItems.load();
+   return num;
+}
+
+/************************************************
+ * BUFFERED PRIORITY QUEUE :: DRAIN
+ * The buffer keeps its storage for the next pushes
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+void buffered_priority_queue <T, Compare, Arity> :: drain(Buffer & b)
+{
+   for (size_t i = 0; i < b.items.size(); i++)
+      batch.push_back(std::move(b.items[i]));
+   b.items.resize(0);
+   b.numItems.store(0);
+}
+
+/************************************************
+ * BUFFERED PRIORITY QUEUE :: MERGE BATCH
+ * The heap decides between sifting the batch up and
+ * rebuilding, by how big the batch is next to it
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+void buffered_priority_queue <T, Compare, Arity> :: mergeBatch()
+{
+   if (!batch.empty())
+   {
+      T * begin = &batch[0];
+      heap.append_and_heapify(std::make_move_iterator(begin), std::make_move_iterator(begin + batch.size()));
+   }
+   batch.resize(0);
+   numHeap.store(heap.size());
+}
+
+/************************************************
+ * BUFFERED PRIORITY QUEUE :: BUFFER
+ * Each thread remembers which buffer it claimed in
+ * each queue it has used
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+typename buffered_priority_queue <T, Compare, Arity> :: Buffer *
+buffered_priority_queue <T, Compare, Arity> :: buffer()
+{
+   if (void * b = slots.find())
+      return static_cast<Buffer *>(b);
+
+   for (size_t i = 0; i < MAX_BUFFERS; i++)
+   {
+      bool expected = false;
+      if (!buffers[i].claimed.load() && buffers[i].claimed.compare_exchange_strong(expected, true))
+      {
+         slots.remember(buffers + i);
+         size_t num = numClaimed.load();
+         while (num < i + 1 && !numClaimed.compare_exchange_weak(num, i + 1))
+            ;
+         return buffers + i;
+      }
+   }
+   return nullptr;
+}
+
+/************************************************
+ * BUFFERED PRIORITY QUEUE :: RELEASE
+ * Merge what the exited thread left, then free the
+ * buffer. numClaimed stays: it only bounds the scan.
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+void buffered_priority_queue <T, Compare, Arity> :: release(void * queue, void * buffer)
+{
+   buffered_priority_queue & pq = *static_cast<buffered_priority_queue *>(queue);
+   Buffer & b = *static_cast<Buffer *>(buffer);
+   {
+      std::lock_guard<std::mutex> guardHeap(pq.heapLock);
+      std::lock_guard<std::mutex> guard(b.lock);
+      pq.drain(b);
+      pq.mergeBatch();
+   }
+   b.claimed.store(false);
+}
+
+};
@@ -0,0 +1,290 @@
+/***********************************************************************
+ * Header:
+ *    CALENDAR QUEUE
+ * Summary:
+ *    Brown's calendar queue for discrete-event simulation: O(1)
+ *    average push and pop when timestamps are spread evenly
+ *
+ *    This will contain the class definition of:
+ *        calendar_queue         : A priority queue of timed events
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <cmath>        // for std::floor
+#include <algorithm>    // for std::nth_element, std::sort
+#include <stdexcept>    // for std::out_of_range
+#include "vector.h"
+
+class TestCalendarQueue;    // forward declaration for unit test class
+
+namespace custom
+{
+
+/*************************************************
+ * CALENDAR TIMESTAMP
+ * By default an event is its own timestamp
+ *************************************************/
+template <class T>
+struct calendar_timestamp
+{
+   double operator()(const T & t) const { return static_cast<double>(t); }
+};
+
+/*************************************************
+ * CALENDAR QUEUE
+ * The buckets are the days of a year, each width long.
+ * An event goes in the bucket of its day modulo the
+ * number of days, sorted so the earliest is at the back.
+ * Popping walks forward from the current day and takes
+ * the back of the first bucket whose earliest event falls
+ * on this day; after a whole empty year it searches
+ * directly. The number of days doubles or halves as the
+ * queue grows or shrinks, and the day width is re-estimated
+ * from the spacing of the earliest events. The earliest
+ * timestamp comes out first; ties come out in push order.
+ *************************************************/
+template<class T, class Timestamp = calendar_timestamp<T>>
+class calendar_queue : private Timestamp
+{
+   friend class ::TestCalendarQueue; // give the unit test class access to the privates
+
+public:
+
+   //
+   // construct
+   //
+
+   calendar_queue(const Timestamp & timestamp = Timestamp()) : Timestamp(timestamp),
+      buckets(MIN_BUCKETS), width(1.0), dayCurrent(0), numElements(0) {}
+
+   //
+   // Access
+   //
+   const T & top() const;              // the earliest event
+
+   //
+   // Insert
+   //
+   void push(const T & t);
+   void push(T && t);
+
+   //
+   // Remove
+   //
+   void pop();
+
+   //
+   // Status
+   //
+   size_t size()  const { return numElements;      }
+   bool   empty() const { return numElements == 0; }
+
+private:
+   enum { MIN_BUCKETS = 4,            // never fewer days than this
+          NUM_SAMPLES = 25 };         // events used to estimate the day width
+
+   double timeOf(const T & t) const   { return static_cast<const Timestamp &>(*this)(t); }
+   long long day(double time) const   { return (long long)std::floor(time / width); }
+   size_t indexOf(long long day) const { return size_t(day) & (buckets.size() - 1); }
+
+   void   insert(T && t);             // put an event in its bucket, in order
+   size_t findEarliest() const;       // the bucket holding the earliest event
+   void   resize(size_t numBuckets);  // change the number of days and re-estimate the width
+   double estimateWidth() const;
+
+   custom::vector<custom::vector<T>> buckets;   // a power of two of them
+   double width;                                // the length of one day
+
+   // the current day, counted in days so that walking the calendar does not
+   // accumulate rounding. top() may move it, so it changes underneath a const top()
+   mutable long long dayCurrent;
+
+   size_t numElements;
+};
+
+/************************************************
+ * CALENDAR QUEUE :: TOP
+ ***********************************************/
+template <class T, class Timestamp>
+const T & calendar_queue <T, Timestamp> :: top() const
+{
+   if (empty())
+      throw std::out_of_range("std:out_of_range");
+   return buckets[findEarliest()].back();
+}
+
+/************************************************
+ * CALENDAR QUEUE :: PUSH
+ * Insert, then grow the calendar if the buckets are
+ * getting crowded
+ ***********************************************/
+template <class T, class Timestamp>
+void calendar_queue <T, Timestamp> :: push(const T & t)
+{
+   T copy(t);
+   push(std::move(copy));
+}
+
+template <class T, class Timestamp>
+void calendar_queue <T, Timestamp> :: push(T && t)
+{
+   insert(std::move(t));
+   numElements++;
+   if (numElements > 2 * buckets.size())
+      resize(buckets.size() * 2);
+}
+
+/************************************************
+ * CALENDAR QUEUE :: POP
+ * Remove, then shrink the calendar if most days are empty
+ ***********************************************/
+template <class T, class Timestamp>
+void calendar_queue <T, Timestamp> :: pop()
+{
+   if (empty())
+      return;
+
+   buckets[findEarliest()].pop_back();
+   numElements--;
+   if (buckets.size() > MIN_BUCKETS && numElements < buckets.size() / 2)
+      resize(buckets.size() / 2);
+}
+
+/************************************************
+ * CALENDAR QUEUE :: INSERT
+ * Keep each bucket sorted latest-first by moving a hole
+ * toward the front. An event earlier than the current
+ * day moves the current day back to it.
+ ***********************************************/
+template <class T, class Timestamp>
+void calendar_queue <T, Timestamp> :: insert(T && t)
+{
+   double time = timeOf(t);
+   long long dayEvent = day(time);
+   if (numElements == 0 || dayEvent < dayCurrent)
+      dayCurrent = dayEvent;
+
+   custom::vector<T> & bucket = buckets[indexOf(dayEvent)];
+   bucket.push_back(std::move(t));
+
+   // ties go in front of the equal events so the older ones come out first
+   size_t indexHole = bucket.size() - 1;
+   if (indexHole && timeOf(bucket[indexHole - 1]) <= time)
+   {
+      T value(std::move(bucket[indexHole]));
+      do
+      {
+         bucket[indexHole] = std::move(bucket[indexHole - 1]);
+         indexHole--;
+      }
+      while (indexHole && timeOf(bucket[indexHole - 1]) <= time);
+      bucket[indexHole] = std::move(value);
+   }
+}
+
+/************************************************
+ * CALENDAR QUEUE :: FIND EARLIEST
+ * Walk the days of one year from the current day. If no
+ * event falls in that year, search every bucket directly
+ * and jump to the day of the earliest event.
+ ***********************************************/
+template <class T, class Timestamp>
+size_t calendar_queue <T, Timestamp> :: findEarliest() const
+{
+   assert(numElements > 0);
+
+   for (long long dayNext = dayCurrent; dayNext < dayCurrent + (long long)buckets.size(); dayNext++)
+   {
+      const custom::vector<T> & bucket = buckets[indexOf(dayNext)];
+      if (!bucket.empty() && day(timeOf(bucket.back())) <= dayNext)
+      {
+         dayCurrent = dayNext;
+         return indexOf(dayNext);
+      }
+   }
+
+   // direct search
+   size_t indexEarliest = buckets.size();
+   double earliest = 0.0;
+   for (size_t i = 0; i < buckets.size(); i++)
+      if (!buckets[i].empty() &&
+          (indexEarliest == buckets.size() || timeOf(buckets[i].back()) < earliest))
+      {
+         indexEarliest = i;
+         earliest = timeOf(buckets[i].back());
+      }
+   assert(indexEarliest < buckets.size());
+
+   dayCurrent = day(earliest);
+   return indexEarliest;
+}
+
+/************************************************
+ * CALENDAR QUEUE :: RESIZE
+ * Take every event out, pick a new day width, and put
+ * them back into numBuckets days
+ ***********************************************/
+template <class T, class Timestamp>
+void calendar_queue <T, Timestamp> :: resize(size_t numBuckets)
+{
+   double newWidth = estimateWidth();
+
+   custom::vector<custom::vector<T>> old(numBuckets);
+   old.swap(buckets);
+   width = newWidth;
+
+   size_t num = numElements;
+   numElements = 0;
+   for (size_t i = 0; i < old.size(); i++)
+      for (size_t j = old[i].size(); j > 0; j--)
+      {
+         insert(std::move(old[i][j - 1]));
+         numElements++;
+      }
+   assert(numElements == num);
+}
+
+/************************************************
+ * CALENDAR QUEUE :: ESTIMATE WIDTH
+ * Three times the average gap between the earliest
+ * events, ignoring gaps more than twice the average
+ ***********************************************/
+template <class T, class Timestamp>
+double calendar_queue <T, Timestamp> :: estimateWidth() const
+{
+   if (numElements < 2)
+      return width;
+
+   // the earliest event of each bucket is at its back, but the earliest
+   // events overall may share a bucket, so consider every event
+   custom::vector<double> times;
+   times.reserve(numElements);
+   for (size_t i = 0; i < buckets.size(); i++)
+      for (size_t j = 0; j < buckets[i].size(); j++)
+         times.push_back(timeOf(buckets[i][j]));
+
+   size_t numSamples = numElements < (size_t)NUM_SAMPLES ? numElements : (size_t)NUM_SAMPLES;
+   double * begin = &times[0];
+   std::nth_element(begin, begin + numSamples - 1, begin + numElements);
+   std::sort(begin, begin + numSamples);
+
+   double average = (times[numSamples - 1] - times[0]) / (numSamples - 1);
+   double total = 0.0;
+   size_t count = 0;
+   for (size_t i = 1; i < numSamples; i++)
+   {
+      double gap = times[i] - times[i - 1];
+      if (gap <= 2.0 * average)
+      {
+         total += gap;
+         count++;
+      }
+   }
+
+   double newWidth = count ? 3.0 * total / count : 0.0;
+   return newWidth > 0.0 ? newWidth : width;
+}
+
+};
@@ -0,0 +1,237 @@
+/***********************************************************************
+ * Header:
+ *    COMBINING PRIORITY QUEUE
+ * Summary:
+ *    A flat-combining wrapper around priority_queue: whichever thread
+ *    gets the lock applies every thread's pending push and pop in one
+ *    batch while the heap is hot in its cache
+ *
+ *    This will contain the class definition of:
+ *        combining_priority_queue : A priority_queue shared by many threads
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <atomic>       // for std::atomic
+#include <mutex>        // for std::mutex
+#include <thread>       // for std::this_thread
+#include <algorithm>    // for std::sort
+#include <functional>   // for std::less, std::hash
+#include <iterator>     // for std::make_move_iterator, std::reverse_iterator
+#include "compare_holder.h"
+#include "priority_queue.h"
+#include "vector.h"
+
+class TestCombiningPQueue;    // forward declaration for unit test class
+
+namespace custom
+{
+
+/*************************************************
+ * COMBINING PRIORITY QUEUE
+ * A thread writes its request into a free slot and
+ * waits. If the lock is free it becomes the combiner:
+ * it collects every published request, sorts the
+ * pushes, hands the best of them straight to pops that
+ * beat the heap top, and puts the rest in the heap one
+ * at a time or, for a big batch, all at once with a
+ * single heapify. The order is exact: every pop gets
+ * the largest element present when its batch ran.
+ *************************************************/
+template<class T, class Compare = std::less<T>, size_t Arity = 2>
+class combining_priority_queue : private compare_holder<Compare>
+{
+   friend class ::TestCombiningPQueue; // give the unit test class access to the privates
+
+public:
+
+   //
+   // construct
+   //
+
+   explicit combining_priority_queue(const Compare & compare = Compare()) :
+      compare_holder<Compare>(compare), heap(compare), numElements(0) {}
+   combining_priority_queue(const combining_priority_queue & rhs) = delete;
+   combining_priority_queue & operator = (const combining_priority_queue & rhs) = delete;
+
+   //
+   // Insert
+   //
+   void push(const T & t);
+
+   //
+   // Remove
+   //
+   bool try_pop(T & t);    // false when the queue was empty
+
+   //
+   // Status. Only a snapshot while other threads are working
+   //
+   size_t size()  const { return numElements.load(); }
+   bool   empty() const { return size() == 0;         }
+
+private:
+   enum { NUM_SLOTS = 64 };        // more threads than this share slots by probing
+
+   enum State { FREE, CLAIMED, PUSH, POP, DONE };
+
+   // one request, on its own cache line
+   struct alignas(64) Slot
+   {
+      Slot() : state(FREE), success(false) {}
+      std::atomic<int> state;
+      T                value;       // the element to push, or the element popped
+      bool             success;     // did the pop find anything
+   };
+
+   Slot & claim();                  // a free slot, preferring this thread's own
+   void   wait(Slot & slot);        // until a combiner has served the slot
+   void   combine();                // serve every published slot; hold the lock
+
+   // does lhs belong below rhs in the heap?
+   bool compare(const T & lhs, const T & rhs) const
+   {
+      return this->comparator()(lhs, rhs);
+   }
+
+   Slot                                      slots[NUM_SLOTS];
+   std::mutex                                lock;
+   custom::priority_queue<T, Compare, Arity> heap;         // only touched by the combiner
+   custom::vector<T>                         pushes;       // the batch, reused from one to the next
+   custom::vector<Slot *>                    pops;
+   std::atomic<size_t>                       numElements;
+};
+
+/************************************************
+ * COMBINING PRIORITY QUEUE :: PUSH
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+void combining_priority_queue <T, Compare, Arity> :: push(const T & t)
+{
+   Slot & slot = claim();
+   slot.value = t;
+   slot.state.store(PUSH);
+   wait(slot);
+   slot.state.store(FREE);
+}
+
+/************************************************
+ * COMBINING PRIORITY QUEUE :: TRY POP
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+bool combining_priority_queue <T, Compare, Arity> :: try_pop(T & t)
+{
+   Slot & slot = claim();
+   slot.state.store(POP);
+   wait(slot);
+   bool success = slot.success;
+   if (success)
+      t = std::move(slot.value);
+   slot.state.store(FREE);
+   return success;
+}
+
+/************************************************
+ * COMBINING PRIORITY QUEUE :: CLAIM
+ * Start at the slot this thread hashes to; with fewer
+ * threads than slots it is nearly always free
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+typename combining_priority_queue <T, Compare, Arity> :: Slot &
+combining_priority_queue <T, Compare, Arity> :: claim()
+{
+   size_t index = std::hash<std::thread::id>()(std::this_thread::get_id()) % NUM_SLOTS;
+   for (;;)
+   {
+      int expected = FREE;
+      if (slots[index].state.load() == FREE &&
+          slots[index].state.compare_exchange_strong(expected, CLAIMED))
+         return slots[index];
+      index = (index + 1) % NUM_SLOTS;
+   }
+}
+
+/************************************************
+ * COMBINING PRIORITY QUEUE :: WAIT
+ * Spin on our own slot. Whenever the lock is free,
+ * take it and combine for everyone, ourselves included.
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+void combining_priority_queue <T, Compare, Arity> :: wait(Slot & slot)
+{
+   while (slot.state.load() != DONE)
+   {
+      if (lock.try_lock())
+      {
+         combine();
+         lock.unlock();
+      }
+      else
+         std::this_thread::yield();
+   }
+}
+
+/************************************************
+ * COMBINING PRIORITY QUEUE :: COMBINE
+ * Pushes and pops in one batch. Sorted, the best push
+ * is at the back of the batch; a pop takes it if it
+ * beats the heap top, which saves a push and a pop on
+ * the heap. What is left of the batch goes into the
+ * heap with one heapify if it is big enough.
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+void combining_priority_queue <T, Compare, Arity> :: combine()
+{
+   pushes.resize(0);
+   pops.resize(0);
+   for (size_t i = 0; i < NUM_SLOTS; i++)
+   {
+      int state = slots[i].state.load();
+      if (state == PUSH)
+      {
+         pushes.push_back(std::move(slots[i].value));
+         slots[i].state.store(DONE);
+      }
+      else if (state == POP)
+         pops.push_back(slots + i);
+   }
+
+   if (pushes.size() > 1)
+   {
+      T * begin = &pushes[0];
+      std::sort(begin, begin + pushes.size(),
+                [this](const T & lhs, const T & rhs) { return compare(lhs, rhs); });
+   }
+
+   for (size_t i = 0; i < pops.size(); i++)
+   {
+      Slot & slot = *pops[i];
+      bool fromBatch = !pushes.empty() &&
+                       (heap.empty() || !compare(pushes.back(), heap.top()));
+      slot.success = fromBatch || !heap.empty();
+      if (fromBatch)
+      {
+         slot.value = std::move(pushes.back());
+         pushes.pop_back();
+      }
+      else if (!heap.empty())
+      {
+         slot.value = std::move(const_cast<T &>(heap.top()));
+         heap.pop();
+      }
+      slot.state.store(DONE);
+   }
+
+   // best first, so if they are sifted up the later, smaller pushes stop near the bottom
+   if (!pushes.empty())
+   {
+      std::reverse_iterator<T *> best(&pushes[0] + pushes.size());
+      std::reverse_iterator<T *> end(&pushes[0]);
+      heap.append_and_heapify(std::make_move_iterator(best), std::make_move_iterator(end));
+   }
+
+   numElements.store(heap.size());
+}
+
+};
@@ -0,0 +1,52 @@
+/***********************************************************************
+ * Header:
+ *    COMPARE HOLDER
+ * Summary:
+ *    Keeps the comparator of a heap. A stateless comparator is held
+ *    as a base class so it takes no space; anything else, such as a
+ *    function pointer or a final class, is held as a member.
+ *
+ *    This will contain the class definition of:
+ *        compare_holder         : The comparator of a heap
+ ************************************************************************/
+
+#pragma once
+
+#include <type_traits>  // for std::is_empty, std::is_final
+
+namespace custom
+{
+
+/*************************************************
+ * COMPARE HOLDER
+ * A heap inherits privately from this and calls
+ * comparator(). Only a class can be a base and only a
+ * class that is not final can be derived from, so the
+ * empty base optimization is kept for the comparators
+ * that allow it.
+ *************************************************/
+template <class Compare,
+          bool Empty = std::is_empty<Compare>::value && !std::is_final<Compare>::value>
+class compare_holder : private Compare
+{
+public:
+   compare_holder() : Compare() {}
+   explicit compare_holder(const Compare & compare) : Compare(compare) {}
+
+   const Compare & comparator() const { return *this; }
+};
+
+template <class Compare>
+class compare_holder <Compare, false>
+{
+public:
+   compare_holder() : compare() {}
+   explicit compare_holder(const Compare & compare) : compare(compare) {}
+
+   const Compare & comparator() const { return compare; }
+
+private:
+   Compare compare;
+};
+
+};
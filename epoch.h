@@ -0,0 +1,234 @@
+/***********************************************************************
+ * Header:
+ *    EPOCH
+ * Summary:
+ *    Epoch-based memory reclamation for the lock-free containers: a
+ *    node unlinked by one thread is not deleted until no other thread
+ *    can still be reading it
+ *
+ *    This will contain the class definition of:
+ *        epoch_domain           : The global epoch and every thread's pin
+ *        epoch_domain::guard    : Pins the calling thread while in scope
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <atomic>       // for std::atomic
+#include <cstdint>      // for uint64_t
+#include "vector.h"
+
+class TestSkiplistPQueue;    // forward declaration for unit test class
+
+namespace custom
+{
+
+/*************************************************
+ * EPOCH DOMAIN
+ * Every thread that touches a lock-free container
+ * pins the global epoch for the length of the
+ * operation. A retired node is tagged with the global
+ * epoch after it was unlinked. The global epoch only
+ * advances once every pinned thread has seen the
+ * current one, so by the time it is two past a node's
+ * tag, every thread that could have found the node
+ * has finished. There is one domain for the program
+ * so a thread needs only one record.
+ *************************************************/
+class epoch_domain
+{
+   friend class ::TestSkiplistPQueue; // give the unit test class access to the privates
+
+public:
+   static epoch_domain & instance()
+   {
+      static epoch_domain domain;
+      return domain;
+   }
+
+   /*************************************************
+    * GUARD
+    * Pin the calling thread while in scope. Guards nest.
+    *************************************************/
+   class guard
+   {
+   public:
+      guard()  { epoch_domain::instance().enter(); }
+     ~guard()  { epoch_domain::instance().exit();  }
+      guard(const guard &) = delete;
+      guard & operator = (const guard &) = delete;
+   };
+
+   // hand over an unlinked object; deleter(p) runs once it is safe
+   void retire(void * p, void (*deleter)(void *));
+
+   // free everything retired by this thread that is old enough
+   void collect();
+
+   ~epoch_domain();
+
+private:
+   enum { COLLECT_EVERY = 64 };     // retires between attempts to advance and collect
+
+   struct Retired
+   {
+      void *   p;
+      void  (* deleter)(void *);
+      uint64_t epoch;
+   };
+
+   // one per thread, recycled when the thread exits
+   struct alignas(64) Record
+   {
+      Record() : pinned(0), inUse(true), next(nullptr), nesting(0) {}
+      std::atomic<uint64_t>    pinned;    // (epoch << 1) | 1 while pinned, 0 otherwise
+      std::atomic<bool>        inUse;
+      Record *                 next;      // never changes once the record is listed
+      size_t                   nesting;   // touched only by the owner
+      custom::vector<Retired>  retired;   // touched only by the owner, oldest first
+   };
+
+   // releases the record of a thread when it exits
+   struct Owner
+   {
+      Record * record;
+      Owner() : record(nullptr) {}
+     ~Owner() { if (record) record->inUse.store(false); }
+   };
+
+   epoch_domain() : epoch(1), records(nullptr) {}
+   epoch_domain(const epoch_domain &) = delete;
+
+   void     enter();
+   void     exit();
+   Record & local();
+   bool     tryAdvance();
+
+   std::atomic<uint64_t>  epoch;
+   std::atomic<Record *>  records;
+};
+
+/************************************************
+ * EPOCH DOMAIN :: LOCAL
+ * The record of the calling thread. Take over one an
+ * exited thread left behind, with any garbage still in
+ * it, or list a new one.
+ ***********************************************/
+inline epoch_domain::Record & epoch_domain::local()
+{
+   thread_local Owner owner;
+   if (owner.record)
+      return *owner.record;
+
+   for (Record * r = records.load(); r; r = r->next)
+   {
+      bool expected = false;
+      if (!r->inUse.load() && r->inUse.compare_exchange_strong(expected, true))
+         return *(owner.record = r);
+   }
+
+   Record * r = new Record;
+   Record * head = records.load();
+   do
+      r->next = head;
+   while (!records.compare_exchange_weak(head, r));
+   return *(owner.record = r);
+}
+
+/************************************************
+ * EPOCH DOMAIN :: ENTER and EXIT
+ * Publishing the pin is sequentially consistent so
+ * that an advancing thread either sees it or the
+ * pinned thread sees every node unlinked before then.
+ ***********************************************/
+inline void epoch_domain::enter()
+{
+   Record & record = local();
+   if (record.nesting++ == 0)
+      record.pinned.store((epoch.load() << 1) | 1);
+}
+
+inline void epoch_domain::exit()
+{
+   Record & record = local();
+   assert(record.nesting > 0);
+   if (--record.nesting == 0)
+      record.pinned.store(0);
+}
+
+/************************************************
+ * EPOCH DOMAIN :: RETIRE
+ ***********************************************/
+inline void epoch_domain::retire(void * p, void (*deleter)(void *))
+{
+   Record & record = local();
+   Retired retired = { p, deleter, epoch.load() };
+   record.retired.push_back(retired);
+   if (record.retired.size() % COLLECT_EVERY == 0)
+   {
+      tryAdvance();
+      collect();
+   }
+}
+
+/************************************************
+ * EPOCH DOMAIN :: TRY ADVANCE
+ * Move the global epoch on if every pinned thread
+ * has seen it
+ ***********************************************/
+inline bool epoch_domain::tryAdvance()
+{
+   uint64_t current = epoch.load();
+   for (Record * r = records.load(); r; r = r->next)
+   {
+      uint64_t pinned = r->pinned.load();
+      if ((pinned & 1) && (pinned >> 1) != current)
+         return false;
+   }
+   return epoch.compare_exchange_strong(current, current + 1);
+}
+
+/************************************************
+ * EPOCH DOMAIN :: COLLECT
+ * The retired list is in epoch order, so delete the
+ * old enough prefix and slide the rest down
+ ***********************************************/
+inline void epoch_domain::collect()
+{
+   Record & record = local();
+   uint64_t current = epoch.load();
+
+   size_t numFreed = 0;
+   while (numFreed < record.retired.size() && record.retired[numFreed].epoch + 2 <= current)
+   {
+      record.retired[numFreed].deleter(record.retired[numFreed].p);
+      numFreed++;
+   }
+   if (numFreed == 0)
+      return;
+
+   size_t numLeft = record.retired.size() - numFreed;
+   for (size_t i = 0; i < numLeft; i++)
+      record.retired[i] = record.retired[numFreed + i];
+   record.retired.resize(numLeft);
+}
+
+/************************************************
+ * EPOCH DOMAIN :: DESTRUCTOR
+ * Runs at program exit when no thread is pinned, so
+ * whatever is still retired can go
+ ***********************************************/
+inline epoch_domain::~epoch_domain()
+{
+   Record * r = records.load();
+   while (r)
+   {
+      for (size_t i = 0; i < r->retired.size(); i++)
+         r->retired[i].deleter(r->retired[i].p);
+      Record * next = r->next;
+      delete r;
+      r = next;
+   }
+}
+
+};
@@ -0,0 +1,120 @@
+/***********************************************************************
+ * Header:
+ *    HEAP HOLE
+ * Summary:
+ *    The index arithmetic and hole percolation of an Arity-ary heap
+ *    stored in a vector, shared by the heaps that keep one
+ *
+ *    This will contain the class definition of:
+ *        heap_hole              : Percolate a hole through a heap
+ ************************************************************************/
+
+#pragma once
+
+#include <cstddef>      // for size_t
+#include "vector.h"
+
+namespace custom
+{
+
+/*************************************************
+ * HEAP HOLE
+ * Heap indices start at 1, so heap index i is slot
+ * i - 1 of the container. compare(a, b) is TRUE when a
+ * belongs below b. Percolating a hole moves each
+ * element that is in the way once, by calling
+ * move(indexTo, indexFrom), and returns where the hole
+ * stopped; the caller puts the value there. A heap
+ * that keeps side tables of where its elements are
+ * updates them in move.
+ *************************************************/
+template <size_t Arity>
+struct heap_hole
+{
+   static_assert(Arity >= 2, "a heap needs at least two children per node");
+
+   // heap index of the first child and the parent of a heap index
+   static size_t indexChild(size_t indexHeap)  { return Arity * (indexHeap - 1) + 2; }
+   static size_t indexParent(size_t indexHeap) { return indexHeap > 1 ? (indexHeap - 2) / Arity + 1 : 0; }
+
+   // the child that belongs highest, or 0 if indexHeap is a leaf
+   template <class T, class Compare>
+   static size_t indexBiggerChild(const custom::vector<T> & container, size_t indexHeap,
+                                  const Compare & compare);
+
+   // move the hole down until value belongs above the children
+   template <class T, class Compare, class Move>
+   static size_t percolateDown(const custom::vector<T> & container, size_t indexHole,
+                               const T & value, const Compare & compare, Move move);
+
+   // move the hole up until value belongs below the parent
+   template <class T, class Compare, class Move>
+   static size_t percolateUp(const custom::vector<T> & container, size_t indexHole,
+                             const T & value, const Compare & compare, Move move);
+};
+
+/************************************************
+ * HEAP HOLE :: INDEX BIGGER CHILD
+ ***********************************************/
+template <size_t Arity>
+template <class T, class Compare>
+size_t heap_hole <Arity> :: indexBiggerChild(const custom::vector<T> & container, size_t indexHeap,
+                                            const Compare & compare)
+{
+   size_t num = container.size();
+   size_t indexFirst = indexChild(indexHeap);
+   if (indexFirst > num)
+      return 0;
+
+   // With a fixed Arity the compiler unrolls this loop
+   size_t indexBigger = indexFirst;
+   size_t indexLast = indexFirst + Arity - 1 < num ? indexFirst + Arity - 1 : num;
+   for (size_t index = indexFirst + 1; index <= indexLast; index++)
+      if (compare(container[indexBigger - 1], container[index - 1]))
+         indexBigger = index;
+   return indexBigger;
+}
+
+/************************************************
+ * HEAP HOLE :: PERCOLATE DOWN
+ * indexHole holds nothing of value. Move the larger
+ * child up into it until value is at least as big
+ * as the children. One move per level.
+ ***********************************************/
+template <size_t Arity>
+template <class T, class Compare, class Move>
+size_t heap_hole <Arity> :: percolateDown(const custom::vector<T> & container, size_t indexHole,
+                                         const T & value, const Compare & compare, Move move)
+{
+   size_t indexBigger;
+   while ((indexBigger = indexBiggerChild(container, indexHole, compare)) &&
+          compare(value, container[indexBigger - 1]))
+   {
+      move(indexHole, indexBigger);
+      indexHole = indexBigger;
+   }
+   return indexHole;
+}
+
+/************************************************
+ * HEAP HOLE :: PERCOLATE UP
+ * indexHole holds nothing of value. Move the parent
+ * down into it until the parent is at least as big
+ * as value. One move per level.
+ ***********************************************/
+template <size_t Arity>
+template <class T, class Compare, class Move>
+size_t heap_hole <Arity> :: percolateUp(const custom::vector<T> & container, size_t indexHole,
+                                       const T & value, const Compare & compare, Move move)
+{
+   size_t indexUp;
+   while ((indexUp = indexParent(indexHole)) &&
+          compare(container[indexUp - 1], value))
+   {
+      move(indexHole, indexUp);
+      indexHole = indexUp;
+   }
+   return indexHole;
+}
+
+};
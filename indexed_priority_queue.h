@@ -0,0 +1,295 @@
+/***********************************************************************
+ * Header:
+ *    INDEXED PRIORITY QUEUE
+ * Summary:
+ *    A priority queue of dense integer IDs 0..N, each with a priority
+ *    that can be changed or removed without any hashing
+ *
+ *    This will contain the class definition of:
+ *        indexed_priority_queue : A priority queue keyed by ID
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <functional>   // for std::less
+#include <stdexcept>    // for std::out_of_range
+#include "compare_holder.h"
+#include "vector.h"
+
+class TestIndexedPQueue;    // forward declaration for unit test class
+
+namespace custom
+{
+
+/*************************************************
+ * INDEXED P QUEUE
+ * The heap holds IDs. The priorities live in a flat
+ * vector indexed by ID, and so does the heap position
+ * of each ID, so finding an ID is one array access.
+ * Percolating moves IDs, never priorities.
+ *************************************************/
+template<class Priority, class Compare = std::less<Priority>, size_t Arity = 2>
+class indexed_priority_queue : private compare_holder<Compare>
+{
+   static_assert(Arity >= 2, "a heap needs at least two children per node");
+
+   friend class ::TestIndexedPQueue; // give the unit test class access to the privates
+
+public:
+
+   //
+   // construct
+   //
+
+   indexed_priority_queue() {}
+   explicit indexed_priority_queue(size_t numIDs, const Compare & compare = Compare()) : compare_holder<Compare>(compare)
+   {
+      reserve(numIDs);
+   }
+
+   //
+   // Access
+   //
+   size_t           top() const;                     // ID with the maximum priority
+   const Priority & top_priority() const;            // and its priority
+   const Priority & priority(size_t id) const;       // priority of any ID in the queue
+
+   //
+   // Insert
+   //
+   void push(size_t id, const Priority & priority);
+   void reserve(size_t numIDs);                      // make room for IDs 0..numIDs-1
+
+   //
+   // Update
+   //
+   void change(size_t id, const Priority & priority);
+
+   //
+   // Remove
+   //
+   void pop();
+   void remove(size_t id);
+   void clear();
+
+   //
+   // Status
+   //
+   bool   contains(size_t id) const { return id < positions.size() && positions[id] != 0; }
+   size_t size()  const             { return heap.size();  }
+   bool   empty() const             { return heap.empty(); }
+
+private:
+   void   fix(size_t indexHeap);                     // the ID at indexHeap changed priority
+   void   place(size_t indexTo, size_t id);          // put an ID into a slot
+   size_t percolateHoleDown(size_t indexHole, const Priority & value);
+   size_t percolateHoleUp(size_t indexHole, const Priority & value);
+   size_t indexBiggerChild(size_t indexHeap) const;
+   size_t checkID(size_t id) const;
+
+   // heap index of the first child and the parent of a heap index
+   static size_t indexChild(size_t indexHeap)  { return Arity * (indexHeap - 1) + 2; }
+   static size_t indexParent(size_t indexHeap) { return indexHeap > 1 ? (indexHeap - 2) / Arity + 1 : 0; }
+
+   // does the ID in slot lhs belong below the ID in slot rhs?
+   bool compare(const Priority & lhs, const Priority & rhs) const
+   {
+      return this->comparator()(lhs, rhs);
+   }
+   const Priority & at(size_t indexHeap) const { return priorities[heap[indexHeap - 1]]; }
+
+   custom::vector<size_t>   heap;           // slot (heap index - 1) -> ID
+   custom::vector<size_t>   positions;      // ID -> heap index, 0 when not in the queue
+   custom::vector<Priority> priorities;     // ID -> priority
+};
+
+/************************************************
+ * INDEXED P QUEUE :: TOP
+ ***********************************************/
+template <class Priority, class Compare, size_t Arity>
+size_t indexed_priority_queue <Priority, Compare, Arity> :: top() const
+{
+   if (empty())
+      throw std::out_of_range("std:out_of_range");
+   return heap.front();
+}
+
+template <class Priority, class Compare, size_t Arity>
+const Priority & indexed_priority_queue <Priority, Compare, Arity> :: top_priority() const
+{
+   return priorities[top()];
+}
+
+/************************************************
+ * INDEXED P QUEUE :: PRIORITY
+ ***********************************************/
+template <class Priority, class Compare, size_t Arity>
+const Priority & indexed_priority_queue <Priority, Compare, Arity> :: priority(size_t id) const
+{
+   checkID(id);
+   return priorities[id];
+}
+
+/************************************************
+ * INDEXED P QUEUE :: RESERVE
+ * Grow the two ID tables so IDs 0..numIDs-1 fit
+ ***********************************************/
+template <class Priority, class Compare, size_t Arity>
+void indexed_priority_queue <Priority, Compare, Arity> :: reserve(size_t numIDs)
+{
+   if (numIDs > positions.size())
+   {
+      positions.resize(numIDs, 0);
+      priorities.resize(numIDs);
+      heap.reserve(numIDs);
+   }
+}
+
+/************************************************
+ * INDEXED P QUEUE :: PUSH
+ * Add an ID that is not already in the queue
+ ***********************************************/
+template <class Priority, class Compare, size_t Arity>
+void indexed_priority_queue <Priority, Compare, Arity> :: push(size_t id, const Priority & priority)
+{
+   if (contains(id))
+      throw std::invalid_argument("ID is already in the priority queue");
+   if (id >= positions.size())
+      reserve(id + 1 > positions.size() * 2 ? id + 1 : positions.size() * 2);
+
+   priorities[id] = priority;
+   heap.push_back(id);
+   positions[id] = heap.size();
+   fix(heap.size());
+}
+
+/************************************************
+ * INDEXED P QUEUE :: CHANGE
+ * Give an ID a new priority, in either direction
+ ***********************************************/
+template <class Priority, class Compare, size_t Arity>
+void indexed_priority_queue <Priority, Compare, Arity> :: change(size_t id, const Priority & priority)
+{
+   size_t indexHeap = checkID(id);
+   priorities[id] = priority;
+   fix(indexHeap);
+}
+
+/************************************************
+ * INDEXED P QUEUE :: POP and REMOVE
+ * Fill the slot with the back ID and fix the heap
+ ***********************************************/
+template <class Priority, class Compare, size_t Arity>
+void indexed_priority_queue <Priority, Compare, Arity> :: pop()
+{
+   if (!empty())
+      remove(heap.front());
+}
+
+template <class Priority, class Compare, size_t Arity>
+void indexed_priority_queue <Priority, Compare, Arity> :: remove(size_t id)
+{
+   size_t indexHeap = checkID(id);
+   positions[id] = 0;
+
+   size_t idBack = heap.back();
+   heap.pop_back();
+   if (indexHeap <= heap.size())
+   {
+      place(indexHeap, idBack);
+      fix(indexHeap);
+   }
+}
+
+template <class Priority, class Compare, size_t Arity>
+void indexed_priority_queue <Priority, Compare, Arity> :: clear()
+{
+   for (size_t i = 0; i < heap.size(); i++)
+      positions[heap[i]] = 0;
+   heap.clear();
+}
+
+/************************************************
+ * INDEXED P QUEUE :: FIX
+ * The ID at indexHeap may be out of heap order in
+ * either direction. Move a hole rather than swapping.
+ ***********************************************/
+template <class Priority, class Compare, size_t Arity>
+void indexed_priority_queue <Priority, Compare, Arity> :: fix(size_t indexHeap)
+{
+   size_t id = heap[indexHeap - 1];
+   const Priority & value = priorities[id];
+
+   size_t indexUp = indexParent(indexHeap);
+   if (indexUp && compare(at(indexUp), value))
+      place(percolateHoleUp(indexHeap, value), id);
+   else
+      place(percolateHoleDown(indexHeap, value), id);
+}
+
+template <class Priority, class Compare, size_t Arity>
+void indexed_priority_queue <Priority, Compare, Arity> :: place(size_t indexTo, size_t id)
+{
+   heap[indexTo - 1] = id;
+   positions[id] = indexTo;
+}
+
+/************************************************
+ * INDEXED P QUEUE :: PERCOLATE HOLE
+ * Same as priority_queue, moving IDs
+ ***********************************************/
+template <class Priority, class Compare, size_t Arity>
+size_t indexed_priority_queue <Priority, Compare, Arity> :: percolateHoleDown(size_t indexHole, const Priority & value)
+{
+   size_t indexBigger;
+   while ((indexBigger = indexBiggerChild(indexHole)) &&
+          compare(value, at(indexBigger)))
+   {
+      place(indexHole, heap[indexBigger - 1]);
+      indexHole = indexBigger;
+   }
+   return indexHole;
+}
+
+template <class Priority, class Compare, size_t Arity>
+size_t indexed_priority_queue <Priority, Compare, Arity> :: percolateHoleUp(size_t indexHole, const Priority & value)
+{
+   size_t indexUp;
+   while ((indexUp = indexParent(indexHole)) &&
+          compare(at(indexUp), value))
+   {
+      place(indexHole, heap[indexUp - 1]);
+      indexHole = indexUp;
+   }
+   return indexHole;
+}
+
+template <class Priority, class Compare, size_t Arity>
+size_t indexed_priority_queue <Priority, Compare, Arity> :: indexBiggerChild(size_t indexHeap) const
+{
+   size_t indexFirst = indexChild(indexHeap);
+   if (indexFirst > size())
+      return 0;
+
+   size_t indexBigger = indexFirst;
+   size_t indexLast = indexFirst + Arity - 1 < size() ? indexFirst + Arity - 1 : size();
+   for (size_t index = indexFirst + 1; index <= indexLast; index++)
+      if (compare(at(indexBigger), at(index)))
+         indexBigger = index;
+   return indexBigger;
+}
+
+/************************************************
+ * INDEXED P QUEUE :: CHECK ID
+ * Find where an ID lives, throwing if it is not here
+ ***********************************************/
+template <class Priority, class Compare, size_t Arity>
+size_t indexed_priority_queue <Priority, Compare, Arity> :: checkID(size_t id) const
+{
+   if (!contains(id))
+      throw std::out_of_range("std:out_of_range");
+   return positions[id];
+}
+
+};
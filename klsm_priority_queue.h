@@ -0,0 +1,482 @@
+/***********************************************************************
+ * Header:
+ *    K-LSM PRIORITY QUEUE
+ * Summary:
+ *    A relaxed concurrent priority queue built from log-structured
+ *    merge runs: every thread buffers up to k elements in its own
+ *    runs, and the rest live in one shared set of runs
+ *
+ *    This will contain the class definition of:
+ *        lsm_runs               : Sorted runs merged like an LSM tree
+ *        klsm_priority_queue    : The k-relaxed priority queue
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <atomic>       // for std::atomic
+#include <mutex>        // for std::mutex
+#include <functional>   // for std::less
+#include <cstdint>      // for uint64_t
+#include "compare_holder.h"
+#include "thread_slots.h"
+#include "vector.h"
+
+class TestKLSMPQueue;    // forward declaration for unit test class
+
+namespace custom
+{
+
+/*************************************************
+ * LSM RUNS
+ * Sorted runs, each with its best element at the back,
+ * kept in strictly falling order of size: adding a run
+ * merges it with every run not bigger than it, so there
+ * are O(log n) runs and each element is merged O(log n)
+ * times. The best element is the best of the backs.
+ *************************************************/
+template<class T, class Compare = std::less<T>>
+class lsm_runs : private compare_holder<Compare>
+{
+   friend class ::TestKLSMPQueue; // give the unit test class access to the privates
+
+public:
+   explicit lsm_runs(const Compare & compare = Compare()) : compare_holder<Compare>(compare), numElements(0) {}
+
+   const T & top() const { return runs[indexBest()].back(); }
+   void push(const T & t);
+   void push_run(custom::vector<T> && run);    // run must be sorted best-last
+   void pop();
+   custom::vector<T> take_all();              // everything as one run, leaving this empty
+
+   size_t size()  const { return numElements;      }
+   bool   empty() const { return numElements == 0; }
+
+private:
+   size_t indexBest() const;
+   void   merge(custom::vector<T> & lhs, custom::vector<T> & rhs, custom::vector<T> & out) const;
+
+   // does lhs belong below rhs in the heap?
+   bool compare(const T & lhs, const T & rhs) const
+   {
+      return this->comparator()(lhs, rhs);
+   }
+
+   custom::vector<custom::vector<T>> runs;    // biggest first
+   size_t                            numElements;
+};
+
+/************************************************
+ * LSM RUNS :: PUSH
+ ***********************************************/
+template <class T, class Compare>
+void lsm_runs <T, Compare> :: push(const T & t)
+{
+   custom::vector<T> run;
+   run.push_back(t);
+   push_run(std::move(run));
+}
+
+template <class T, class Compare>
+void lsm_runs <T, Compare> :: push_run(custom::vector<T> && run)
+{
+   if (run.empty())
+      return;
+   numElements += run.size();
+
+   custom::vector<T> merged(std::move(run));
+   while (!runs.empty() && runs.back().size() <= merged.size())
+   {
+      custom::vector<T> out;
+      merge(runs.back(), merged, out);
+      runs.pop_back();
+      merged = std::move(out);
+   }
+   runs.push_back(std::move(merged));
+}
+
+/************************************************
+ * LSM RUNS :: POP
+ * Take the best back. A run that shrinks below the one
+ * after it is merged down to keep the sizes falling.
+ ***********************************************/
+template <class T, class Compare>
+void lsm_runs <T, Compare> :: pop()
+{
+   assert(!empty());
+   size_t index = indexBest();
+   runs[index].pop_back();
+   numElements--;
+
+   if (runs[index].empty() ||
+       (index + 1 < runs.size() && runs[index].size() <= runs[index + 1].size()))
+   {
+      // take out every run from index on and add them back, smallest first
+      custom::vector<custom::vector<T>> tail;
+      while (runs.size() > index)
+      {
+         numElements -= runs.back().size();
+         tail.push_back(std::move(runs.back()));
+         runs.pop_back();
+      }
+      for (size_t i = 0; i < tail.size(); i++)
+         push_run(std::move(tail[i]));
+   }
+}
+
+/************************************************
+ * LSM RUNS :: TAKE ALL
+ ***********************************************/
+template <class T, class Compare>
+custom::vector<T> lsm_runs <T, Compare> :: take_all()
+{
+   custom::vector<T> all;
+   while (!runs.empty())
+   {
+      custom::vector<T> out;
+      merge(runs.back(), all, out);
+      runs.pop_back();
+      all = std::move(out);
+   }
+   numElements = 0;
+   return all;
+}
+
+/************************************************
+ * LSM RUNS :: INDEX BEST
+ ***********************************************/
+template <class T, class Compare>
+size_t lsm_runs <T, Compare> :: indexBest() const
+{
+   assert(!empty());
+   size_t indexBest = 0;
+   while (runs[indexBest].empty())
+      indexBest++;
+   for (size_t i = indexBest + 1; i < runs.size(); i++)
+      if (!runs[i].empty() && compare(runs[indexBest].back(), runs[i].back()))
+         indexBest = i;
+   return indexBest;
+}
+
+/************************************************
+ * LSM RUNS :: MERGE
+ * Two best-last runs into one, moving the elements
+ ***********************************************/
+template <class T, class Compare>
+void lsm_runs <T, Compare> :: merge(custom::vector<T> & lhs, custom::vector<T> & rhs,
+                                    custom::vector<T> & out) const
+{
+   out.reserve(lhs.size() + rhs.size());
+   size_t iLhs = 0;
+   size_t iRhs = 0;
+   while (iLhs < lhs.size() && iRhs < rhs.size())
+      if (compare(rhs[iRhs], lhs[iLhs]))
+         out.push_back(std::move(rhs[iRhs++]));
+      else
+         out.push_back(std::move(lhs[iLhs++]));
+   while (iLhs < lhs.size())
+      out.push_back(std::move(lhs[iLhs++]));
+   while (iRhs < rhs.size())
+      out.push_back(std::move(rhs[iRhs++]));
+}
+
+/*************************************************
+ * K-LSM PRIORITY QUEUE
+ * Every thread keeps a local lsm_runs of at most k
+ * elements; once it would hold more, the whole local
+ * component is merged into one run and handed to the
+ * shared lsm_runs. Pop takes the better of the local
+ * best and the shared best. A thread keeps a copy of
+ * the shared best stamped with the shared version, so
+ * it only takes the shared lock when the shared best
+ * wins or has changed. The only elements a pop cannot
+ * see are the other threads' local ones, so it returns
+ * one of the best k * (threads - 1) + 1 elements. With
+ * k = 0 it is exact. A thread that finds nothing takes
+ * over another thread's local elements. A thread that
+ * exits hands its local elements to the shared part and
+ * frees its Local for the next thread.
+ *************************************************/
+template<class T, class Compare = std::less<T>>
+class klsm_priority_queue : private compare_holder<Compare>
+{
+   friend class ::TestKLSMPQueue; // give the unit test class access to the privates
+
+public:
+
+   //
+   // construct
+   //
+
+   explicit klsm_priority_queue(size_t k = 256, const Compare & compare = Compare());
+   klsm_priority_queue(const klsm_priority_queue & rhs) = delete;
+   klsm_priority_queue & operator = (const klsm_priority_queue & rhs) = delete;
+  ~klsm_priority_queue() { slots.close(); delete [] locals; }
+
+   //
+   // Insert
+   //
+   void push(const T & t);
+
+   //
+   // Remove
+   //
+   bool try_pop(T & t);    // false when every component was empty
+
+   //
+   // Status. Only a snapshot while other threads are working
+   //
+   size_t size() const;
+   bool   empty() const { return size() == 0; }
+   size_t relaxation() const { return k; }
+
+private:
+   enum { MAX_LOCALS = 128 };     // threads past this share the shared component directly
+
+   // the part of the queue one thread owns; others lock it only to steal
+   struct alignas(64) Local
+   {
+      Local() : claimed(false), numElements(0), cachedVersion(~uint64_t(0)), cachedEmpty(true) {}
+      std::atomic<bool>     claimed;
+      std::mutex            lock;
+      lsm_runs<T, Compare>  runs;
+      std::atomic<size_t>   numElements;    // read without the lock by size()
+      uint64_t              cachedVersion;  // the shared version cachedBest was copied at
+      bool                  cachedEmpty;
+      T                     cachedBest;
+   };
+
+   Local * local();                        // this thread's part, or nullptr if none are left
+   static void release(void * queue, void * local);   // the thread that owned local has exited
+   void    refreshCache(Local & l);        // copy the shared best if it changed; no shared lock held
+   bool    popShared(T & t);
+   bool    steal(Local * self);            // move another thread's elements to the shared part
+
+   // does lhs belong below rhs in the heap?
+   bool compare(const T & lhs, const T & rhs) const
+   {
+      return this->comparator()(lhs, rhs);
+   }
+
+   size_t                 k;
+   Local *                locals;
+   thread_slots           slots;           // which Local each thread claimed
+   std::mutex             sharedLock;
+   lsm_runs<T, Compare>   shared;
+   std::atomic<size_t>    sharedSize;
+   std::atomic<uint64_t>  sharedVersion;   // bumped under sharedLock whenever shared changes
+};
+
+/************************************************
+ * K-LSM PRIORITY QUEUE :: CONSTRUCTOR
+ ***********************************************/
+template <class T, class Compare>
+klsm_priority_queue <T, Compare> :: klsm_priority_queue(size_t k, const Compare & compare) :
+   compare_holder<Compare>(compare), k(k), locals(new Local[MAX_LOCALS]), slots(this, &release),
+   shared(compare), sharedSize(0), sharedVersion(0)
+{
+   for (size_t i = 0; i < MAX_LOCALS; i++)
+      locals[i].runs = lsm_runs<T, Compare>(compare);
+}
+
+/************************************************
+ * K-LSM PRIORITY QUEUE :: PUSH
+ * Into the local runs; hand them all to the shared runs
+ * once there are more than k
+ ***********************************************/
+template <class T, class Compare>
+void klsm_priority_queue <T, Compare> :: push(const T & t)
+{
+   Local * l = local();
+   if (l)
+   {
+      std::lock_guard<std::mutex> guard(l->lock);
+      l->runs.push(t);
+      if (l->runs.size() <= k)
+      {
+         l->numElements.store(l->runs.size());
+         return;
+      }
+
+      custom::vector<T> run = l->runs.take_all();
+      l->numElements.store(0);
+      std::lock_guard<std::mutex> guardShared(sharedLock);
+      shared.push_run(std::move(run));
+      sharedSize.store(shared.size());
+      sharedVersion++;
+      return;
+   }
+
+   std::lock_guard<std::mutex> guardShared(sharedLock);
+   shared.push(t);
+   sharedSize.store(shared.size());
+   sharedVersion++;
+}
+
+/************************************************
+ * K-LSM PRIORITY QUEUE :: TRY POP
+ * The better of the local best and the shared best.
+ * If both are empty, steal and try again.
+ ***********************************************/
+template <class T, class Compare>
+bool klsm_priority_queue <T, Compare> :: try_pop(T & t)
+{
+   Local * l = local();
+   if (!l)
+      return popShared(t) || (steal(nullptr) && popShared(t));
+
+   for (;;)
+   {
+      {
+         std::lock_guard<std::mutex> guard(l->lock);
+         refreshCache(*l);
+         if (!l->runs.empty() && (l->cachedEmpty || !compare(l->runs.top(), l->cachedBest)))
+         {
+            t = std::move(const_cast<T &>(l->runs.top()));
+            l->runs.pop();
+            l->numElements.store(l->runs.size());
+            return true;
+         }
+      }
+
+      // the shared best looked better, or there was nothing local
+      if (popShared(t))
+         return true;
+
+      {
+         std::lock_guard<std::mutex> guard(l->lock);
+         if (!l->runs.empty())
+            continue;
+      }
+      if (!steal(l))
+         return false;
+   }
+}
+
+/************************************************
+ * K-LSM PRIORITY QUEUE :: POP SHARED
+ ***********************************************/
+template <class T, class Compare>
+bool klsm_priority_queue <T, Compare> :: popShared(T & t)
+{
+   std::lock_guard<std::mutex> guard(sharedLock);
+   if (shared.empty())
+      return false;
+   t = std::move(const_cast<T &>(shared.top()));
+   shared.pop();
+   sharedSize.store(shared.size());
+   sharedVersion++;
+   return true;
+}
+
+/************************************************
+ * K-LSM PRIORITY QUEUE :: REFRESH CACHE
+ * Only the version is read unless the shared part has
+ * changed since the last look
+ ***********************************************/
+template <class T, class Compare>
+void klsm_priority_queue <T, Compare> :: refreshCache(Local & l)
+{
+   if (l.cachedVersion == sharedVersion.load())
+      return;
+
+   std::lock_guard<std::mutex> guard(sharedLock);
+   l.cachedVersion = sharedVersion.load();
+   l.cachedEmpty = shared.empty();
+   if (!l.cachedEmpty)
+      l.cachedBest = shared.top();
+}
+
+/************************************************
+ * K-LSM PRIORITY QUEUE :: STEAL
+ * Hand the local elements of the first thread that
+ * has any to the shared part
+ ***********************************************/
+template <class T, class Compare>
+bool klsm_priority_queue <T, Compare> :: steal(Local * self)
+{
+   for (size_t i = 0; i < MAX_LOCALS; i++)
+   {
+      Local & victim = locals[i];
+      if (&victim == self || victim.numElements.load() == 0)
+         continue;
+
+      std::lock_guard<std::mutex> guard(victim.lock);
+      if (victim.runs.empty())
+         continue;
+      custom::vector<T> run = victim.runs.take_all();
+      victim.numElements.store(0);
+
+      std::lock_guard<std::mutex> guardShared(sharedLock);
+      shared.push_run(std::move(run));
+      sharedSize.store(shared.size());
+      sharedVersion++;
+      return true;
+   }
+   return false;
+}
+
+/************************************************
+ * K-LSM PRIORITY QUEUE :: LOCAL
+ * Each thread remembers which Local it claimed in
+ * each queue it has used
+ ***********************************************/
+template <class T, class Compare>
+typename klsm_priority_queue <T, Compare> :: Local *
+klsm_priority_queue <T, Compare> :: local()
+{
+   if (void * l = slots.find())
+      return static_cast<Local *>(l);
+
+   for (size_t i = 0; i < MAX_LOCALS; i++)
+   {
+      bool expected = false;
+      if (!locals[i].claimed.load() && locals[i].claimed.compare_exchange_strong(expected, true))
+      {
+         slots.remember(locals + i);
+         return locals + i;
+      }
+   }
+   return nullptr;
+}
+
+/************************************************
+ * K-LSM PRIORITY QUEUE :: RELEASE
+ * Move what the exited thread left to the shared part
+ * so nobody has to steal it, then free the Local. The
+ * next owner must not trust the cached shared best.
+ ***********************************************/
+template <class T, class Compare>
+void klsm_priority_queue <T, Compare> :: release(void * queue, void * local)
+{
+   klsm_priority_queue & pq = *static_cast<klsm_priority_queue *>(queue);
+   Local & l = *static_cast<Local *>(local);
+   {
+      std::lock_guard<std::mutex> guard(l.lock);
+      if (!l.runs.empty())
+      {
+         custom::vector<T> run = l.runs.take_all();
+         std::lock_guard<std::mutex> guardShared(pq.sharedLock);
+         pq.shared.push_run(std::move(run));
+         pq.sharedSize.store(pq.shared.size());
+         pq.sharedVersion++;
+      }
+      l.numElements.store(0);
+      l.cachedVersion = ~uint64_t(0);
+   }
+   l.claimed.store(false);
+}
+
+/************************************************
+ * K-LSM PRIORITY QUEUE :: SIZE
+ ***********************************************/
+template <class T, class Compare>
+size_t klsm_priority_queue <T, Compare> :: size() const
+{
+   size_t num = sharedSize.load();
+   for (size_t i = 0; i < MAX_LOCALS; i++)
+      num += locals[i].numElements.load();
+   return num;
+}
+
+};
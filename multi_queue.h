@@ -0,0 +1,279 @@
+/***********************************************************************
+ * Header:
+ *    MULTI QUEUE
+ * Summary:
+ *    A relaxed concurrent priority queue: many locked priority_queue
+ *    shards instead of one, so threads rarely wait on each other
+ *
+ *    This will contain the class definition of:
+ *        multi_queue            : A sharded priority queue for many threads
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <atomic>       // for std::atomic
+#include <mutex>        // for std::mutex
+#include <thread>       // for std::thread::hardware_concurrency
+#include <functional>   // for std::less, std::hash
+#include <cstdint>      // for uint64_t
+#include "compare_holder.h"
+#include "priority_queue.h"
+
+class TestMultiQueue;    // forward declaration for unit test class
+
+namespace custom
+{
+
+/*************************************************
+ * MULTI QUEUE
+ * shardsPerThread * numThreads priority_queues, each
+ * behind its own lock. Push locks one random shard.
+ * Pop locks numSamples random shards and takes the
+ * better of their tops, so the element popped is
+ * usually among the top few hundred but not always
+ * the very top. More shards per thread means less
+ * waiting; more samples means a better element. One
+ * shard is an exact priority queue behind one lock.
+ *************************************************/
+template<class T, class Compare = std::less<T>, size_t Arity = 2>
+class multi_queue : private compare_holder<Compare>
+{
+   friend class ::TestMultiQueue; // give the unit test class access to the privates
+
+public:
+
+   //
+   // construct
+   //
+
+   multi_queue(size_t numThreads = std::thread::hardware_concurrency(),
+               size_t shardsPerThread = 2, size_t numSamples = 2,
+               const Compare & compare = Compare());
+   multi_queue(const multi_queue & rhs) = delete;
+   multi_queue & operator = (const multi_queue & rhs) = delete;
+  ~multi_queue() { delete [] shards; }
+
+   //
+   // Insert
+   //
+   void push(const T & t);
+   void push(T && t);
+
+   //
+   // Remove
+   //
+   bool try_pop(T & t);    // false only when every shard was empty
+
+   //
+   // Status. Only a snapshot while other threads are working
+   //
+   size_t size() const;
+   bool   empty() const { return size() == 0; }
+   size_t num_shards() const { return numShards; }
+
+private:
+   enum { MAX_SAMPLES = 8 };
+
+   // one shard per cache line so neighboring locks do not share one
+   struct alignas(64) Shard
+   {
+      Shard() : numElements(0) {}
+      std::mutex                               lock;
+      custom::priority_queue<T, Compare, Arity> heap;
+      std::atomic<size_t>                      numElements;   // read without the lock
+   };
+
+   template <class U>
+   void   pushShard(U && t);
+   bool   popScan(T & t);                        // visit every shard once
+   size_t randomShard() const { return size_t(random() % numShards); }
+
+   // does lhs belong below rhs in the heap?
+   bool compare(const T & lhs, const T & rhs) const
+   {
+      return this->comparator()(lhs, rhs);
+   }
+
+   static uint64_t random();                     // xorshift, one state per thread
+
+   Shard * shards;
+   size_t  numShards;
+   size_t  numSamples;
+};
+
+/************************************************
+ * MULTI QUEUE :: CONSTRUCTOR
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+multi_queue <T, Compare, Arity> :: multi_queue(size_t numThreads, size_t shardsPerThread,
+                                               size_t numSamples, const Compare & compare) :
+   compare_holder<Compare>(compare), shards(nullptr), numShards(0), numSamples(numSamples)
+{
+   if (numThreads == 0)
+      numThreads = 1;
+   if (shardsPerThread == 0)
+      shardsPerThread = 1;
+   if (this->numSamples == 0)
+      this->numSamples = 1;
+   if (this->numSamples > MAX_SAMPLES)
+      this->numSamples = MAX_SAMPLES;
+
+   numShards = numThreads * shardsPerThread;
+   shards = new Shard[numShards];
+   for (size_t i = 0; i < numShards; i++)
+   {
+      custom::priority_queue<T, Compare, Arity> heap(compare);
+      swap(shards[i].heap, heap);
+   }
+}
+
+/************************************************
+ * MULTI QUEUE :: PUSH
+ * Into a random shard. If it is busy, try another
+ * rather than wait.
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+void multi_queue <T, Compare, Arity> :: push(const T & t)
+{
+   pushShard(t);
+}
+
+template <class T, class Compare, size_t Arity>
+void multi_queue <T, Compare, Arity> :: push(T && t)
+{
+   pushShard(std::move(t));
+}
+
+template <class T, class Compare, size_t Arity>
+template <class U>
+void multi_queue <T, Compare, Arity> :: pushShard(U && t)
+{
+   Shard * shard = shards + randomShard();
+   while (!shard->lock.try_lock())
+      shard = shards + randomShard();
+
+   shard->heap.push(std::forward<U>(t));
+   shard->numElements.store(shard->heap.size(), std::memory_order_relaxed);
+   shard->lock.unlock();
+}
+
+/************************************************
+ * MULTI QUEUE :: TRY POP
+ * Lock numSamples distinct random shards in index
+ * order, so two poppers can never wait on each other
+ * in a cycle, and pop the best of their tops. If they
+ * were all empty, fall back to visiting every shard.
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+bool multi_queue <T, Compare, Arity> :: try_pop(T & t)
+{
+   size_t numPicked = numSamples < numShards ? numSamples : numShards;
+   size_t picked[MAX_SAMPLES];
+
+   // choose distinct shards, skipping the ones that look empty
+   size_t numChosen = 0;
+   for (size_t i = 0; i < numPicked; i++)
+   {
+      size_t index = randomShard();
+      if (shards[index].numElements.load(std::memory_order_relaxed) == 0)
+         continue;
+
+      bool duplicate = false;
+      for (size_t k = 0; k < numChosen; k++)
+         duplicate = duplicate || picked[k] == index;
+      if (duplicate)
+         continue;
+
+      // insertion sort keeps the lock order
+      size_t j = numChosen;
+      while (j > 0 && picked[j - 1] > index)
+      {
+         picked[j] = picked[j - 1];
+         j--;
+      }
+      picked[j] = index;
+      numChosen++;
+   }
+   if (numChosen == 0)
+      return popScan(t);
+
+   for (size_t i = 0; i < numChosen; i++)
+      shards[picked[i]].lock.lock();
+
+   // the best top among the shards that are still not empty
+   Shard * best = nullptr;
+   for (size_t i = 0; i < numChosen; i++)
+   {
+      Shard * shard = shards + picked[i];
+      if (!shard->heap.empty() && (!best || compare(best->heap.top(), shard->heap.top())))
+         best = shard;
+   }
+   if (best)
+   {
+      t = std::move(const_cast<T &>(best->heap.top()));
+      best->heap.pop();
+      best->numElements.store(best->heap.size(), std::memory_order_relaxed);
+   }
+
+   for (size_t i = 0; i < numChosen; i++)
+      shards[picked[i]].lock.unlock();
+
+   return best ? true : popScan(t);
+}
+
+/************************************************
+ * MULTI QUEUE :: POP SCAN
+ * Visit every shard from a random start and pop the
+ * top of the first one that has anything
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+bool multi_queue <T, Compare, Arity> :: popScan(T & t)
+{
+   size_t start = randomShard();
+   for (size_t i = 0; i < numShards; i++)
+   {
+      Shard & shard = shards[(start + i) % numShards];
+      if (shard.numElements.load(std::memory_order_relaxed) == 0)
+         continue;
+
+      std::lock_guard<std::mutex> guard(shard.lock);
+      if (shard.heap.empty())
+         continue;
+      t = std::move(const_cast<T &>(shard.heap.top()));
+      shard.heap.pop();
+      shard.numElements.store(shard.heap.size(), std::memory_order_relaxed);
+      return true;
+   }
+   return false;
+}
+
+/************************************************
+ * MULTI QUEUE :: SIZE
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+size_t multi_queue <T, Compare, Arity> :: size() const
+{
+   size_t num = 0;
+   for (size_t i = 0; i < numShards; i++)
+      num += shards[i].numElements.load(std::memory_order_relaxed);
+   return num;
+}
+
+/************************************************
+ * MULTI QUEUE :: RANDOM
+ * A cheap generator per thread; std::mt19937 is too
+ * big to keep per thread and too slow to share
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+uint64_t multi_queue <T, Compare, Arity> :: random()
+{
+   thread_local uint64_t state =
+      std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+   state ^= state << 13;
+   state ^= state >> 7;
+   state ^= state << 17;
+   return state;
+}
+
+};
@@ -0,0 +1,172 @@
+/***********************************************************************
+ * Header:
+ *    NODE POOL
+ * Summary:
+ *    Hands out fixed-size node slots carved from large blocks so a
+ *    linked structure does not call new once per element
+ *
+ *    This will contain the class definition of:
+ *        node_pool              : A free-list allocator for one node type
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <new>      // for ::operator new
+#include <cstddef>  // for size_t
+
+class TestPairingHeap;    // forward declaration for unit test class
+
+namespace custom
+{
+
+/*************************************************
+ * NODE POOL
+ * Blocks are chained together through a small header
+ * and freed slots are chained into a free list, each
+ * with a tail pointer so two pools splice in O(1).
+ * Blocks double in size from MIN_BLOCK to MAX_BLOCK.
+ * The pool hands out raw memory: the caller constructs
+ * and destroys the node with placement new.
+ *************************************************/
+template <class Node>
+class node_pool
+{
+   friend class ::TestPairingHeap;
+
+public:
+   node_pool() : blocks(nullptr), blocksTail(nullptr),
+                 freeList(nullptr), freeTail(nullptr), blockSize(MIN_BLOCK) {}
+   node_pool(const node_pool & rhs) = delete;
+   node_pool & operator = (const node_pool & rhs) = delete;
+  ~node_pool();
+
+   void * allocate();                 // memory for one node
+   void deallocate(void * p);         // give the memory back
+   void splice(node_pool & rhs);      // take over all of the memory of rhs
+
+private:
+   enum { MIN_BLOCK = 64, MAX_BLOCK = 65536 };
+
+   struct Block { Block * next; };
+   struct Free  { Free  * next; };
+   static_assert(sizeof(Node) >= sizeof(Free), "a node must be able to hold a free list link");
+
+   // the nodes start after the header, suitably aligned
+   static size_t headerSize()
+   {
+      return (sizeof(Block) + alignof(Node) - 1) / alignof(Node) * alignof(Node);
+   }
+
+   void grow();
+
+   Block * blocks;        // every block this pool owns
+   Block * blocksTail;
+   Free  * freeList;      // every slot not in use
+   Free  * freeTail;
+   size_t  blockSize;     // the number of nodes in the next block
+};
+
+/*****************************************
+ * NODE POOL :: DESTRUCTOR
+ * Free every block. Live nodes must already be destroyed
+ ****************************************/
+template <class Node>
+node_pool <Node> :: ~node_pool()
+{
+   while (blocks)
+   {
+      Block * next = blocks->next;
+      ::operator delete(blocks);
+      blocks = next;
+   }
+}
+
+/*****************************************
+ * NODE POOL :: ALLOCATE
+ * Take a slot from the free list, growing if needed
+ ****************************************/
+template <class Node>
+void * node_pool <Node> :: allocate()
+{
+   if (!freeList)
+      grow();
+   Free * slot = freeList;
+   freeList = slot->next;
+   if (!freeList)
+      freeTail = nullptr;
+   return slot;
+}
+
+/*****************************************
+ * NODE POOL :: DEALLOCATE
+ * Return a slot to the front of the free list
+ ****************************************/
+template <class Node>
+void node_pool <Node> :: deallocate(void * p)
+{
+   assert(p != nullptr);
+   Free * slot = static_cast<Free *>(p);
+   slot->next = freeList;
+   freeList = slot;
+   if (!freeTail)
+      freeTail = slot;
+}
+
+/*****************************************
+ * NODE POOL :: SPLICE
+ * Adopt all the blocks and free slots of rhs so that
+ * nodes allocated from rhs outlive it
+ ****************************************/
+template <class Node>
+void node_pool <Node> :: splice(node_pool & rhs)
+{
+   if (this == &rhs)
+      return;
+
+   if (rhs.blocks)
+   {
+      rhs.blocksTail->next = blocks;
+      if (!blocks)
+         blocksTail = rhs.blocksTail;
+      blocks = rhs.blocks;
+   }
+   if (rhs.freeList)
+   {
+      rhs.freeTail->next = freeList;
+      if (!freeList)
+         freeTail = rhs.freeTail;
+      freeList = rhs.freeList;
+   }
+   if (rhs.blockSize > blockSize)
+      blockSize = rhs.blockSize;
+
+   rhs.blocks = rhs.blocksTail = nullptr;
+   rhs.freeList = rhs.freeTail = nullptr;
+   rhs.blockSize = MIN_BLOCK;
+}
+
+/*****************************************
+ * NODE POOL :: GROW
+ * Allocate the next block and thread its slots onto
+ * the free list
+ ****************************************/
+template <class Node>
+void node_pool <Node> :: grow()
+{
+   char * memory = static_cast<char *>(::operator new(headerSize() + blockSize * sizeof(Node)));
+   Block * block = reinterpret_cast<Block *>(memory);
+   block->next = blocks;
+   blocks = block;
+   if (!blocksTail)
+      blocksTail = block;
+
+   // thread from the back so the slots are handed out in address order
+   for (size_t i = blockSize; i > 0; i--)
+      deallocate(memory + headerSize() + (i - 1) * sizeof(Node));
+
+   if (blockSize < MAX_BLOCK)
+      blockSize *= 2;
+}
+
+};
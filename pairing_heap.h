@@ -0,0 +1,315 @@
+/***********************************************************************
+ * Header:
+ *    PAIRING HEAP
+ * Summary:
+ *    A heap-ordered multiway tree with O(1) push and merge and
+ *    amortized O(log n) pop
+ *
+ *    This will contain the class definition of:
+ *        pairing_heap           : A priority queue built from linked nodes
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <functional>   // for std::less
+#include <stdexcept>    // for std::out_of_range
+#include "compare_holder.h"
+#include "vector.h"
+#include "node_pool.h"
+
+class TestPairingHeap;    // forward declaration for unit test class
+
+namespace custom
+{
+
+/*************************************************
+ * PAIRING HEAP
+ * Same interface as priority_queue, plus merge and
+ * decrease_key. Each node keeps its leftmost child,
+ * its right sibling, and prev: the left sibling, or
+ * the parent for a leftmost child. Nodes come from a
+ * node_pool so push does not call new.
+ *************************************************/
+template<class T, class Compare = std::less<T>>
+class pairing_heap : private compare_holder<Compare>
+{
+   friend class ::TestPairingHeap; // give the unit test class access to the privates
+
+public:
+   struct Node;
+   typedef Node * handle;          // stays valid until the element is popped
+
+   //
+   // construct
+   //
+
+   pairing_heap() : root(nullptr), numElements(0) {}
+   explicit pairing_heap(const Compare & compare) : compare_holder<Compare>(compare), root(nullptr), numElements(0) {}
+   pairing_heap(const pairing_heap & rhs) = delete;
+   pairing_heap(pairing_heap && rhs) : compare_holder<Compare>(rhs), root(rhs.root), numElements(rhs.numElements)
+   {
+      pool.splice(rhs.pool);
+      rhs.root = nullptr;
+      rhs.numElements = 0;
+   }
+  ~pairing_heap() { clear(); }
+
+   //
+   // Access
+   //
+   const T & top() const;
+
+   //
+   // Insert
+   //
+   handle push(const T & t);
+   handle push(T && t);
+   void   merge(pairing_heap & rhs);          // take every element of rhs, leaving it empty
+
+   //
+   // Update
+   //
+   void decrease_key(handle h, const T & t);  // move an element toward the top
+
+   //
+   // Remove
+   //
+   void pop();
+   void clear();
+
+   //
+   // Status
+   //
+   size_t size()  const { return numElements;      }
+   bool   empty() const { return numElements == 0; }
+
+   struct Node
+   {
+   private:
+      friend class pairing_heap;
+      friend class ::TestPairingHeap;
+      template <class U>
+      Node(U && data) : data(std::forward<U>(data)), child(nullptr), next(nullptr), prev(nullptr) {}
+
+      T      data;
+      Node * child;     // leftmost child
+      Node * next;      // right sibling
+      Node * prev;      // left sibling, or parent if this is the leftmost child
+   public:
+      const T & value() const { return data; }
+   };
+
+private:
+   Node * link(Node * lhs, Node * rhs);      // join two roots, return the new root
+   Node * combine(Node * first);             // two-pass pairing of a sibling list
+   void   destroy(Node * node);
+
+   template <class U>
+   handle emplaceNode(U && data);
+
+   // does lhs belong below rhs in the heap?
+   bool compare(const T & lhs, const T & rhs) const
+   {
+      return this->comparator()(lhs, rhs);
+   }
+
+   Node *                  root;
+   size_t                  numElements;
+   node_pool<Node>         pool;
+   custom::vector<Node *>  scratch;          // reused by combine so pop does not allocate
+};
+
+/************************************************
+ * PAIRING HEAP :: TOP
+ ***********************************************/
+template <class T, class Compare>
+const T & pairing_heap <T, Compare> :: top() const
+{
+   if (empty())
+      throw std::out_of_range("std:out_of_range");
+   return root->data;
+}
+
+/************************************************
+ * PAIRING HEAP :: PUSH
+ * A new node is a one-element heap linked to the root
+ ***********************************************/
+template <class T, class Compare>
+typename pairing_heap <T, Compare> :: handle
+pairing_heap <T, Compare> :: push(const T & t)
+{
+   return emplaceNode(t);
+}
+
+template <class T, class Compare>
+typename pairing_heap <T, Compare> :: handle
+pairing_heap <T, Compare> :: push(T && t)
+{
+   return emplaceNode(std::move(t));
+}
+
+template <class T, class Compare>
+template <class U>
+typename pairing_heap <T, Compare> :: handle
+pairing_heap <T, Compare> :: emplaceNode(U && data)
+{
+   Node * node = new (pool.allocate()) Node(std::forward<U>(data));
+   root = root ? link(root, node) : node;
+   numElements++;
+   return node;
+}
+
+/************************************************
+ * PAIRING HEAP :: MERGE
+ * Link the two roots and adopt the memory of rhs
+ ***********************************************/
+template <class T, class Compare>
+void pairing_heap <T, Compare> :: merge(pairing_heap & rhs)
+{
+   if (this == &rhs || rhs.empty())
+      return;
+
+   root = root ? link(root, rhs.root) : rhs.root;
+   numElements += rhs.numElements;
+   pool.splice(rhs.pool);
+
+   rhs.root = nullptr;
+   rhs.numElements = 0;
+}
+
+/************************************************
+ * PAIRING HEAP :: DECREASE KEY
+ * Give an element a value that belongs at least as high
+ * as the old one (a larger value for a max-heap). Cut its
+ * subtree loose and link it with the root.
+ ***********************************************/
+template <class T, class Compare>
+void pairing_heap <T, Compare> :: decrease_key(handle h, const T & t)
+{
+   assert(h != nullptr);
+   if (compare(t, h->data))
+      throw std::invalid_argument("decrease_key would move the element down");
+
+   h->data = t;
+   if (h == root)
+      return;
+
+   // cut h out of its sibling list
+   if (h->prev->child == h)
+      h->prev->child = h->next;
+   else
+      h->prev->next = h->next;
+   if (h->next)
+      h->next->prev = h->prev;
+   h->prev = h->next = nullptr;
+
+   root = link(root, h);
+}
+
+/************************************************
+ * PAIRING HEAP :: POP
+ * Remove the root and pair up its children
+ ***********************************************/
+template <class T, class Compare>
+void pairing_heap <T, Compare> :: pop()
+{
+   if (empty())
+      return;
+
+   Node * oldRoot = root;
+   root = combine(root->child);
+   destroy(oldRoot);
+   numElements--;
+}
+
+/************************************************
+ * PAIRING HEAP :: CLEAR
+ * Destroy every node, walking the tree with a stack
+ ***********************************************/
+template <class T, class Compare>
+void pairing_heap <T, Compare> :: clear()
+{
+   scratch.clear();
+   if (root)
+      scratch.push_back(root);
+   while (!scratch.empty())
+   {
+      Node * node = scratch.back();
+      scratch.pop_back();
+      if (node->next)
+         scratch.push_back(node->next);
+      if (node->child)
+         scratch.push_back(node->child);
+      destroy(node);
+   }
+   root = nullptr;
+   numElements = 0;
+}
+
+/************************************************
+ * PAIRING HEAP :: LINK
+ * The loser becomes the leftmost child of the winner
+ ***********************************************/
+template <class T, class Compare>
+typename pairing_heap <T, Compare> :: Node *
+pairing_heap <T, Compare> :: link(Node * lhs, Node * rhs)
+{
+   if (compare(lhs->data, rhs->data))
+      std::swap(lhs, rhs);
+
+   rhs->prev = lhs;
+   rhs->next = lhs->child;
+   if (lhs->child)
+      lhs->child->prev = rhs;
+   lhs->child = rhs;
+   return lhs;
+}
+
+/************************************************
+ * PAIRING HEAP :: COMBINE
+ * Link the siblings in pairs from left to right, then
+ * link the pairs from right to left
+ ***********************************************/
+template <class T, class Compare>
+typename pairing_heap <T, Compare> :: Node *
+pairing_heap <T, Compare> :: combine(Node * first)
+{
+   if (!first)
+      return nullptr;
+
+   scratch.clear();
+   for (Node * node = first; node; )
+   {
+      Node * next = node->next;
+      node->prev = node->next = nullptr;
+      scratch.push_back(node);
+      node = next;
+   }
+
+   // first pass: left to right in pairs
+   size_t numPairs = 0;
+   for (size_t i = 0; i + 1 < scratch.size(); i += 2)
+      scratch[numPairs++] = link(scratch[i], scratch[i + 1]);
+   if (scratch.size() % 2)
+      scratch[numPairs++] = scratch[scratch.size() - 1];
+
+   // second pass: right to left
+   Node * result = scratch[numPairs - 1];
+   for (size_t i = numPairs - 1; i > 0; i--)
+      result = link(scratch[i - 1], result);
+   return result;
+}
+
+/************************************************
+ * PAIRING HEAP :: DESTROY
+ * Run the destructor and give the memory to the pool
+ ***********************************************/
+template <class T, class Compare>
+void pairing_heap <T, Compare> :: destroy(Node * node)
+{
+   node->~Node();
+   pool.deallocate(node);
+}
+
+};
@@ -0,0 +1,188 @@
+/***********************************************************************
+ * Header:
+ *    PEEKABLE PRIORITY QUEUE
+ * Summary:
+ *    A priority_queue behind a mutex whose top is also published
+ *    under a sequence lock, so readers can look at it without ever
+ *    taking the lock or holding up the writers
+ *
+ *    This will contain the class definition of:
+ *        peekable_priority_queue : A locked heap with a lock-free peek
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <atomic>        // for std::atomic, std::atomic_thread_fence
+#include <mutex>         // for std::mutex
+#include <thread>        // for std::this_thread
+#include <cstring>       // for std::memcpy
+#include <cstdint>       // for uint64_t
+#include <type_traits>   // for std::is_trivially_copyable
+#include <functional>    // for std::less
+#include "compare_holder.h"
+#include "priority_queue.h"
+
+class TestPeekablePQueue;    // forward declaration for unit test class
+
+namespace custom
+{
+
+/*************************************************
+ * PEEKABLE PRIORITY QUEUE
+ * Writers take the mutex as usual. Whenever the top
+ * may have changed, the writer copies it into a row of
+ * atomic words between two bumps of a sequence number:
+ * odd while the copy is being written, even once it is
+ * done. A reader copies the words out and keeps the
+ * copy only if the sequence was the same even number
+ * before and after; otherwise a writer got in the way
+ * and it tries again. The reader never writes anything
+ * shared, so any number of them cost the writers
+ * nothing. T has to be trivially copyable, since it is
+ * moved about as raw words.
+ *************************************************/
+template<class T, class Compare = std::less<T>, size_t Arity = 2>
+class peekable_priority_queue : private compare_holder<Compare>
+{
+   static_assert(std::is_trivially_copyable<T>::value,
+                 "the published top is copied word by word");
+
+   friend class ::TestPeekablePQueue; // give the unit test class access to the privates
+
+public:
+
+   //
+   // construct
+   //
+
+   explicit peekable_priority_queue(const Compare & compare = Compare()) :
+      compare_holder<Compare>(compare), heap(compare), numElements(0), sequence(0), hasTop(0)
+   {
+      for (size_t i = 0; i < NUM_WORDS; i++)
+         words[i].store(0, std::memory_order_relaxed);
+   }
+   peekable_priority_queue(const peekable_priority_queue & rhs) = delete;
+   peekable_priority_queue & operator = (const peekable_priority_queue & rhs) = delete;
+
+   //
+   // Writers: take the lock
+   //
+   void push(const T & t);
+   bool try_pop(T & t);    // false when the queue was empty
+
+   //
+   // Readers: never take the lock
+   //
+   bool   peek(T & t) const;   // copy of the top; false when the queue was empty
+   size_t size()  const { return numElements.load(); }
+   bool   empty() const { return size() == 0; }
+
+private:
+   enum { NUM_WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t) };
+
+   void publish();         // copy the heap top out for the readers; hold the lock
+
+   // does lhs belong below rhs in the heap?
+   bool compare(const T & lhs, const T & rhs) const
+   {
+      return this->comparator()(lhs, rhs);
+   }
+
+   std::mutex                                lock;
+   custom::priority_queue<T, Compare, Arity> heap;
+   std::atomic<size_t>                       numElements;
+
+   // the seqlock, on cache lines of its own so pushes below the top leave readers alone
+   alignas(64) std::atomic<uint64_t>         sequence;     // odd while a writer is copying
+   std::atomic<uint64_t>                     hasTop;
+   std::atomic<uint64_t>                     words[NUM_WORDS];
+};
+
+/************************************************
+ * PEEKABLE PRIORITY QUEUE :: PUSH
+ * Only a push that lands on top needs publishing
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+void peekable_priority_queue <T, Compare, Arity> :: push(const T & t)
+{
+   std::lock_guard<std::mutex> guard(lock);
+   bool isTop = heap.empty() || !compare(t, heap.top());
+   heap.push(t);
+   numElements.store(heap.size());
+   if (isTop)
+      publish();
+}
+
+/************************************************
+ * PEEKABLE PRIORITY QUEUE :: TRY POP
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+bool peekable_priority_queue <T, Compare, Arity> :: try_pop(T & t)
+{
+   std::lock_guard<std::mutex> guard(lock);
+   if (heap.empty())
+      return false;
+
+   t = heap.top();
+   heap.pop();
+   numElements.store(heap.size());
+   publish();
+   return true;
+}
+
+/************************************************
+ * PEEKABLE PRIORITY QUEUE :: PUBLISH
+ * The release fence keeps the word stores after the
+ * odd sequence; the release store keeps them before
+ * the even one. Only one writer runs at a time.
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+void peekable_priority_queue <T, Compare, Arity> :: publish()
+{
+   uint64_t buffer[NUM_WORDS] = {};
+   if (!heap.empty())
+      std::memcpy(buffer, &heap.top(), sizeof(T));
+
+   uint64_t seq = sequence.load(std::memory_order_relaxed);
+   sequence.store(seq + 1, std::memory_order_relaxed);
+   std::atomic_thread_fence(std::memory_order_release);
+   hasTop.store(heap.empty() ? 0 : 1, std::memory_order_relaxed);
+   for (size_t i = 0; i < NUM_WORDS; i++)
+      words[i].store(buffer[i], std::memory_order_relaxed);
+   sequence.store(seq + 2, std::memory_order_release);
+}
+
+/************************************************
+ * PEEKABLE PRIORITY QUEUE :: PEEK
+ * The acquire load keeps the word loads after the
+ * first sequence read; the acquire fence keeps them
+ * before the second
+ ***********************************************/
+template <class T, class Compare, size_t Arity>
+bool peekable_priority_queue <T, Compare, Arity> :: peek(T & t) const
+{
+   uint64_t buffer[NUM_WORDS];
+   for (;;)
+   {
+      uint64_t before = sequence.load(std::memory_order_acquire);
+      if (before & 1)
+      {
+         std::this_thread::yield();
+         continue;
+      }
+      uint64_t present = hasTop.load(std::memory_order_relaxed);
+      for (size_t i = 0; i < NUM_WORDS; i++)
+         buffer[i] = words[i].load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence.load(std::memory_order_relaxed) != before)
+         continue;
+
+      if (!present)
+         return false;
+      std::memcpy(&t, buffer, sizeof(T));
+      return true;
+   }
+}
+
+};
@@ -0,0 +1,423 @@
+/***********************************************************************
+ * Header:
+ *    PRIORITY EXECUTOR
+ * Summary:
+ *    A pool of worker threads that run tasks highest priority first.
+ *    Every worker owns a priority_queue of tasks; an idle worker
+ *    steals the better half of another worker's queue.
+ *
+ *    This will contain the class definition of:
+ *        priority_executor      : A work-stealing priority scheduler
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <atomic>               // for std::atomic
+#include <mutex>                // for std::mutex
+#include <condition_variable>   // for std::condition_variable
+#include <thread>               // for std::thread
+#include <chrono>               // for std::chrono::steady_clock
+#include <functional>           // for std::function
+#include <cstdint>              // for uint64_t
+#include "priority_queue.h"
+#include "vector.h"
+
+class TestPriorityExecutor;    // forward declaration for unit test class
+
+namespace custom
+{
+
+/*************************************************
+ * PRIORITY EXECUTOR
+ * submit() from a worker goes on that worker's own
+ * queue, so a task's children stay hot in its cache;
+ * from outside it goes round-robin. A worker runs its
+ * own best task. With nothing of its own it picks a
+ * victim, by the steal policy, and takes the better
+ * half of the victim's tasks in one lock. With nothing
+ * to steal either it sleeps until a submit wakes it.
+ * Equal priorities run in the order they were submitted.
+ * Tasks must not throw.
+ *************************************************/
+class priority_executor
+{
+   friend class ::TestPriorityExecutor; // give the unit test class access to the privates
+
+public:
+   enum steal_policy { STEAL_RANDOM,     // any worker with tasks, starting at a random one
+                       STEAL_RICHEST };  // the worker with the most tasks
+
+   struct worker_stats
+   {
+      uint64_t numLocalPops;     // tasks run from the worker's own queue
+      uint64_t numSteals;        // successful steals
+      uint64_t numStolen;        // tasks taken by those steals
+      double   idleMilliseconds; // time spent asleep waiting for work
+   };
+
+   //
+   // construct
+   //
+
+   explicit priority_executor(size_t numWorkers = std::thread::hardware_concurrency(),
+                              steal_policy policy = STEAL_RANDOM);
+   priority_executor(const priority_executor & rhs) = delete;
+   priority_executor & operator = (const priority_executor & rhs) = delete;
+  ~priority_executor() { shutdown(); }
+
+   //
+   // Work
+   //
+   void submit(int priority, std::function<void()> work);
+   void wait();        // until every task submitted so far, and its children, has run
+   void shutdown();    // run what is queued, then stop the workers
+
+   //
+   // Status
+   //
+   size_t num_workers() const { return numWorkers; }
+   custom::vector<worker_stats> stats() const;
+
+private:
+   enum { IDLE_MILLISECONDS = 10 };   // a sleeping worker looks around this often anyway
+
+   struct Task
+   {
+      int                   priority;
+      uint64_t              sequence;     // older tasks first among equals
+      std::function<void()> work;
+   };
+
+   // does lhs belong below rhs in the heap?
+   struct TaskCompare
+   {
+      bool operator()(const Task & lhs, const Task & rhs) const
+      {
+         return lhs.priority < rhs.priority ||
+               (lhs.priority == rhs.priority && lhs.sequence > rhs.sequence);
+      }
+   };
+
+   // one per thread, on its own cache line
+   struct alignas(64) Worker
+   {
+      Worker() : numTasks(0), numLocalPops(0), numSteals(0), numStolen(0), idleNanoseconds(0) {}
+      std::mutex                                   lock;
+      custom::priority_queue<Task, TaskCompare, 4> tasks;
+      std::atomic<size_t>                          numTasks;   // read without the lock
+      std::atomic<uint64_t>                        numLocalPops;
+      std::atomic<uint64_t>                        numSteals;
+      std::atomic<uint64_t>                        numStolen;
+      std::atomic<uint64_t>                        idleNanoseconds;
+   };
+
+   void   run(size_t index);                 // the loop of one worker thread
+   bool   popLocal(Worker & worker, Task & task);
+   bool   steal(size_t index, Task & task);  // refill worker index from a victim
+   size_t pickVictim(size_t index, uint64_t & random) const;
+   void   sleep(Worker & worker);
+   void   finished();                        // one task has run
+
+   static size_t & currentWorker();          // the index of the calling worker, or -1
+   static const priority_executor * & currentExecutor();
+
+   size_t                     numWorkers;
+   steal_policy               policy;
+   Worker *                   workers;
+   custom::vector<std::thread *> threads;
+
+   std::atomic<uint64_t>      sequence;      // stamps every submitted task
+   std::atomic<size_t>        nextWorker;    // round-robin for outside submits
+   std::atomic<size_t>        numQueued;     // in some worker's queue
+   std::atomic<size_t>        numPending;    // submitted but not finished
+   std::atomic<size_t>        numIdle;       // workers asleep or about to be
+   std::atomic<bool>          stopping;
+
+   std::mutex                 idleLock;
+   std::condition_variable    workAvailable;
+   std::mutex                 doneLock;
+   std::condition_variable    allDone;
+};
+
+/************************************************
+ * PRIORITY EXECUTOR :: CONSTRUCTOR
+ ***********************************************/
+inline priority_executor::priority_executor(size_t numWorkers, steal_policy policy) :
+   numWorkers(numWorkers ? numWorkers : 1), policy(policy), workers(nullptr),
+   sequence(0), nextWorker(0), numQueued(0), numPending(0), numIdle(0), stopping(false)
+{
+   workers = new Worker[this->numWorkers];
+   for (size_t i = 0; i < this->numWorkers; i++)
+      threads.push_back(new std::thread(&priority_executor::run, this, i));
+}
+
+/************************************************
+ * PRIORITY EXECUTOR :: SUBMIT
+ * Onto the calling worker's queue, or round-robin,
+ * then wake one sleeper if there is one
+ ***********************************************/
+inline void priority_executor::submit(int priority, std::function<void()> work)
+{
+   assert(workers != nullptr);   // not after shutdown
+   size_t index = currentExecutor() == this ? currentWorker()
+                                            : nextWorker++ % numWorkers;
+   Worker & worker = workers[index];
+
+   Task task;
+   task.priority = priority;
+   task.sequence = sequence++;
+   task.work = std::move(work);
+
+   // count the task before anyone can take it, so a pop or a steal never
+   // takes numQueued below zero
+   numPending++;
+   numQueued++;
+   {
+      std::lock_guard<std::mutex> guard(worker.lock);
+      worker.tasks.push(std::move(task));
+      worker.numTasks.store(worker.tasks.size());
+   }
+
+   // a sleeper counts itself idle before it looks at numQueued, and we bump
+   // numQueued before we look at numIdle, so one of us always sees the other
+   if (numIdle.load() > 0)
+   {
+      std::lock_guard<std::mutex> guard(idleLock);
+      workAvailable.notify_one();
+   }
+}
+
+/************************************************
+ * PRIORITY EXECUTOR :: WAIT
+ ***********************************************/
+inline void priority_executor::wait()
+{
+   std::unique_lock<std::mutex> guard(doneLock);
+   while (numPending.load() > 0)
+      allDone.wait(guard);
+}
+
+/************************************************
+ * PRIORITY EXECUTOR :: SHUTDOWN
+ * Let the workers drain their queues, then join them
+ ***********************************************/
+inline void priority_executor::shutdown()
+{
+   if (threads.empty())
+      return;
+
+   wait();
+   {
+      std::lock_guard<std::mutex> guard(idleLock);
+      stopping.store(true);
+      workAvailable.notify_all();
+   }
+   for (size_t i = 0; i < threads.size(); i++)
+   {
+      threads[i]->join();
+      delete threads[i];
+   }
+   threads.resize(0);
+   delete [] workers;
+   workers = nullptr;
+}
+
+/************************************************
+ * PRIORITY EXECUTOR :: STATS
+ ***********************************************/
+inline custom::vector<priority_executor::worker_stats> priority_executor::stats() const
+{
+   custom::vector<worker_stats> result;
+   for (size_t i = 0; workers && i < numWorkers; i++)
+   {
+      worker_stats s;
+      s.numLocalPops     = workers[i].numLocalPops.load();
+      s.numSteals        = workers[i].numSteals.load();
+      s.numStolen        = workers[i].numStolen.load();
+      s.idleMilliseconds = workers[i].idleNanoseconds.load() / 1e6;
+      result.push_back(s);
+   }
+   return result;
+}
+
+/************************************************
+ * PRIORITY EXECUTOR :: RUN
+ * Own queue, then steal, then sleep
+ ***********************************************/
+inline void priority_executor::run(size_t index)
+{
+   currentWorker() = index;
+   currentExecutor() = this;
+   Worker & worker = workers[index];
+
+   Task task;
+   while (true)
+   {
+      if (popLocal(worker, task))
+         worker.numLocalPops++;
+      else if (!steal(index, task))
+      {
+         if (stopping.load() && numQueued.load() == 0)
+            break;
+         sleep(worker);
+         continue;
+      }
+
+      task.work();
+      task.work = nullptr;   // let go of whatever the task captured
+      finished();
+   }
+
+   currentExecutor() = nullptr;
+}
+
+/************************************************
+ * PRIORITY EXECUTOR :: POP LOCAL
+ ***********************************************/
+inline bool priority_executor::popLocal(Worker & worker, Task & task)
+{
+   if (worker.numTasks.load() == 0)
+      return false;
+
+   std::lock_guard<std::mutex> guard(worker.lock);
+   if (worker.tasks.empty())
+      return false;
+   task = std::move(const_cast<Task &>(worker.tasks.top()));
+   worker.tasks.pop();
+   worker.numTasks.store(worker.tasks.size());
+   numQueued--;
+   return true;
+}
+
+/************************************************
+ * PRIORITY EXECUTOR :: STEAL
+ * Take the better half of a victim's tasks, rounding
+ * up, in one lock. Run the best of them now and queue
+ * the rest locally.
+ ***********************************************/
+inline bool priority_executor::steal(size_t index, Task & task)
+{
+   thread_local uint64_t random = 0x9E3779B97F4A7C15ull * (index + 1);
+   custom::vector<Task> stolen;
+
+   for (size_t attempt = 0; attempt < numWorkers && stolen.empty(); attempt++)
+   {
+      size_t indexVictim = pickVictim(index, random);
+      if (indexVictim == index)
+         return false;
+
+      Worker & victim = workers[indexVictim];
+      std::lock_guard<std::mutex> guard(victim.lock);
+      size_t numSteal = (victim.tasks.size() + 1) / 2;
+      for (size_t i = 0; i < numSteal; i++)
+      {
+         stolen.push_back(std::move(const_cast<Task &>(victim.tasks.top())));
+         victim.tasks.pop();
+      }
+      victim.numTasks.store(victim.tasks.size());
+   }
+   if (stolen.empty())
+      return false;
+
+   Worker & worker = workers[index];
+   worker.numSteals++;
+   worker.numStolen += stolen.size();
+
+   // stolen best first: run the first, keep the rest
+   task = std::move(stolen[0]);
+   numQueued--;
+   if (stolen.size() > 1)
+   {
+      std::lock_guard<std::mutex> guard(worker.lock);
+      for (size_t i = 1; i < stolen.size(); i++)
+         worker.tasks.push(std::move(stolen[i]));
+      worker.numTasks.store(worker.tasks.size());
+   }
+   return true;
+}
+
+/************************************************
+ * PRIORITY EXECUTOR :: PICK VICTIM
+ * Return index itself when nobody has anything
+ ***********************************************/
+inline size_t priority_executor::pickVictim(size_t index, uint64_t & random) const
+{
+   if (policy == STEAL_RICHEST)
+   {
+      size_t indexRichest = index;
+      size_t numRichest = 0;
+      for (size_t i = 0; i < numWorkers; i++)
+      {
+         size_t num = workers[i].numTasks.load();
+         if (i != index && num > numRichest)
+         {
+            indexRichest = i;
+            numRichest = num;
+         }
+      }
+      return indexRichest;
+   }
+
+   random ^= random << 13;
+   random ^= random >> 7;
+   random ^= random << 17;
+   size_t start = size_t(random % numWorkers);
+   for (size_t i = 0; i < numWorkers; i++)
+   {
+      size_t indexVictim = (start + i) % numWorkers;
+      if (indexVictim != index && workers[indexVictim].numTasks.load() > 0)
+         return indexVictim;
+   }
+   return index;
+}
+
+/************************************************
+ * PRIORITY EXECUTOR :: SLEEP
+ * Count ourselves idle first, then look once more
+ ***********************************************/
+inline void priority_executor::sleep(Worker & worker)
+{
+   auto begin = std::chrono::steady_clock::now();
+   {
+      std::unique_lock<std::mutex> guard(idleLock);
+      numIdle++;
+      if (numQueued.load() == 0 && !stopping.load())
+         workAvailable.wait_for(guard, std::chrono::milliseconds(IDLE_MILLISECONDS));
+      numIdle--;
+   }
+   auto end = std::chrono::steady_clock::now();
+   worker.idleNanoseconds +=
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+}
+
+/************************************************
+ * PRIORITY EXECUTOR :: FINISHED
+ * The last task to finish wakes whoever is waiting
+ ***********************************************/
+inline void priority_executor::finished()
+{
+   if (--numPending == 0)
+   {
+      std::lock_guard<std::mutex> guard(doneLock);
+      allDone.notify_all();
+   }
+}
+
+/************************************************
+ * PRIORITY EXECUTOR :: CURRENT WORKER
+ * Which executor and worker the calling thread is
+ ***********************************************/
+inline size_t & priority_executor::currentWorker()
+{
+   thread_local size_t index = size_t(-1);
+   return index;
+}
+
+inline const priority_executor * & priority_executor::currentExecutor()
+{
+   thread_local const priority_executor * executor = nullptr;
+   return executor;
+}
+
+};
@@ -19,6 +19,13 @@
 #pragma once
 
 #include <cassert>
+#include <functional>   // for std::less
+#include <algorithm>    // for std::nth_element, std::sort, std::inplace_merge
+#include <thread>       // for std::thread
+#include <iterator>     // for std::make_move_iterator
+#include <vector>       // for std::vector
+#include "compare_holder.h"
+#include "heap_hole.h"
 #include "vector.h"
 
 class TestPQueue;    // forward declaration for unit test class
@@ -28,18 +35,59 @@ namespace custom
 
 /*************************************************
  * P QUEUE
- * Create a priority queue.
+ * Create a priority queue. Compare(a, b) returns TRUE
+ * when a belongs below b, so std::less gives a max-heap
+ * and std::greater gives a min-heap. A stateless
+ * comparator takes no space and inlines into every
+ * percolate; a function pointer or a final class works
+ * too, at the cost of a member (see compare_holder).
+ * Arity is the number of children of each node. A 4-ary
+ * or 8-ary heap is half or a third as deep as a binary
+ * one and all the children of a node share a cache line.
  *************************************************/
-template<class T>
-class priority_queue
+template<class T, class Compare = std::less<T>, size_t Arity = 2>
+class priority_queue : private compare_holder<Compare>
 {
+   static_assert(Arity >= 2, "a heap needs at least two children per node");
+
    friend class ::TestPQueue; // give the unit test class access to the privates
-   template <class TT>
-   friend void swap(priority_queue<TT>& lhs, priority_queue<TT>& rhs);
+   template <class TT, class CC, size_t AA>
+   friend void swap(priority_queue<TT, CC, AA>& lhs, priority_queue<TT, CC, AA>& rhs);
 
 private:
     void heapify();                            // convert the container in to a heap
+    void heapifyParallel(size_t numThreads);   // the same, with the subtrees split among threads
+    void heapifySubtrees(size_t indexFirst, size_t indexLast); // the subtrees under these siblings
+    void heapifyAppended(size_t sizeOld, size_t numThreads);   // fix the heap after appending
+    void sortBestLast(size_t indexFirst, size_t numThreads);   // sort container from indexFirst up
     bool percolateDown(size_t indexHeap);      // fix heap from index down. This is a heap index!
+    bool percolateUp(size_t indexHeap);        // fix heap from index up. Also a heap index
+
+    // move the hole at indexHole until value fits there, returning the final heap index
+    size_t percolateHoleDown(size_t indexHole, const T & value);
+    size_t percolateHoleUp(size_t indexHole, const T & value);
+    size_t indexBiggerChild(size_t indexHeap) const;
+    T exchangeTop(T && t);                     // put t on top, sift it down, return the old top
+
+    // heap index of the first child and the parent of a heap index
+    static size_t indexChild(size_t indexHeap)  { return heap_hole<Arity>::indexChild(indexHeap);  }
+    static size_t indexParent(size_t indexHeap) { return heap_hole<Arity>::indexParent(indexHeap); }
+
+    // batches smaller than this are not worth a thread; an appended
+    // batch at least 1/HEAPIFY_RATIO of the heap is cheaper to rebuild
+    enum { PARALLEL_GRAIN = 1 << 15,
+           HEAPIFY_RATIO  = 4 };
+    static size_t numThreadsFor(size_t numElements, size_t numThreads);
+
+    // run work(0) .. work(numThreads - 1), all but the first on new threads
+    template <class Work>
+    static void runParallel(size_t numThreads, Work work);
+
+    // does lhs belong below rhs in the heap?
+    bool compare(const T & lhs, const T & rhs) const
+    {
+       return this->comparator()(lhs, rhs);
+    }
 
 	custom::vector<T> container;               //using our custom vector from previous assignment
 
@@ -52,34 +100,35 @@ public:
    // default constructor
    priority_queue() 
    {
+   }
+
+   // constructor with a specific comparator
+   explicit priority_queue(const Compare & compare) : compare_holder<Compare>(compare)
+   {
    }
 
     // copy constructor
-   priority_queue(const priority_queue &  rhs)  
+   priority_queue(const priority_queue &  rhs) : compare_holder<Compare>(rhs)
    { 
        this->container = rhs.container;
    }
 
     // move constructor
-   priority_queue(priority_queue && rhs)  
+   priority_queue(priority_queue && rhs) : compare_holder<Compare>(rhs)
    { 
        this->container = std::move(rhs.container);
    }
 
-    // initializer list constructor using iterators
+    // range constructor: copies the elements, or moves them when given
+    // std::make_move_iterator, then builds the heap in O(n)
    template <class Iterator>
-   priority_queue(Iterator first, Iterator last) 
+   priority_queue(Iterator first, Iterator last, const Compare & compare = Compare()) : compare_holder<Compare>(compare)
    {
-       size_t newCapacity = last - first;
-       container.reserve(newCapacity); // allocate as much as needed 
-
-       // Add each new item 
-       for (auto it = first; it != last; it++)
-           container.push_back(*it);
+       assign(first, last);
    }
 
     // initializer list constructor using our custom vector
-   priority_queue (custom::vector<T> && rhs) 
+   priority_queue (custom::vector<T> && rhs, const Compare & compare = Compare()) : compare_holder<Compare>(compare)
    {
         // Move the vector into the container
         container = std::move(rhs);
@@ -87,10 +136,11 @@ public:
         heapify();
    }
 
-    // initializer list constructor using our custom vector
-   priority_queue (custom::vector<T>& rhs) // 
+    // copy our custom vector, leaving it alone, and build the heap from the copy
+   priority_queue (const custom::vector<T>& rhs, const Compare & compare = Compare()) :
+      compare_holder<Compare>(compare), container(rhs)
    {
-       this->container = std::move(rhs);
+       heapify();
    }
 
     // destructor thats here but does nothing. 
@@ -102,16 +152,39 @@ public:
    //
    const T & top() const; // Get the maximum item the top item.
 
+   //
+   // Assign
+   //
+   template <class Iterator>
+   void  assign(Iterator first, Iterator last); // replace the contents, build in O(n)
+
    //
    // Insert
    //
    void  push(const T& t); // Add a new element to the heap
    void  push(T&& t);      // also add a new element to the heap
+   template <class ... Args>
+   void  emplace(Args && ... args); // build the new element in place
+   template <class Iterator>
+   void  append_and_heapify(Iterator first, Iterator last); // copy a batch in, fix the heap once
+   template <class Iterator>
+   void  push_batch(Iterator first, Iterator last, size_t numThreads = 0); // threads when big
+   void  merge(priority_queue && rhs); // take everything in rhs, leaving it empty
 
    //
    // Remove
    //
-   void  pop(); // Remove the top item from the heap
+   void  pop();           // Remove the top item from the heap
+   void  pop_bottom_up(); // Same, with about half the comparisons
+   size_t pop_batch(size_t k, custom::vector<T> & out, size_t numThreads = 0); // best k, best first
+
+   //
+   // Exchange: one sift where pop() and push() take two
+   //
+   T     replace_top(T&& t);          // pop then push: return the old top
+   T     replace_top(const T& t) { return replace_top(T(t)); }
+   T     push_pop(T&& t);             // push then pop: return the best of the heap and t
+   T     push_pop(const T& t)    { return push_pop(T(t)); }
 
    //
    // Status
@@ -132,8 +205,8 @@ public:
  * P QUEUE :: TOP
  * Get the maximum item from the heap: the top item.
  ***********************************************/
-template <class T>
-const T & priority_queue <T> :: top() const
+template <class T, class Compare, size_t Arity>
+const T & priority_queue <T, Compare, Arity> :: top() const
 {
     if (empty()) // Check if the queue is empty
     {
@@ -145,17 +218,86 @@ const T & priority_queue <T> :: top() const
     return container.front(); // Return the front (or top) element of the container
 }
 
+/**********************************************
+ * P QUEUE :: MERGE
+ * Move every element of rhs in here. The larger of the
+ * two containers is kept so only the smaller one is
+ * moved, and then append_and_heapify picks between
+ * sifting those up and rebuilding the whole heap by
+ * how big they are next to it. rhs is assumed to be
+ * ordered by a comparator like ours.
+ **********************************************/
+template <class T, class Compare, size_t Arity>
+void priority_queue <T, Compare, Arity> :: merge(priority_queue && rhs)
+{
+    if (this == &rhs || rhs.empty())
+        return;
+    if (rhs.size() > size())
+        container.swap(rhs.container);
+    if (rhs.empty())
+        return;
+
+    // grow once rather than doubling along the way, but geometrically
+    // still, so a run of merges into one queue does not copy it each time
+    size_t sizeNew = size() + rhs.size();
+    if (sizeNew > container.capacity())
+        container.reserve(sizeNew > container.capacity() * 2 ? sizeNew : container.capacity() * 2);
+    T * begin = &rhs.container[0];
+    append_and_heapify(std::make_move_iterator(begin), std::make_move_iterator(begin + rhs.size()));
+    rhs.container.clear();
+}
+
 /**********************************************
  * P QUEUE :: POP
  * Delete the top item from the heap.
  **********************************************/
-template <class T>
-void priority_queue <T> :: pop()
+template <class T, class Compare, size_t Arity>
+void priority_queue <T, Compare, Arity> :: pop()
+{
+    if (empty()) // Check if the queue is empty
+        return;
+
+    // take the back element out and let the top slot become a hole
+    T value(std::move(container.back()));
+    container.pop_back();
+
+    // walk the hole down to where the old back element belongs
+    if (!empty())
+        container[percolateHoleDown(1, value) - 1] = std::move(value);
+}
+
+/**********************************************
+ * P QUEUE :: POP BOTTOM UP
+ * Delete the top item from the heap. Walk the hole
+ * all the way to a leaf along the larger children
+ * without comparing against the back element, then
+ * percolate the back element up from there. The back
+ * element nearly always belongs near the bottom, so this
+ * costs about one comparison per level rather than two.
+ * Best when the comparator is expensive.
+ **********************************************/
+template <class T, class Compare, size_t Arity>
+void priority_queue <T, Compare, Arity> :: pop_bottom_up()
 {
-    if (!empty()) // Check if the queue is empty
-        std::swap(container.front(), container.back()); // if not empty then we need to swap the front and back elements to remove the top element
-    container.pop_back(); // now we can pop/remove the back element
-    percolateDown(1); // percolate down to fix the heap
+    if (empty())
+        return;
+
+    T value(std::move(container.back()));
+    container.pop_back();
+    if (empty())
+        return;
+
+    // walk the hole down to a leaf
+    size_t indexHole = 1;
+    size_t indexBigger;
+    while ((indexBigger = indexBiggerChild(indexHole)))
+    {
+        container[indexHole - 1] = std::move(container[indexBigger - 1]);
+        indexHole = indexBigger;
+    }
+
+    // and bring the back element back up to where it belongs
+    container[percolateHoleUp(indexHole, value) - 1] = std::move(value);
 }
 
 /*****************************************
@@ -164,31 +306,169 @@ void priority_queue <T> :: pop()
  ****************************************/
 
 // push takes a const reference and adds it to the container, then percolates it to the correct positions and fixes the heap
-template <class T>
-void priority_queue <T> :: push(const T & t)
+template <class T, class Compare, size_t Arity>
+void priority_queue <T, Compare, Arity> :: push(const T & t)
 {
 	container.push_back(t); // add item 
-
-    // fix the heap 
-    // similar to percolateDown() 
-	size_t i = container.size(); 
-	while (i > 1 && container[i - 1] > container[i / 2 - 1])
-	{
-		std::swap(container[i - 1], container[i / 2 - 1]);
-		i /= 2;
-	}
+	percolateUp(size());    // fix the heap 
 }
 
 // same as above but with rvalue reference
-template <class T>
-void priority_queue <T> :: push(T && t)
+template <class T, class Compare, size_t Arity>
+void priority_queue <T, Compare, Arity> :: push(T && t)
 {
     container.push_back(std::move(t)); // add item 
+    percolateUp(size());               // fix the heap 
+}
+
+/*****************************************
+ * P QUEUE :: EMPLACE
+ * Construct the new element in the container's storage
+ * from args, then sift it up like push
+ ****************************************/
+template <class T, class Compare, size_t Arity>
+template <class ... Args>
+void priority_queue <T, Compare, Arity> :: emplace(Args && ... args)
+{
+    container.emplace_back(std::forward<Args>(args)...);
+    percolateUp(size());
+}
+
+/*****************************************
+ * P QUEUE :: ASSIGN
+ * Throw away what is there, take the range, and build
+ * the heap once: O(n) against O(n log n) for n pushes.
+ * Pass std::make_move_iterator to move rather than copy.
+ ****************************************/
+template <class T, class Compare, size_t Arity>
+template <class Iterator>
+void priority_queue <T, Compare, Arity> :: assign(Iterator first, Iterator last)
+{
+    container.clear();
+    container.reserve(last - first);   // allocate as much as needed
+    for (Iterator it = first; it != last; ++it)
+        container.push_back(*it);
+    heapify();
+}
+
+/*****************************************
+ * P QUEUE :: APPEND AND HEAPIFY
+ * Copy a batch of elements onto the end of the container
+ * and fix the heap once, sifting the batch up or
+ * rebuilding as push_batch does, on this thread. Pass
+ * std::make_move_iterator to move rather than copy.
+ ****************************************/
+template <class T, class Compare, size_t Arity>
+template <class Iterator>
+void priority_queue <T, Compare, Arity> :: append_and_heapify(Iterator first, Iterator last)
+{
+    size_t sizeOld = size();
+    for (Iterator it = first; it != last; ++it)
+        container.push_back(*it);
+    heapifyAppended(sizeOld, 1);
+}
+
+/*****************************************
+ * P QUEUE :: PUSH BATCH
+ * Copy a batch onto the end of the container and fix
+ * the heap once, splitting a rebuild among up to
+ * numThreads threads (0 means one per core) when it is
+ * big enough.
+ ****************************************/
+template <class T, class Compare, size_t Arity>
+template <class Iterator>
+void priority_queue <T, Compare, Arity> :: push_batch(Iterator first, Iterator last, size_t numThreads)
+{
+    size_t sizeOld = size();
+    for (Iterator it = first; it != last; ++it)
+        container.push_back(*it);
+    heapifyAppended(sizeOld, numThreads);
+}
+
+/**********************************************
+ * P QUEUE :: REPLACE TOP
+ * The same as taking top(), pop(), and push(t), but t
+ * goes straight into the hole the top leaves and is
+ * sifted down once: no percolate up, and no moving
+ * the back element around. Throws when empty, like top().
+ **********************************************/
+template <class T, class Compare, size_t Arity>
+T priority_queue <T, Compare, Arity> :: replace_top(T && t)
+{
+    if (empty())
+        throw std::out_of_range("std:out_of_range");
+    return exchangeTop(std::move(t));
+}
+
+/**********************************************
+ * P QUEUE :: PUSH POP
+ * The same as push(t), then taking top() and pop().
+ * When t is at least as good as the top it would come
+ * straight back out, so hand it back having touched
+ * nothing. Otherwise it is replace_top.
+ **********************************************/
+template <class T, class Compare, size_t Arity>
+T priority_queue <T, Compare, Arity> :: push_pop(T && t)
+{
+    if (empty() || !compare(t, container.front()))
+        return std::move(t);
+    return exchangeTop(std::move(t));
+}
 
-    // fix the heap 
-    size_t index = container.size() / 2;
-    while (index && percolateDown(index)) // here we can just call percolateDown() 
-        index /= 2;
+/**********************************************
+ * P QUEUE :: EXCHANGE TOP
+ **********************************************/
+template <class T, class Compare, size_t Arity>
+T priority_queue <T, Compare, Arity> :: exchangeTop(T && t)
+{
+    T top(std::move(container.front()));
+    container[percolateHoleDown(1, t) - 1] = std::move(t);
+    return top;
+}
+
+/**********************************************
+ * P QUEUE :: POP BATCH
+ * Append the best k elements to out, best first, and
+ * return how many that was. A few are popped one at a
+ * time. For many, partition the container once so the
+ * best k are at the end, sort just those, and rebuild
+ * the heap from the rest. That is O(n + k log k)
+ * against O(k log n); the sort and the rebuild are
+ * shared among threads.
+ **********************************************/
+template <class T, class Compare, size_t Arity>
+size_t priority_queue <T, Compare, Arity> :: pop_batch(size_t k, custom::vector<T> & out, size_t numThreads)
+{
+    if (k > size())
+        k = size();
+    if (k == 0)
+        return 0;
+    out.reserve(out.size() + k);
+
+    // about log n moves per pop against a few passes over the container
+    size_t depth = 1;
+    for (size_t n = size(); n > Arity; n /= Arity)
+        depth++;
+    if (k * depth < size() * 2)
+    {
+        for (size_t i = 0; i < k; i++)
+        {
+            out.push_back(std::move(container.front()));
+            pop();
+        }
+        return k;
+    }
+
+    T * begin = &container[0];
+    size_t indexSplit = size() - k;
+    std::nth_element(begin, begin + indexSplit, begin + size(),
+                     [this](const T & lhs, const T & rhs) { return compare(lhs, rhs); });
+    sortBestLast(indexSplit, numThreadsFor(k, numThreads));
+    for (size_t i = size(); i > indexSplit; i--)
+        out.push_back(std::move(container[i - 1]));
+    container.resize(indexSplit);
+    heapifyParallel(numThreadsFor(size(), numThreads));
+    return k;
 }
 
 /************************************************
@@ -198,39 +478,78 @@ void priority_queue <T> :: push(T && t)
  * Return TRUE if anything changed.
  ************************************************/
 
-// percolates down the heap (the heap is a binary tree where the parent is always greater than the children) 
-// we need to make sure the heap is in order so we percolate down the heap to fix it when needed
-template <class T>
-bool priority_queue <T> :: percolateDown(size_t indexHeap)
+// percolates down the heap (the heap is a tree where the parent is always greater than the children) 
+// rather than swapping at every level, the item is moved out once, the hole is walked
+// down by moving the larger child up, and the item is moved into the final hole
+template <class T, class Compare, size_t Arity>
+bool priority_queue <T, Compare, Arity> :: percolateDown(size_t indexHeap)
 {
-    size_t indexLeft = indexHeap * 2; // indexHeap is the current element 
-    size_t indexRight = indexLeft + 1;
-    size_t indexBigger; // we will find the largest element 
+    size_t indexBigger = indexBiggerChild(indexHeap);
 
-    if (indexLeft > size())
-        return false; // no change is needed 
+    // nothing to do if there are no children or the item is already bigger than them
+    if (!indexBigger || !compare(container[indexHeap - 1], container[indexBigger - 1]))
+        return false;
 
-    // Find the largest element, should be on top of the heap 
+    T value(std::move(container[indexHeap - 1]));
+    container[indexHeap - 1] = std::move(container[indexBigger - 1]);
+    container[percolateHoleDown(indexBigger, value) - 1] = std::move(value);
+    return true;
+}
 
-    if (indexRight <= size())
+/************************************************
+ * P QUEUE :: PERCOLATE UP
+ * The item at the passed index may be bigger than
+ * its parent. Return TRUE if anything changed.
+ ************************************************/
+template <class T, class Compare, size_t Arity>
+bool priority_queue <T, Compare, Arity> :: percolateUp(size_t indexHeap)
+{
+    size_t indexUp = indexParent(indexHeap);
 
-        // if left element is smaller, set right element to indexBigger. else left is indexBigger 
-        indexBigger = container[indexLeft - 1] < container[indexRight - 1] ?
-        indexRight : indexLeft;
+    // nothing to do at the top or if the parent is already bigger
+    if (!indexUp || !compare(container[indexUp - 1], container[indexHeap - 1]))
+        return false;
 
-    else // if right > size() 
-        indexBigger = indexLeft;
+    T value(std::move(container[indexHeap - 1]));
+    container[indexHeap - 1] = std::move(container[indexUp - 1]);
+    container[percolateHoleUp(indexUp, value) - 1] = std::move(value);
+    return true;
+}
 
-    if (container[indexHeap - 1] < container[indexBigger - 1]) // compare the current index with whichever we found was larger, above 
-    {
-        std::swap(container[indexHeap - 1], container[indexBigger - 1]); // swap if: current element is less than the larger element we found above. 
-        // Because the largest value has to be on top of the heap 
+/************************************************
+ * P QUEUE :: PERCOLATE HOLE DOWN and UP
+ * indexHole holds nothing of value. Move the elements
+ * in the way into it, one move per level, until value
+ * fits there (see heap_hole).
+ ************************************************/
+template <class T, class Compare, size_t Arity>
+size_t priority_queue <T, Compare, Arity> :: percolateHoleDown(size_t indexHole, const T & value)
+{
+    return heap_hole<Arity>::percolateDown(container, indexHole, value, this->comparator(),
+        [this](size_t indexTo, size_t indexFrom)
+        {
+            container[indexTo - 1] = std::move(container[indexFrom - 1]);
+        });
+}
 
-        percolateDown(indexBigger); // recursively call method to fix subtrees 
-        return true; // we did make a change by swapping 
-    }
+template <class T, class Compare, size_t Arity>
+size_t priority_queue <T, Compare, Arity> :: percolateHoleUp(size_t indexHole, const T & value)
+{
+    return heap_hole<Arity>::percolateUp(container, indexHole, value, this->comparator(),
+        [this](size_t indexTo, size_t indexFrom)
+        {
+            container[indexTo - 1] = std::move(container[indexFrom - 1]);
+        });
+}
 
-    return false; // no change was needed 
+/************************************************
+ * P QUEUE :: INDEX BIGGER CHILD
+ * Find the largest child of a node, or 0 if it is a leaf.
+ ************************************************/
+template <class T, class Compare, size_t Arity>
+size_t priority_queue <T, Compare, Arity> :: indexBiggerChild(size_t indexHeap) const
+{
+    return heap_hole<Arity>::indexBiggerChild(container, indexHeap, this->comparator());
 }
 
 /************************************************
@@ -240,24 +559,189 @@ bool priority_queue <T> :: percolateDown(size_t indexHeap)
 
 // heapify converts the container (the container is a vector) into a heap (a heap is like a BST but the parent is always greater than the children)
 // it does this by percolating down the heap and while it is moving through the heap adjusting the elements so that lower elements are moved down and higher elements are moved up
-template <class T>
-void priority_queue <T> ::heapify()
+template <class T, class Compare, size_t Arity>
+void priority_queue <T, Compare, Arity> ::heapify()
 {
-	for (size_t i = size() / 2; i > 0; i--)  
+	for (size_t i = indexParent(size()); i > 0; i--)  
 		percolateDown(i); // apply to all elements in the heap 
 }
 
+/************************************************
+ * P QUEUE :: HEAPIFY APPENDED
+ * Everything from sizeOld on was just appended. Sifting
+ * up costs about log n per new element and a rebuild
+ * about 2 per element of the whole heap, so sift a
+ * small batch up and rebuild once it is a quarter of
+ * the heap or more.
+ ************************************************/
+template <class T, class Compare, size_t Arity>
+void priority_queue <T, Compare, Arity> :: heapifyAppended(size_t sizeOld, size_t numThreads)
+{
+    size_t numNew = size() - sizeOld;
+    if (numNew > 1 && numNew * HEAPIFY_RATIO >= size())
+        heapifyParallel(numThreadsFor(size(), numThreads));
+    else
+        for (size_t i = sizeOld + 1; i <= size(); i++)
+            percolateUp(i);
+}
+
+/************************************************
+ * P QUEUE :: HEAPIFY PARALLEL
+ * The subtrees under one level of the heap do not
+ * overlap, so threads can heapify them side by side.
+ * Pick the first level with a few nodes per thread,
+ * give each thread a run of those nodes, and finish
+ * the few levels above them here.
+ ************************************************/
+template <class T, class Compare, size_t Arity>
+void priority_queue <T, Compare, Arity> :: heapifyParallel(size_t numThreads)
+{
+    if (numThreads < 2)
+    {
+        heapify();
+        return;
+    }
+
+    size_t indexLevel = 1;
+    size_t width = 1;
+    while (width < numThreads * 4 && indexChild(indexLevel) <= size())
+    {
+        indexLevel = indexChild(indexLevel);
+        width *= Arity;
+    }
+    size_t indexEnd = indexLevel + width - 1 < size() ? indexLevel + width - 1 : size();
+    size_t numNodes = indexEnd - indexLevel + 1;
+
+    runParallel(numThreads, [this, indexLevel, numNodes, numThreads](size_t t)
+    {
+        size_t indexFirst = indexLevel + numNodes * t / numThreads;
+        size_t indexLast  = indexLevel + numNodes * (t + 1) / numThreads - 1;
+        if (indexFirst <= indexLast)
+            heapifySubtrees(indexFirst, indexLast);
+    });
+
+    for (size_t i = indexLevel - 1; i > 0; i--)
+        percolateDown(i);
+}
+
+/************************************************
+ * P QUEUE :: HEAPIFY SUBTREES
+ * The descendants of a run of siblings are a run on
+ * every level below. Percolate those runs down from
+ * the deepest one up, touching nothing outside them.
+ ************************************************/
+template <class T, class Compare, size_t Arity>
+void priority_queue <T, Compare, Arity> :: heapifySubtrees(size_t indexFirst, size_t indexLast)
+{
+    size_t firsts[64];
+    size_t lasts[64];
+    size_t numLevels = 0;
+    while (indexFirst <= size())
+    {
+        firsts[numLevels] = indexFirst;
+        lasts[numLevels] = indexLast < size() ? indexLast : size();
+        numLevels++;
+        indexFirst = indexChild(indexFirst);
+        indexLast = indexChild(indexLast) + Arity - 1;
+    }
+
+    for (size_t level = numLevels; level > 0; level--)
+        for (size_t i = lasts[level - 1]; i >= firsts[level - 1]; i--)
+            percolateDown(i);
+}
+
+/************************************************
+ * P QUEUE :: SORT BEST LAST
+ * Sort container[indexFirst..] worst to best: each
+ * thread sorts a slice, then neighbouring slices are
+ * merged in pairs, the pairs of a round in parallel
+ ************************************************/
+template <class T, class Compare, size_t Arity>
+void priority_queue <T, Compare, Arity> :: sortBestLast(size_t indexFirst, size_t numThreads)
+{
+    T * begin = &container[0] + indexFirst;
+    size_t num = size() - indexFirst;
+    auto less = [this](const T & lhs, const T & rhs) { return compare(lhs, rhs); };
+    if (numThreads < 2)
+    {
+        std::sort(begin, begin + num, less);
+        return;
+    }
+
+    runParallel(numThreads, [begin, num, numThreads, less](size_t t)
+    {
+        std::sort(begin + num * t / numThreads, begin + num * (t + 1) / numThreads, less);
+    });
+    for (size_t width = 1; width < numThreads; width *= 2)
+    {
+        size_t numMerges = (numThreads + 2 * width - 1) / (2 * width);
+        runParallel(numMerges, [begin, num, numThreads, width, less](size_t m)
+        {
+            size_t slice = m * 2 * width;
+            size_t end = slice + 2 * width < numThreads ? slice + 2 * width : numThreads;
+            if (slice + width < end)
+                std::inplace_merge(begin + num * slice / numThreads,
+                                   begin + num * (slice + width) / numThreads,
+                                   begin + num * end / numThreads, less);
+        });
+    }
+}
+
+/************************************************
+ * P QUEUE :: NUM THREADS FOR
+ * Ask for one thread per core with 0, and never
+ * give a thread less than PARALLEL_GRAIN elements
+ ************************************************/
+template <class T, class Compare, size_t Arity>
+size_t priority_queue <T, Compare, Arity> :: numThreadsFor(size_t numElements, size_t numThreads)
+{
+    if (numThreads == 0)
+        numThreads = std::thread::hardware_concurrency();
+    size_t numUseful = numElements / PARALLEL_GRAIN;
+    if (numThreads > numUseful)
+        numThreads = numUseful;
+    return numThreads ? numThreads : 1;
+}
+
+/************************************************
+ * P QUEUE :: RUN PARALLEL
+ * If starting a thread or work(0) throws, join the
+ * threads already started before passing it on
+ ************************************************/
+template <class T, class Compare, size_t Arity>
+template <class Work>
+void priority_queue <T, Compare, Arity> :: runParallel(size_t numThreads, Work work)
+{
+    std::vector<std::thread> threads;
+    try
+    {
+        threads.reserve(numThreads - 1);
+        for (size_t t = 1; t < numThreads; t++)
+            threads.emplace_back(work, t);
+        work(0);
+    }
+    catch (...)
+    {
+        for (size_t t = 0; t < threads.size(); t++)
+            threads[t].join();
+        throw;
+    }
+    for (size_t t = 0; t < threads.size(); t++)
+        threads[t].join();
+}
+
 /************************************************
  * SWAP
  * Swap the contents of two priority queues
  ************************************************/
 
 // swap swaps...
-template <class T>
-inline void swap(custom::priority_queue <T>& lhs,
-                 custom::priority_queue <T>& rhs)
+template <class T, class Compare, size_t Arity>
+inline void swap(custom::priority_queue <T, Compare, Arity>& lhs,
+                 custom::priority_queue <T, Compare, Arity>& rhs)
 {
     std::swap(lhs.container, rhs.container); // swappy swap swap 
+    std::swap(static_cast<compare_holder<Compare> &>(lhs), static_cast<compare_holder<Compare> &>(rhs));
 }
 
 };
@@ -0,0 +1,208 @@
+/***********************************************************************
+ * Header:
+ *    RADIX HEAP
+ * Summary:
+ *    A monotone priority queue for unsigned integer keys: every key
+ *    pushed must be at least the last key popped
+ *
+ *    This will contain the class definition of:
+ *        radix_heap             : A min priority queue of (key, value)
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <limits>       // for std::numeric_limits
+#include <stdexcept>    // for std::out_of_range
+#include <type_traits>  // for std::is_unsigned
+#include <utility>      // for std::pair
+#include "vector.h"
+#include "bits.h"
+
+class TestRadixHeap;    // forward declaration for unit test class
+
+namespace custom
+{
+
+/*************************************************
+ * RADIX HEAP
+ * Bucket 0 holds keys equal to the last key popped.
+ * Bucket i holds keys that first differ from it in
+ * bit i-1. Popping only scans an emptied bucket once
+ * and hands its elements to lower buckets, so each
+ * element moves at most once per bit: amortized
+ * O(log C) with no comparisons between arbitrary keys.
+ *************************************************/
+template<class Key, class Value>
+class radix_heap
+{
+   static_assert(std::is_unsigned<Key>::value, "a radix heap needs unsigned integer keys");
+
+   friend class ::TestRadixHeap; // give the unit test class access to the privates
+
+public:
+   typedef std::pair<Key, Value> value_type;
+
+   //
+   // construct
+   //
+
+   radix_heap() : last(0), numElements(0), minBucket(0), minIndex(0) {}
+
+   //
+   // Access
+   //
+   const value_type & top() const;   // the element with the smallest key
+   Key last_key() const { return last; }   // the last key popped
+
+   //
+   // Insert
+   //
+   void push(Key key, const Value & value);
+   void push(Key key, Value && value);
+
+   //
+   // Remove
+   //
+   void pop();
+
+   //
+   // Status
+   //
+   size_t size()  const { return numElements;      }
+   bool   empty() const { return numElements == 0; }
+
+private:
+   enum { NUM_BUCKETS = std::numeric_limits<Key>::digits + 1 };
+
+   void   pull();                    // make sure bucket 0 holds the minimum
+   void   findMin() const;           // fill minBucket and minIndex; bucket 0 is empty
+   size_t bucket(Key key) const { return bit_width(uint64_t(key ^ last)); }
+   void   checkKey(Key key) const;
+
+   custom::vector<value_type> buckets[NUM_BUCKETS];
+   Key                        last;          // the smallest key still allowed
+   size_t                     numElements;
+
+   // where top() found the minimum, so pop() need not look again; 0 when unknown
+   mutable size_t             minBucket;
+   mutable size_t             minIndex;
+};
+
+/************************************************
+ * RADIX HEAP :: TOP
+ * Every key in a bucket is below every key in the
+ * buckets after it, so the minimum is the smallest
+ * key of the first bucket that has any. Nothing moves
+ * and last stays put: only pop raises the bound.
+ ***********************************************/
+template <class Key, class Value>
+const typename radix_heap <Key, Value> :: value_type &
+radix_heap <Key, Value> :: top() const
+{
+   if (empty())
+      throw std::out_of_range("std:out_of_range");
+   if (!buckets[0].empty())
+      return buckets[0].back();
+   if (!minBucket)
+      findMin();
+   return buckets[minBucket][minIndex];
+}
+
+/************************************************
+ * RADIX HEAP :: PUSH
+ * Reject keys smaller than the last one popped
+ ***********************************************/
+template <class Key, class Value>
+void radix_heap <Key, Value> :: push(Key key, const Value & value)
+{
+   checkKey(key);
+   if (bucket(key) <= minBucket)
+      minBucket = 0;
+   buckets[bucket(key)].push_back(value_type(key, value));
+   numElements++;
+}
+
+template <class Key, class Value>
+void radix_heap <Key, Value> :: push(Key key, Value && value)
+{
+   checkKey(key);
+   if (bucket(key) <= minBucket)
+      minBucket = 0;
+   buckets[bucket(key)].push_back(value_type(key, std::move(value)));
+   numElements++;
+}
+
+/************************************************
+ * RADIX HEAP :: POP
+ ***********************************************/
+template <class Key, class Value>
+void radix_heap <Key, Value> :: pop()
+{
+   if (empty())
+      return;
+   pull();
+   buckets[0].pop_back();
+   numElements--;
+}
+
+/************************************************
+ * RADIX HEAP :: PULL
+ * If bucket 0 is empty, find the first non-empty
+ * bucket, make its minimum the new last key, and
+ * spread its elements into the lower buckets
+ ***********************************************/
+template <class Key, class Value>
+void radix_heap <Key, Value> :: pull()
+{
+   assert(numElements > 0);
+   if (!buckets[0].empty())
+      return;
+
+   if (!minBucket)
+      findMin();
+   custom::vector<value_type> & from = buckets[minBucket];
+   last = from[minIndex].first;
+   minBucket = 0;
+
+   for (size_t j = 0; j < from.size(); j++)
+      buckets[bucket(from[j].first)].push_back(std::move(from[j]));
+   from.clear();
+}
+
+/************************************************
+ * RADIX HEAP :: FIND MIN
+ * The smallest key of the first non-empty bucket
+ ***********************************************/
+template <class Key, class Value>
+void radix_heap <Key, Value> :: findMin() const
+{
+   assert(numElements > 0 && buckets[0].empty());
+   size_t i = 1;
+   while (buckets[i].empty())
+      i++;
+
+   const custom::vector<value_type> & from = buckets[i];
+   size_t iMin = 0;
+   Key    keyMin = from[0].first;
+   for (size_t j = 1; j < from.size(); j++)
+      if (from[j].first < keyMin)
+      {
+         iMin = j;
+         keyMin = from[j].first;
+      }
+   minBucket = i;
+   minIndex = iMin;
+}
+
+/************************************************
+ * RADIX HEAP :: CHECK KEY
+ ***********************************************/
+template <class Key, class Value>
+void radix_heap <Key, Value> :: checkKey(Key key) const
+{
+   if (key < last)
+      throw std::invalid_argument("radix_heap key is smaller than the last key popped");
+}
+
+};
@@ -0,0 +1,363 @@
+/***********************************************************************
+ * Header:
+ *    SKIPLIST PRIORITY QUEUE
+ * Summary:
+ *    A lock-free priority queue for many threads after Linden and
+ *    Jonsson: a skiplist whose front is deleted logically by one
+ *    atomic instruction and cut off physically in batches
+ *
+ *    This will contain the class definition of:
+ *        skiplist_priority_queue : A lock-free priority queue
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <atomic>       // for std::atomic
+#include <cstdint>      // for uintptr_t, uint64_t
+#include <functional>   // for std::less, std::hash
+#include <new>          // for placement new, ::operator new
+#include <thread>       // for std::this_thread
+#include "compare_holder.h"
+#include "epoch.h"
+
+class TestSkiplistPQueue;    // forward declaration for unit test class
+
+namespace custom
+{
+
+/*************************************************
+ * SKIPLIST PRIORITY QUEUE
+ * The skiplist is kept in pop order, so like
+ * priority_queue the largest element under Compare
+ * comes out first. The low bit of a node's level-0
+ * next pointer marks its successor as deleted, so the
+ * deleted nodes are always a prefix of the list. Pop
+ * walks that prefix setting the bit with fetch_or until
+ * it sets one nobody had set before; the node behind it
+ * is the one it popped. Only once the prefix is longer
+ * than BOUND_OFFSET does a pop swing the head past it
+ * and retire the nodes to the epoch domain, so pops
+ * rarely write to the same word. Nothing ever waits
+ * on a lock. Pop copies the value out rather than
+ * moving it because other threads may still be
+ * comparing against it.
+ *************************************************/
+template<class T, class Compare = std::less<T>>
+class skiplist_priority_queue : private compare_holder<Compare>
+{
+   friend class ::TestSkiplistPQueue; // give the unit test class access to the privates
+
+public:
+
+   //
+   // construct
+   //
+
+   explicit skiplist_priority_queue(const Compare & compare = Compare()) : compare_holder<Compare>(compare)
+   {
+      for (size_t i = 0; i < MAX_LEVEL; i++)
+         head[i].store(0);
+   }
+   skiplist_priority_queue(const skiplist_priority_queue & rhs) = delete;
+   skiplist_priority_queue & operator = (const skiplist_priority_queue & rhs) = delete;
+  ~skiplist_priority_queue();
+
+   //
+   // Insert
+   //
+   void push(const T & t);
+
+   //
+   // Remove
+   //
+   bool try_pop(T & t);    // false when the queue was empty
+
+   //
+   // Status. Only a snapshot while other threads are working
+   //
+   bool empty() const;
+
+private:
+   enum { MAX_LEVEL = 24,       // enough for 2^24 elements before the levels stop helping
+          BOUND_OFFSET = 32 };  // deleted nodes at the front before a pop cuts them off
+
+   typedef std::atomic<uintptr_t> Link;
+
+   // the next pointers follow the node in the same allocation
+   struct Node
+   {
+      Node(const T & data, size_t height) : data(data), height(height), inserting(true) {}
+      T                 data;
+      size_t            height;
+      std::atomic<bool> inserting;   // still linking the upper levels
+      Link * next() { return reinterpret_cast<Link *>(this + 1); }
+   };
+
+   static bool   isMarked(uintptr_t link) { return link & 1;                               }
+   static Node * node(uintptr_t link)     { return reinterpret_cast<Node *>(link & ~uintptr_t(1)); }
+
+   static Node * create(const T & t, size_t height);
+   static void   destroy(void * p);
+   static size_t randomHeight();
+
+   Node * locatePreds(const T & t, Link ** preds, Node ** succs);
+   void   restructure();
+
+   // does lhs belong below rhs in the heap?
+   bool compare(const T & lhs, const T & rhs) const
+   {
+      return this->comparator()(lhs, rhs);
+   }
+
+   Link head[MAX_LEVEL];   // the sentinel is just its next pointers
+};
+
+/************************************************
+ * SKIPLIST PRIORITY QUEUE :: DESTRUCTOR
+ * Every node still linked at level 0, deleted or not.
+ * The ones already cut off belong to the epoch domain.
+ ***********************************************/
+template <class T, class Compare>
+skiplist_priority_queue <T, Compare> :: ~skiplist_priority_queue()
+{
+   Node * p = node(head[0].load());
+   while (p)
+   {
+      Node * next = node(p->next()[0].load());
+      destroy(p);
+      p = next;
+   }
+}
+
+/************************************************
+ * SKIPLIST PRIORITY QUEUE :: PUSH
+ * Link level 0 first; that is the moment the element
+ * is in the queue. Then link the upper levels, giving
+ * up if a pop takes the node in the meantime.
+ ***********************************************/
+template <class T, class Compare>
+void skiplist_priority_queue <T, Compare> :: push(const T & t)
+{
+   epoch_domain::guard guard;
+
+   size_t height = randomHeight();
+   Node * newNode = create(t, height);
+   Link * preds[MAX_LEVEL];
+   Node * succs[MAX_LEVEL];
+
+   Node * deleted;
+   uintptr_t expected;
+   do
+   {
+      deleted = locatePreds(t, preds, succs);
+      newNode->next()[0].store(reinterpret_cast<uintptr_t>(succs[0]));
+      expected = reinterpret_cast<uintptr_t>(succs[0]);
+   }
+   while (!preds[0][0].compare_exchange_strong(expected, reinterpret_cast<uintptr_t>(newNode)));
+
+   for (size_t i = 1; i < height; )
+   {
+      newNode->next()[i].store(reinterpret_cast<uintptr_t>(succs[i]));
+
+      // stop if newNode or the node it would point to has been popped
+      if (isMarked(newNode->next()[0].load()) ||
+          (succs[i] && isMarked(succs[i]->next()[0].load())) ||
+          (succs[i] && succs[i] == deleted))
+         break;
+
+      expected = reinterpret_cast<uintptr_t>(succs[i]);
+      if (preds[i][i].compare_exchange_strong(expected, reinterpret_cast<uintptr_t>(newNode)))
+         i++;
+      else
+      {
+         deleted = locatePreds(t, preds, succs);
+         if (succs[0] != newNode)
+            break;
+      }
+   }
+
+   newNode->inserting.store(false);
+}
+
+/************************************************
+ * SKIPLIST PRIORITY QUEUE :: TRY POP
+ * Walk the deleted prefix with plain loads and mark the
+ * first link found unmarked. If the mark is ours, it
+ * claims the node after it; if another thread got there
+ * first, keep walking. If the prefix is long enough,
+ * swing the head to the end of it (or to the first
+ * node still being inserted, which must not be freed
+ * under its inserter) and retire the rest.
+ ***********************************************/
+template <class T, class Compare>
+bool skiplist_priority_queue <T, Compare> :: try_pop(T & t)
+{
+   epoch_domain::guard guard;
+
+   uintptr_t observedHead = head[0].load();
+   Link *    pred = head;
+   Node *    predNode = nullptr;
+   Node *    newHead = nullptr;
+   size_t    offset = 0;
+
+   for (;;)
+   {
+      uintptr_t next = pred[0].load();
+      if (!node(next))
+         return false;
+      if (!newHead && predNode && predNode->inserting.load())
+         newHead = predNode;
+
+      // a marked link is read only; the first unmarked one is claimed
+      if (!isMarked(next))
+         next = pred[0].fetch_or(1);
+      offset++;
+      predNode = node(next);
+      if (!isMarked(next))
+         break;
+      pred = predNode->next();
+   }
+
+   t = predNode->data;
+   if (offset < BOUND_OFFSET)
+      return true;
+
+   if (!newHead)
+      newHead = predNode;
+   if (head[0].compare_exchange_strong(observedHead, reinterpret_cast<uintptr_t>(newHead) | 1))
+   {
+      restructure();
+      for (Node * p = node(observedHead); p != newHead; )
+      {
+         Node * pNext = node(p->next()[0].load());
+         epoch_domain::instance().retire(p, &destroy);
+         p = pNext;
+      }
+   }
+   return true;
+}
+
+/************************************************
+ * SKIPLIST PRIORITY QUEUE :: EMPTY
+ * Is there a node past the deleted prefix?
+ ***********************************************/
+template <class T, class Compare>
+bool skiplist_priority_queue <T, Compare> :: empty() const
+{
+   epoch_domain::guard guard;
+
+   uintptr_t link = head[0].load();
+   while (isMarked(link))
+      link = node(link)->next()[0].load();
+   return node(link) == nullptr;
+}
+
+/************************************************
+ * SKIPLIST PRIORITY QUEUE :: LOCATE PREDS
+ * For every level, the last node t goes behind and the
+ * node t goes in front of, skipping deleted nodes.
+ * Return the last deleted node passed at level 0.
+ ***********************************************/
+template <class T, class Compare>
+typename skiplist_priority_queue <T, Compare> :: Node *
+skiplist_priority_queue <T, Compare> :: locatePreds(const T & t, Link ** preds, Node ** succs)
+{
+   Node * deleted = nullptr;
+   Link * pred = head;
+
+   for (size_t i = MAX_LEVEL; i-- > 0; )
+   {
+      // cur and its mark come from one load, so the mark is cur's
+      uintptr_t link = pred[i].load();
+      Node *    cur = node(link);
+
+      // skip cur if it is deleted or if t belongs below it
+      while (cur && (isMarked(cur->next()[0].load()) ||
+                     (i == 0 && isMarked(link)) ||
+                     compare(t, cur->data)))
+      {
+         if (i == 0 && isMarked(link))
+            deleted = cur;
+         pred = cur->next();
+         link = pred[i].load();
+         cur = node(link);
+      }
+      preds[i] = pred;
+      succs[i] = cur;
+   }
+   return deleted;
+}
+
+/************************************************
+ * SKIPLIST PRIORITY QUEUE :: RESTRUCTURE
+ * Move the upper levels of the head past the deleted
+ * prefix so nothing points into the nodes being retired
+ ***********************************************/
+template <class T, class Compare>
+void skiplist_priority_queue <T, Compare> :: restructure()
+{
+   Link * pred = head;
+   for (size_t i = MAX_LEVEL - 1; i > 0; )
+   {
+      uintptr_t h = head[i].load();
+      if (!node(h) || !isMarked(node(h)->next()[0].load()))
+      {
+         i--;
+         continue;
+      }
+
+      Node * cur = node(pred[i].load());
+      while (cur && isMarked(cur->next()[0].load()))
+      {
+         pred = cur->next();
+         cur = node(pred[i].load());
+      }
+      if (head[i].compare_exchange_strong(h, pred[i].load()))
+         i--;
+   }
+}
+
+/************************************************
+ * SKIPLIST PRIORITY QUEUE :: CREATE and DESTROY
+ * One allocation holds the node and height links
+ ***********************************************/
+template <class T, class Compare>
+typename skiplist_priority_queue <T, Compare> :: Node *
+skiplist_priority_queue <T, Compare> :: create(const T & t, size_t height)
+{
+   void * p = ::operator new(sizeof(Node) + height * sizeof(Link));
+   Node * newNode = new (p) Node(t, height);
+   for (size_t i = 0; i < height; i++)
+      new (newNode->next() + i) Link(0);
+   return newNode;
+}
+
+template <class T, class Compare>
+void skiplist_priority_queue <T, Compare> :: destroy(void * p)
+{
+   Node * oldNode = static_cast<Node *>(p);
+   oldNode->~Node();
+   ::operator delete(p);
+}
+
+/************************************************
+ * SKIPLIST PRIORITY QUEUE :: RANDOM HEIGHT
+ * One more level with probability one half
+ ***********************************************/
+template <class T, class Compare>
+size_t skiplist_priority_queue <T, Compare> :: randomHeight()
+{
+   thread_local uint64_t state =
+      std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+   state ^= state << 13;
+   state ^= state >> 7;
+   state ^= state << 17;
+
+   size_t height = 1;
+   for (uint64_t bits = state; (bits & 1) && height < MAX_LEVEL; bits >>= 1)
+      height++;
+   return height;
+}
+
+};
@@ -0,0 +1,308 @@
+/***********************************************************************
+ * Header:
+ *    TEST ADDRESSABLE PRIORITY QUEUE
+ * Summary:
+ *    Unit tests for the addressable priority queue
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "addressable_priority_queue.h"
+#include "unitTest.h"
+
+#include <cassert>
+
+class TestAddressablePQueue : public UnitTest
+{
+   typedef custom::addressable_priority_queue <int>::handle Handle;
+
+public:
+   void run()
+   {
+      reset();
+
+      // Insert
+      test_push_handles();
+      test_push_top();
+
+      // Update
+      test_update_up();
+      test_update_down();
+      test_update_invalid();
+
+      // Remove
+      test_pop_handles();
+      test_erase_middle();
+      test_erase_back();
+      test_erase_reuse();
+      test_erase_staleHandle();
+
+      // Workload
+      test_decreaseKey_order();
+
+      report("AddressablePQueue");
+   }
+
+   /***************************************
+    * PUSH
+    ***************************************/
+
+   // every push gets its own handle
+   void test_push_handles()
+   {  // setup
+      custom::addressable_priority_queue <int> pq;
+      // exercise
+      Handle h4 = pq.push(4);
+      Handle h9 = pq.push(9);
+      Handle h1 = pq.push(1);
+      // verify
+      assertUnit(h4 != h9 && h9 != h1 && h4 != h1);
+      assertUnit(pq.contains(h4) && pq.contains(h9) && pq.contains(h1));
+      assertUnit(pq.get(h4) == 4);
+      assertUnit(pq.get(h9) == 9);
+      assertUnit(pq.get(h1) == 1);
+      assertTablesParameters(pq, __LINE__, __FUNCTION__);
+   }  // teardown
+
+   // the biggest is on top, and so is its handle
+   void test_push_top()
+   {  // setup
+      custom::addressable_priority_queue <int> pq;
+      pq.push(4);
+      Handle h9 = pq.push(9);
+      pq.push(1);
+      // exercise
+      int value = pq.top();
+      Handle h = pq.top_handle();
+      // verify
+      assertUnit(value == 9);
+      assertUnit(h == h9);
+      assertTablesParameters(pq, __LINE__, __FUNCTION__);
+   }  // teardown
+
+   /***************************************
+    * UPDATE
+    ***************************************/
+
+   // make a small element the biggest
+   void test_update_up()
+   {  // setup
+      custom::addressable_priority_queue <int> pq;
+      setupStandardFixture(pq);
+      Handle h3 = handles[4];
+      // exercise
+      pq.update(h3, 20);
+      // verify
+      assertUnit(pq.top() == 20);
+      assertUnit(pq.top_handle() == h3);
+      assertUnit(pq.get(h3) == 20);
+      assertTablesParameters(pq, __LINE__, __FUNCTION__);
+   }  // teardown
+
+   // make the biggest element the smallest
+   void test_update_down()
+   {  // setup
+      custom::addressable_priority_queue <int> pq;
+      setupStandardFixture(pq);
+      Handle h10 = handles[0];
+      // exercise
+      pq.update(h10, 0);
+      // verify
+      assertUnit(pq.top() == 9);
+      assertUnit(pq.get(h10) == 0);
+      assertTablesParameters(pq, __LINE__, __FUNCTION__);
+   }  // teardown
+
+   // update a handle that is not in the queue
+   void test_update_invalid()
+   {  // setup
+      custom::addressable_priority_queue <int> pq;
+      setupStandardFixture(pq);
+      bool thrown = false;
+      // exercise
+      try
+      {
+         Handle h = { 99, 0 };
+         pq.update(h, 1);
+      }
+      catch (const std::out_of_range &)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(pq.size() == 7);
+   }  // teardown
+
+   /***************************************
+    * POP and ERASE
+    ***************************************/
+
+   // popped handles are no longer contained
+   void test_pop_handles()
+   {  // setup
+      custom::addressable_priority_queue <int> pq;
+      setupStandardFixture(pq);
+      // exercise
+      pq.pop();
+      pq.pop();
+      // verify
+      assertUnit(!pq.contains(handles[0]));   // 10
+      assertUnit(!pq.contains(handles[2]));   // 9
+      assertUnit(pq.contains(handles[1]));    // 8
+      assertUnit(pq.top() == 8);
+      assertUnit(pq.size() == 5);
+      assertTablesParameters(pq, __LINE__, __FUNCTION__);
+   }  // teardown
+
+   // erase from the middle of the heap
+   void test_erase_middle()
+   {  // setup
+      custom::addressable_priority_queue <int> pq;
+      setupStandardFixture(pq);
+      // exercise
+      pq.erase(handles[1]);   // 8
+      // verify
+      assertUnit(!pq.contains(handles[1]));
+      assertUnit(pq.size() == 6);
+      assertTablesParameters(pq, __LINE__, __FUNCTION__);
+      int expected[] = {10, 9, 7, 5, 4, 3};
+      bool sorted = true;
+      for (int i = 0; i < 6; i++)
+      {
+         sorted = sorted && pq.top() == expected[i];
+         pq.pop();
+      }
+      assertUnit(sorted);
+   }  // teardown
+
+   // erase the element in the back slot
+   void test_erase_back()
+   {  // setup
+      custom::addressable_priority_queue <int> pq;
+      setupStandardFixture(pq);
+      // exercise
+      pq.erase(handles[6]);   // 5
+      // verify
+      assertUnit(!pq.contains(handles[6]));
+      assertUnit(pq.size() == 6);
+      assertTablesParameters(pq, __LINE__, __FUNCTION__);
+   }  // teardown
+
+   // erased ids are given out again, in a new generation
+   void test_erase_reuse()
+   {  // setup
+      custom::addressable_priority_queue <int> pq;
+      setupStandardFixture(pq);
+      pq.erase(handles[3]);   // 4
+      // exercise
+      Handle h = pq.push(6);
+      // verify
+      assertUnit(h.id == handles[3].id);
+      assertUnit(h != handles[3]);
+      assertUnit(pq.get(h) == 6);
+      assertUnit(pq.positions.size() == 7);
+      assertTablesParameters(pq, __LINE__, __FUNCTION__);
+   }  // teardown
+
+   // a handle whose id went to a new element reaches nothing
+   void test_erase_staleHandle()
+   {  // setup
+      custom::addressable_priority_queue <int> pq;
+      setupStandardFixture(pq);
+      pq.erase(handles[3]);   // 4
+      Handle h = pq.push(6);
+      bool thrownUpdate = false;
+      bool thrownErase = false;
+      // exercise
+      try
+      {
+         pq.update(handles[3], 100);
+      }
+      catch (const std::out_of_range &)
+      {
+         thrownUpdate = true;
+      }
+      try
+      {
+         pq.erase(handles[3]);
+      }
+      catch (const std::out_of_range &)
+      {
+         thrownErase = true;
+      }
+      // verify
+      assertUnit(!pq.contains(handles[3]));
+      assertUnit(thrownUpdate);
+      assertUnit(thrownErase);
+      assertUnit(pq.contains(h));
+      assertUnit(pq.get(h) == 6);
+      assertUnit(pq.top() == 10);
+      assertUnit(pq.size() == 7);
+      assertTablesParameters(pq, __LINE__, __FUNCTION__);
+   }  // teardown
+
+   /***************************************
+    * WORKLOAD
+    ***************************************/
+
+   // a min-heap where every key is lowered several times
+   void test_decreaseKey_order()
+   {  // setup
+      custom::addressable_priority_queue <int, std::greater<int>> pq;
+      custom::addressable_priority_queue <int, std::greater<int>>::handle h[50];
+      for (int i = 0; i < 50; i++)
+         h[i] = pq.push(1000 + i);
+      // exercise
+      for (int round = 0; round < 3; round++)
+         for (int i = 0; i < 50; i++)
+            pq.update(h[i], pq.get(h[i]) - (i * 7 + round * 13) % 50);
+      // verify
+      assertTablesParameters(pq, __LINE__, __FUNCTION__);
+      bool sorted = true;
+      int previous = pq.top();
+      while (!pq.empty())
+      {
+         sorted = sorted && previous <= pq.top();
+         previous = pq.top();
+         pq.pop();
+      }
+      assertUnit(sorted);
+   }  // teardown
+
+   /***************************************************
+    * SETUP STANDARD FIXTURE
+    *                 10
+    *           8            9
+    *        4     3      7     5
+    * handles[i] is the handle of the i'th pushed value
+    ***************************************************/
+   Handle handles[7];
+   void setupStandardFixture(custom::addressable_priority_queue <int>& pq)
+   {
+      int values[] = {10, 8, 9, 4, 3, 7, 5};
+      for (int i = 0; i < 7; i++)
+         handles[i] = pq.push(values[i]);
+   }
+
+   /***************************************************
+    * VERIFY TABLES
+    * The heap is in order and the side tables agree
+    ***************************************************/
+   template <class T, class Compare>
+   void assertTablesParameters(const custom::addressable_priority_queue <T, Compare>& pq,
+                               int line, const char* function)
+   {
+      assertIndirect(pq.handles.size() == pq.container.size());
+      for (size_t i = 1; i <= pq.container.size(); i++)
+      {
+         assertIndirect(pq.positions[pq.handles[i - 1]] == i);
+         if (i > 1)
+            assertIndirect(!pq.compare(pq.container[(i - 2) / 2], pq.container[i - 1]));
+      }
+   }
+};
+
+#endif // DEBUG
@@ -0,0 +1,443 @@
+/***********************************************************************
+ * Header:
+ *    TEST ASYNC PRIORITY QUEUE
+ * Summary:
+ *    Unit tests for the coroutine-awaitable priority queue. Empty
+ *    before C++20.
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#if __cplusplus >= 202002L || _MSVC_LANG >= 202002L
+
+#include "async_priority_queue.h"
+#include "unitTest.h"
+
+#include <cassert>
+#include <coroutine>    // for std::suspend_never, std::suspend_always
+#include <exception>    // for std::terminate
+#include <thread>       // for std::thread
+#include <vector>       // for std::vector
+#include <utility>      // for std::swap
+
+class TestAsyncPQueue : public UnitTest
+{
+
+public:
+   void run()
+   {
+      reset();
+
+      // Pop
+      test_pop_ready();
+      test_pop_waits();
+      test_pop_executor();
+      test_pop_bestFirst();
+      test_pop_waitersInOrder();
+
+      // Close
+      test_close_wakesWaiters();
+      test_close_drainsFirst();
+      test_close_waiterDestroysOther();
+
+      // Cancel
+      test_cancel_onlyWaiter();
+      test_cancel_middleWaiter();
+      test_cancel_noLeak();
+      test_cancel_afterPush();
+      test_cancel_afterPushNextWaiter();
+      test_cancel_afterClose();
+
+      // Threads
+      test_threads_producer();
+
+      report("AsyncPQueue");
+   }
+
+   /***************************************
+    * TASK
+    * A coroutine that starts at once and keeps its
+    * frame at the end until its owner lets go. Counts
+    * the frames alive, so a leak shows.
+    ***************************************/
+   struct Task
+   {
+      struct promise_type
+      {
+         promise_type()  { numFrames++; }
+        ~promise_type()  { numFrames--; }
+         Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+         std::suspend_never  initial_suspend() noexcept { return {}; }
+         std::suspend_always final_suspend()   noexcept { return {}; }
+         void return_void() {}
+         void unhandled_exception() { std::terminate(); }
+      };
+
+      explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+      Task(Task && rhs) : handle(rhs.handle) { rhs.handle = nullptr; }
+      Task(const Task & rhs) = delete;
+     ~Task() { if (handle) handle.destroy(); }
+      Task & operator = (Task && rhs)
+      {
+         std::swap(handle, rhs.handle);
+         return *this;
+      }
+      bool done() const { return handle.done(); }
+
+      std::coroutine_handle<promise_type> handle;
+      static inline int numFrames = 0;
+   };
+
+   typedef custom::async_priority_queue <int> Queue;
+
+   // pop until the queue closes, recording each value
+   static Task consumer(Queue & q, custom::event_loop * loop, std::vector<int> & out)
+   {
+      for (;;)
+      {
+         std::optional<int> value = loop ? co_await q.pop(*loop) : co_await q.pop();
+         if (!value)
+            co_return;
+         out.push_back(*value);
+      }
+   }
+
+   // pop just once
+   static Task popOnce(Queue & q, std::vector<int> & out)
+   {
+      std::optional<int> value = co_await q.pop();
+      out.push_back(value ? *value : -1);
+   }
+
+   // pop just once, then destroy another task
+   static Task popThenDestroy(Queue & q, Task ** victim)
+   {
+      co_await q.pop();
+      delete *victim;
+      *victim = nullptr;
+   }
+
+   /***************************************
+    * POP
+    ***************************************/
+
+   // an element is there: no suspension
+   void test_pop_ready()
+   {  // setup
+      Queue q;
+      q.push(3);
+      std::vector<int> out;
+      // exercise
+      Task task = popOnce(q, out);
+      // verify
+      assertUnit(task.done());
+      assertUnit(out.size() == 1 && out[0] == 3);
+      assertUnit(q.num_waiters() == 0);
+   }  // teardown
+
+   // nothing there: suspend until a push, which resumes us inline
+   void test_pop_waits()
+   {  // setup
+      Queue q;
+      std::vector<int> out;
+      Task task = popOnce(q, out);
+      bool waited = !task.done() && q.num_waiters() == 1;
+      // exercise
+      q.push(8);
+      // verify
+      assertUnit(waited);
+      assertUnit(task.done());
+      assertUnit(out.size() == 1 && out[0] == 8);
+      assertUnit(q.num_waiters() == 0);
+      assertUnit(q.empty());
+   }  // teardown
+
+   // with an executor the push only schedules; the loop resumes
+   void test_pop_executor()
+   {  // setup
+      Queue q;
+      custom::event_loop loop;
+      std::vector<int> out;
+      Task task = consumer(q, &loop, out);
+      // exercise
+      q.push(4);
+      bool resumedInPush = !out.empty();
+      size_t numResumed = loop.run();
+      // verify
+      assertUnit(!resumedInPush);
+      assertUnit(numResumed == 1);
+      assertUnit(out.size() == 1 && out[0] == 4);
+      assertUnit(q.num_waiters() == 1);
+      // teardown
+      q.close();
+      loop.run();
+      assertUnit(task.done());
+   }
+
+   // elements waiting in the heap come out best first
+   void test_pop_bestFirst()
+   {  // setup
+      Queue q;
+      int values[] = { 4, 9, 1, 7 };
+      for (int i = 0; i < 4; i++)
+         q.push(values[i]);
+      q.close();
+      std::vector<int> out;
+      // exercise
+      Task task = consumer(q, nullptr, out);
+      // verify
+      assertUnit(task.done());
+      assertUnit(out.size() == 4);
+      assertUnit(out == std::vector<int>({ 9, 7, 4, 1 }));
+   }  // teardown
+
+   // the waiter that has waited longest gets the next push
+   void test_pop_waitersInOrder()
+   {  // setup
+      Queue q;
+      std::vector<int> out;
+      Task first  = popOnce(q, out);
+      Task second = popOnce(q, out);
+      Task third  = popOnce(q, out);
+      // exercise
+      q.push(5);
+      q.push(9);
+      q.push(1);
+      // verify
+      assertUnit(first.done() && second.done() && third.done());
+      assertUnit(out == std::vector<int>({ 5, 9, 1 }));
+   }  // teardown
+
+   /***************************************
+    * CLOSE
+    ***************************************/
+
+   // every waiter resumes with nothing; pushes fail
+   void test_close_wakesWaiters()
+   {  // setup
+      Queue q;
+      std::vector<int> out;
+      Task first  = popOnce(q, out);
+      Task second = popOnce(q, out);
+      // exercise
+      q.close();
+      // verify
+      assertUnit(first.done() && second.done());
+      assertUnit(out == std::vector<int>({ -1, -1 }));
+      assertUnit(q.is_closed());
+      assertUnit(!q.push(3));
+      assertUnit(q.num_waiters() == 0);
+   }  // teardown
+
+   // what was pushed before close can still be popped
+   void test_close_drainsFirst()
+   {  // setup
+      Queue q;
+      q.push(2);
+      q.close();
+      std::vector<int> out;
+      // exercise
+      Task first  = popOnce(q, out);
+      Task second = popOnce(q, out);
+      // verify
+      assertUnit(out == std::vector<int>({ 2, -1 }));
+   }  // teardown
+
+   // the first waiter woken destroys the next one: close skips it safely
+   void test_close_waiterDestroysOther()
+   {  // setup
+      Queue q;
+      std::vector<int> out;
+      Task * second = nullptr;
+      Task first = popThenDestroy(q, &second);
+      second = new Task(popOnce(q, out));
+      Task third = popOnce(q, out);
+      // exercise
+      q.close();
+      // verify
+      assertUnit(first.done() && third.done());
+      assertUnit(second == nullptr);
+      assertUnit(out == std::vector<int>({ -1 }));
+      assertUnit(q.num_waiters() == 0);
+   }  // teardown
+
+   /***************************************
+    * CANCEL
+    ***************************************/
+
+   // destroying the only waiter leaves the list empty
+   void test_cancel_onlyWaiter()
+   {  // setup
+      Queue q;
+      std::vector<int> out;
+      {
+         Task task = popOnce(q, out);
+         assertUnit(q.num_waiters() == 1);
+      // exercise
+      }
+      q.push(6);
+      // verify
+      assertUnit(q.num_waiters() == 0);
+      assertUnit(q.head == nullptr && q.tail == nullptr);
+      assertUnit(out.empty());
+      assertUnit(q.size() == 1);
+   }  // teardown
+
+   // destroying a waiter in the middle keeps the others in order
+   void test_cancel_middleWaiter()
+   {  // setup
+      Queue q;
+      std::vector<int> out;
+      Task first = popOnce(q, out);
+      Task * second = new Task(popOnce(q, out));
+      Task third = popOnce(q, out);
+      // exercise
+      delete second;
+      q.push(1);
+      q.push(2);
+      // verify
+      assertUnit(first.done() && third.done());
+      assertUnit(out == std::vector<int>({ 1, 2 }));
+      assertUnit(q.num_waiters() == 0);
+   }  // teardown
+
+   // frames come and go in pairs, waiting, cancelled, or closed
+   void test_cancel_noLeak()
+   {  // setup
+      int numBefore = Task::numFrames;
+      custom::event_loop loop;
+      std::vector<int> out;
+      // exercise
+      {
+         Queue q;
+         std::vector<Task> tasks;
+         for (int i = 0; i < 10; i++)
+            tasks.push_back(consumer(q, &loop, out));
+         q.push(1);
+         loop.run();
+         tasks.erase(tasks.begin() + 3, tasks.begin() + 6);   // cancel three
+         q.close();
+         loop.run();
+         for (size_t i = 0; i < tasks.size(); i++)
+            assertUnit(tasks[i].done());
+         assertUnit(Task::numFrames == numBefore + 7);
+      }
+      // verify
+      assertUnit(Task::numFrames == numBefore);
+      assertUnit(out.size() == 1);
+   }  // teardown
+
+   // destroyed after a push handed it 5 but before the loop ran it
+   void test_cancel_afterPush()
+   {  // setup
+      Queue q;
+      custom::event_loop loop;
+      std::vector<int> out;
+      Task * task = new Task(consumer(q, &loop, out));
+      q.push(5);
+      // exercise
+      delete task;
+      size_t numResumed = loop.run();
+      // verify
+      assertUnit(numResumed == 0);
+      assertUnit(loop.size() == 0);
+      assertUnit(out.empty());
+      int value = 0;
+      assertUnit(q.try_pop(value) && value == 5);
+   }  // teardown
+
+   // the element passes on to the next waiter instead
+   void test_cancel_afterPushNextWaiter()
+   {  // setup
+      Queue q;
+      custom::event_loop loop;
+      std::vector<int> out;
+      Task * first = new Task(consumer(q, &loop, out));
+      Task second = consumer(q, &loop, out);
+      q.push(5);
+      // exercise
+      delete first;
+      size_t numResumed = loop.run();
+      // verify
+      assertUnit(numResumed == 1);
+      assertUnit(out == std::vector<int>({ 5 }));
+      assertUnit(q.empty());
+      assertUnit(q.num_waiters() == 1);
+      // teardown
+      q.close();
+      loop.run();
+   }
+
+   // destroyed after close posted it: nothing runs, nothing is lost
+   void test_cancel_afterClose()
+   {  // setup
+      Queue q;
+      custom::event_loop loop;
+      std::vector<int> out;
+      Task * task = new Task(consumer(q, &loop, out));
+      q.close();
+      // exercise
+      delete task;
+      size_t numResumed = loop.run();
+      // verify
+      assertUnit(numResumed == 0);
+      assertUnit(q.empty());
+   }  // teardown
+
+   /***************************************
+    * THREADS
+    ***************************************/
+
+   // a producer thread feeds consumers running on an event loop
+   void test_threads_producer()
+   {  // setup
+      const int num = 5000;
+      Queue q;
+      custom::event_loop loop;
+      std::vector<int> out;
+      std::vector<Task> tasks;
+      for (int i = 0; i < 4; i++)
+         tasks.push_back(consumer(q, &loop, out));
+      // exercise
+      std::thread producer([&q]()
+      {
+         for (int i = 0; i < num; i++)
+            q.push(i);
+         q.close();
+      });
+      bool allDone = false;
+      while (!allDone)
+      {
+         loop.run();
+         allDone = true;
+         for (size_t i = 0; i < tasks.size(); i++)
+            allDone = allDone && tasks[i].done();
+         std::this_thread::yield();
+      }
+      producer.join();
+      // verify
+      assertUnit(out.size() == (size_t)num);
+      std::vector<int> seen(num, 0);
+      for (size_t i = 0; i < out.size(); i++)
+         seen[out[i]]++;
+      bool once = true;
+      for (int i = 0; i < num; i++)
+         once = once && seen[i] == 1;
+      assertUnit(once);
+   }  // teardown
+};
+
+#else
+
+// coroutines need C++20: nothing to test
+class TestAsyncPQueue
+{
+public:
+   void run() {}
+};
+
+#endif // C++20
+
+#endif // DEBUG
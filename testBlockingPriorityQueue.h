@@ -0,0 +1,335 @@
+/***********************************************************************
+ * Header:
+ *    TEST BLOCKING PRIORITY QUEUE
+ * Summary:
+ *    Unit tests for the bounded blocking priority queue
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "blocking_priority_queue.h"
+#include "unitTest.h"
+
+#include <cassert>
+#include <atomic>    // for std::atomic
+#include <chrono>    // for std::chrono::milliseconds
+#include <thread>    // for std::thread
+#include <vector>    // for std::vector
+
+class TestBlockingPQueue : public UnitTest
+{
+
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_capacity();
+
+      // Insert
+      test_tryPush_full();
+      test_push_waitsForRoom();
+      test_push_closed();
+
+      // Remove
+      test_tryPop_order();
+      test_popWait_timeout();
+      test_popWait_waitsForPush();
+      test_popWait_closeWakes();
+      test_popWait_drainAfterClose();
+      test_popN_standard();
+      test_popN_wakesProducers();
+
+      // Threads
+      test_threads_pipeline();
+
+      report("BlockingPQueue");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // the capacity is at least one
+   void test_construct_capacity()
+   {  // setup
+      // exercise
+      custom::blocking_priority_queue <int> q(0);
+      // verify
+      assertUnit(q.max_size() == 1);
+      assertUnit(q.empty());
+      assertUnit(!q.is_closed());
+   }  // teardown
+
+   /***************************************
+    * PUSH
+    ***************************************/
+
+   // try_push refuses once the queue is full
+   void test_tryPush_full()
+   {  // setup
+      custom::blocking_priority_queue <int> q(2);
+      // exercise
+      bool first = q.try_push(1);
+      bool second = q.try_push(2);
+      bool third = q.try_push(3);
+      // verify
+      assertUnit(first && second && !third);
+      assertUnit(q.size() == 2);
+   }  // teardown
+
+   // push blocks on a full queue until a pop makes room
+   void test_push_waitsForRoom()
+   {  // setup
+      custom::blocking_priority_queue <int> q(1);
+      q.push(1);
+      std::atomic<bool> pushed(false);
+      std::thread producer([&]()
+      {
+         q.push(2);
+         pushed.store(true);
+      });
+      waitForProducers(q, 1);
+      bool pushedWhileFull = pushed.load();
+      // exercise
+      int value;
+      q.try_pop(value);
+      producer.join();
+      // verify
+      assertUnit(!pushedWhileFull);
+      assertUnit(pushed.load());
+      assertUnit(value == 1);
+      assertUnit(q.size() == 1);
+   }  // teardown
+
+   // pushes fail once the queue is closed, including a waiting one
+   void test_push_closed()
+   {  // setup
+      custom::blocking_priority_queue <int> q(1);
+      q.push(1);
+      std::atomic<int> result(-1);
+      std::thread producer([&]()
+      {
+         result.store(q.push(2) ? 1 : 0);
+      });
+      waitForProducers(q, 1);
+      // exercise
+      q.close();
+      producer.join();
+      // verify
+      assertUnit(result.load() == 0);
+      assertUnit(!q.try_push(3));
+      assertUnit(q.size() == 1);
+   }  // teardown
+
+   /***************************************
+    * POP
+    ***************************************/
+
+   // largest first
+   void test_tryPop_order()
+   {  // setup
+      custom::blocking_priority_queue <int> q(10);
+      int values[] = {4, 9, 1, 7};
+      for (int i = 0; i < 4; i++)
+         q.push(values[i]);
+      int value = 0;
+      // exercise
+      bool sorted = q.try_pop(value) && value == 9;
+      sorted = sorted && q.try_pop(value) && value == 7;
+      sorted = sorted && q.try_pop(value) && value == 4;
+      sorted = sorted && q.try_pop(value) && value == 1;
+      // verify
+      assertUnit(sorted);
+      assertUnit(!q.try_pop(value));
+   }  // teardown
+
+   // nothing arrives in time
+   void test_popWait_timeout()
+   {  // setup
+      custom::blocking_priority_queue <int> q(4);
+      int value = 99;
+      // exercise
+      bool popped = q.pop_wait(value, std::chrono::milliseconds(10));
+      // verify
+      assertUnit(!popped);
+      assertUnit(value == 99);
+      assertUnit(q.numWaitingConsumers == 0);
+   }  // teardown
+
+   // a waiting consumer gets the next push
+   void test_popWait_waitsForPush()
+   {  // setup
+      custom::blocking_priority_queue <int> q(4);
+      std::atomic<int> value(0);
+      std::thread consumer([&]()
+      {
+         int t;
+         if (q.pop_wait(t))
+            value.store(t);
+      });
+      waitForConsumers(q, 1);
+      // exercise
+      q.push(42);
+      consumer.join();
+      // verify
+      assertUnit(value.load() == 42);
+      assertUnit(q.empty());
+   }  // teardown
+
+   // close wakes every waiting consumer empty-handed
+   void test_popWait_closeWakes()
+   {  // setup
+      custom::blocking_priority_queue <int> q(4);
+      std::atomic<int> numFailed(0);
+      std::vector<std::thread> consumers;
+      for (int i = 0; i < 3; i++)
+         consumers.push_back(std::thread([&]()
+         {
+            int t;
+            if (!q.pop_wait(t, std::chrono::seconds(10)))
+               numFailed++;
+         }));
+      waitForConsumers(q, 3);
+      // exercise
+      q.close();
+      for (size_t i = 0; i < consumers.size(); i++)
+         consumers[i].join();
+      // verify
+      assertUnit(numFailed.load() == 3);
+   }  // teardown
+
+   // what was there before close can still be popped
+   void test_popWait_drainAfterClose()
+   {  // setup
+      custom::blocking_priority_queue <int> q(4);
+      q.push(5);
+      q.close();
+      int value = 0;
+      // exercise
+      bool first = q.pop_wait(value);
+      bool second = q.pop_wait(value);
+      // verify
+      assertUnit(first);
+      assertUnit(!second);
+      assertUnit(value == 5);
+   }  // teardown
+
+   // pop_n takes up to n, best first
+   void test_popN_standard()
+   {  // setup
+      custom::blocking_priority_queue <int> q(10);
+      for (int i = 0; i < 5; i++)
+         q.push(i);
+      custom::vector <int> out;
+      // exercise
+      size_t numTaken = q.pop_n(out, 3);
+      // verify
+      assertUnit(numTaken == 3);
+      assertUnit(out.size() == 3);
+      assertUnit(out[0] == 4 && out[1] == 3 && out[2] == 2);
+      assertUnit(q.size() == 2);
+      assertUnit(q.pop_n(out, 10) == 2);
+      assertUnit(out.size() == 5);
+   }  // teardown
+
+   // freeing two slots lets two blocked producers through
+   void test_popN_wakesProducers()
+   {  // setup
+      custom::blocking_priority_queue <int> q(2);
+      q.push(1);
+      q.push(2);
+      std::atomic<int> numPushed(0);
+      std::vector<std::thread> producers;
+      for (int i = 0; i < 2; i++)
+         producers.push_back(std::thread([&q, &numPushed, i]()
+         {
+            if (q.push(10 + i))
+               numPushed++;
+         }));
+      waitForProducers(q, 2);
+      custom::vector <int> out;
+      // exercise
+      q.pop_n(out, 2);
+      for (size_t i = 0; i < producers.size(); i++)
+         producers[i].join();
+      // verify
+      assertUnit(numPushed.load() == 2);
+      assertUnit(q.size() == 2);
+   }  // teardown
+
+   /***************************************
+    * THREADS
+    ***************************************/
+
+   // two producers through a small queue to two consumers, then close
+   void test_threads_pipeline()
+   {  // setup
+      const int numPerProducer = 2000;
+      custom::blocking_priority_queue <int> q(8);
+      std::vector<std::vector<int>> popped(2);
+      std::vector<std::thread> threads;
+      // exercise
+      for (int t = 0; t < 2; t++)
+         threads.push_back(std::thread([&q, t]()
+         {
+            for (int i = 0; i < numPerProducer; i++)
+               q.push(t * numPerProducer + i);
+         }));
+      for (int t = 0; t < 2; t++)
+         threads.push_back(std::thread([&q, &popped, t]()
+         {
+            int value;
+            while (q.pop_wait(value))
+               popped[t].push_back(value);
+         }));
+      threads[0].join();
+      threads[1].join();
+      q.close();
+      threads[2].join();
+      threads[3].join();
+      // verify
+      std::vector<int> seen(2 * numPerProducer, 0);
+      for (int t = 0; t < 2; t++)
+         for (size_t i = 0; i < popped[t].size(); i++)
+            seen[popped[t][i]]++;
+      bool once = true;
+      for (size_t i = 0; i < seen.size(); i++)
+         once = once && seen[i] == 1;
+      assertUnit(once);
+   }  // teardown
+
+   /***************************************************
+    * WAIT FOR PRODUCERS / CONSUMERS
+    * Spin until that many threads are blocked in the queue
+    ***************************************************/
+   void waitForProducers(custom::blocking_priority_queue <int> & q, size_t num)
+   {
+      for (;;)
+      {
+         {
+            std::lock_guard<std::mutex> guard(q.lock);
+            if (q.numWaitingProducers >= num)
+               return;
+         }
+         std::this_thread::yield();
+      }
+   }
+   void waitForConsumers(custom::blocking_priority_queue <int> & q, size_t num)
+   {
+      for (;;)
+      {
+         {
+            std::lock_guard<std::mutex> guard(q.lock);
+            if (q.numWaitingConsumers >= num)
+               return;
+         }
+         std::this_thread::yield();
+      }
+   }
+};
+
+#endif // DEBUG
@@ -0,0 +1,318 @@
+/***********************************************************************
+ * Header:
+ *    TEST BOUNDED PRIORITY QUEUE
+ * Summary:
+ *    Unit tests for the top-K priority queue
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "bounded_priority_queue.h"
+#include "unitTest.h"
+#include "spy.h"
+
+#include <cassert>
+#include <vector>       // for std::vector
+#include <algorithm>    // for std::sort
+#include <functional>   // for std::greater
+
+class TestBoundedPQueue : public UnitTest
+{
+
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_reserves();
+
+      // Push
+      test_push_fills();
+      test_push_keepsBest();
+      test_push_rejectOneCompare();
+      test_push_tieRejected();
+      test_push_neverGrows();
+      test_push_greater();
+      test_push_functionPointer();
+      test_push_zeroCapacity();
+      test_worst_empty();
+
+      // Extract
+      test_extractSorted_bestFirst();
+      test_extractSorted_notFull();
+      test_extractSorted_again();
+
+      // Workload
+      test_stream_matchesSort();
+
+      report("BoundedPQueue");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // all the room there will ever be, up front
+   void test_construct_reserves()
+   {  // setup
+      // exercise
+      custom::bounded_priority_queue <int> pq(5);
+      // verify
+      assertUnit(pq.empty());
+      assertUnit(!pq.full());
+      assertUnit(pq.capacity() == 5);
+      assertUnit(pq.container.capacity() == 5);
+   }  // teardown
+
+   /***************************************
+    * PUSH
+    ***************************************/
+
+   // everything is kept until it is full
+   void test_push_fills()
+   {  // setup
+      custom::bounded_priority_queue <int> pq(5);
+      // exercise
+      bool kept = pq.push(4) && pq.push(9) && pq.push(1);
+      // verify
+      assertUnit(kept);
+      assertUnit(pq.size() == 3);
+      assertUnit(!pq.full());
+      assertUnit(pq.worst() == 1);
+   }  // teardown
+
+   // once full, a better one pushes out the worst
+   void test_push_keepsBest()
+   {  // setup
+      custom::bounded_priority_queue <int> pq(3);
+      int values[] = { 5, 1, 9, 7, 3 };
+      bool kept[5];
+      // exercise
+      for (int i = 0; i < 5; i++)
+         kept[i] = pq.push(values[i]);
+      // verify
+      assertUnit(kept[0] && kept[1] && kept[2]);
+      assertUnit(kept[3]);     // 7 beats 1
+      assertUnit(!kept[4]);    // 3 does not beat 5
+      assertUnit(pq.full());
+      assertUnit(pq.worst() == 5);
+   }  // teardown
+
+   // a candidate that cannot get in costs one compare and nothing else
+   void test_push_rejectOneCompare()
+   {  // setup
+      custom::bounded_priority_queue <Spy> pq(3);
+      pq.push(Spy(5));
+      pq.push(Spy(7));
+      pq.push(Spy(9));
+      Spy s(2);
+      Spy::reset();
+      // exercise
+      bool kept = pq.push(std::move(s));
+      // verify
+      assertUnit(!kept);
+      assertUnit(Spy::numLessthan() == 1);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      assertUnit(s.get() == 2);
+      assertUnit(pq.worst().get() == 5);
+   }  // teardown
+
+   // equal to the worst is not better: the first one stays
+   void test_push_tieRejected()
+   {  // setup
+      custom::bounded_priority_queue <int> pq(2);
+      pq.push(5);
+      pq.push(8);
+      // exercise
+      bool kept = pq.push(5);
+      // verify
+      assertUnit(!kept);
+      assertUnit(pq.size() == 2);
+      assertUnit(pq.worst() == 5);
+   }  // teardown
+
+   // a long stream never moves the storage
+   void test_push_neverGrows()
+   {  // setup
+      custom::bounded_priority_queue <int> pq(4);
+      pq.push(0);
+      const int * data = &pq.container[0];
+      // exercise
+      for (int i = 0; i < 1000; i++)
+         pq.push((i * 7919) % 1000);
+      // verify
+      assertUnit(&pq.container[0] == data);
+      assertUnit(pq.container.capacity() == 4);
+      assertUnit(pq.size() == 4);
+      assertUnit(pq.worst() == 996);
+   }  // teardown
+
+   // with std::greater the smallest are kept
+   void test_push_greater()
+   {  // setup
+      custom::bounded_priority_queue <int, std::greater<int>> pq(2);
+      int values[] = { 5, 1, 9, 7, 3 };
+      // exercise
+      for (int i = 0; i < 5; i++)
+         pq.push(values[i]);
+      // verify
+      assertUnit(pq.worst() == 3);
+      custom::vector <int> sorted = pq.extract_sorted();
+      assertUnit(sorted.size() == 2);
+      if (sorted.size() == 2)
+      {
+         assertUnit(sorted[0] == 1);
+         assertUnit(sorted[1] == 3);
+      }
+   }  // teardown
+
+   static bool greaterThan(const int & lhs, const int & rhs) { return lhs > rhs; }
+
+   // a function pointer works as the comparator
+   void test_push_functionPointer()
+   {  // setup
+      custom::bounded_priority_queue <int, bool (*)(const int &, const int &)> pq(2, &greaterThan);
+      int values[] = { 5, 1, 9, 7, 3 };
+      // exercise
+      for (int i = 0; i < 5; i++)
+         pq.push(values[i]);
+      // verify
+      assertUnit(pq.worst() == 3);
+      custom::vector <int> sorted = pq.extract_sorted();
+      assertUnit(sorted.size() == 2);
+      if (sorted.size() == 2)
+      {
+         assertUnit(sorted[0] == 1);
+         assertUnit(sorted[1] == 3);
+      }
+   }  // teardown
+
+   // room for nothing keeps nothing
+   void test_push_zeroCapacity()
+   {  // setup
+      custom::bounded_priority_queue <int> pq(0);
+      // exercise
+      bool kept = pq.push(5);
+      // verify
+      assertUnit(!kept);
+      assertUnit(pq.empty());
+      assertUnit(pq.full());
+   }  // teardown
+
+   // nothing to beat yet
+   void test_worst_empty()
+   {  // setup
+      custom::bounded_priority_queue <int> pq(3);
+      // exercise
+      try
+      {
+         pq.worst();
+         // verify
+         assertUnit(false);
+      }
+      catch (const std::out_of_range & error)
+      {
+         assertUnit(error.what() == std::string("std:out_of_range"));
+      }
+   }  // teardown
+
+   /***************************************
+    * EXTRACT SORTED
+    ***************************************/
+
+   // best first, in the very storage the queue filled
+   void test_extractSorted_bestFirst()
+   {  // setup
+      custom::bounded_priority_queue <int> pq(4);
+      int values[] = { 5, 1, 9, 7, 3, 8, 2 };
+      for (int i = 0; i < 7; i++)
+         pq.push(values[i]);
+      const int * data = &pq.container[0];
+      // exercise
+      custom::vector <int> sorted = pq.extract_sorted();
+      // verify
+      assertUnit(sorted.size() == 4);
+      assertUnit(sorted.capacity() == 4);
+      assertUnit(&sorted[0] == data);
+      if (sorted.size() == 4)
+      {
+         assertUnit(sorted[0] == 9);
+         assertUnit(sorted[1] == 8);
+         assertUnit(sorted[2] == 7);
+         assertUnit(sorted[3] == 5);
+      }
+      assertUnit(pq.empty());
+      assertUnit(pq.container.capacity() == 4);
+   }  // teardown
+
+   // fewer than K come back just the same
+   void test_extractSorted_notFull()
+   {  // setup
+      custom::bounded_priority_queue <int> pq(10);
+      pq.push(2);
+      pq.push(6);
+      pq.push(4);
+      // exercise
+      custom::vector <int> sorted = pq.extract_sorted();
+      // verify
+      assertUnit(sorted.size() == 3);
+      if (sorted.size() == 3)
+      {
+         assertUnit(sorted[0] == 6);
+         assertUnit(sorted[1] == 4);
+         assertUnit(sorted[2] == 2);
+      }
+   }  // teardown
+
+   // the queue starts over after an extract
+   void test_extractSorted_again()
+   {  // setup
+      custom::bounded_priority_queue <int> pq(2);
+      pq.push(1);
+      pq.push(2);
+      pq.extract_sorted();
+      // exercise
+      pq.push(7);
+      pq.push(3);
+      pq.push(5);
+      custom::vector <int> sorted = pq.extract_sorted();
+      // verify
+      assertUnit(sorted.size() == 2);
+      if (sorted.size() == 2)
+      {
+         assertUnit(sorted[0] == 7);
+         assertUnit(sorted[1] == 5);
+      }
+   }  // teardown
+
+   /***************************************
+    * WORKLOAD
+    ***************************************/
+
+   // the best 100 of a stream, four children a node, match a full sort
+   void test_stream_matchesSort()
+   {  // setup
+      custom::bounded_priority_queue <int, std::less<int>, 4> pq(100);
+      std::vector<int> all;
+      for (int i = 0; i < 10000; i++)
+         all.push_back((int)((i * 2654435761u) % 100003));
+      // exercise
+      for (size_t i = 0; i < all.size(); i++)
+         pq.push(all[i]);
+      custom::vector <int> sorted = pq.extract_sorted();
+      // verify
+      std::sort(all.begin(), all.end(), std::greater<int>());
+      bool same = sorted.size() == 100;
+      for (size_t i = 0; same && i < 100; i++)
+         same = sorted[i] == all[i];
+      assertUnit(same);
+   }  // teardown
+};
+
+#endif // DEBUG
@@ -0,0 +1,245 @@
+/***********************************************************************
+ * Header:
+ *    TEST BUCKET QUEUE
+ * Summary:
+ *    Unit tests for the bucket queue
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "bucket_queue.h"
+#include "unitTest.h"
+
+#include <cassert>
+
+class TestBucketQueue : public UnitTest
+{
+
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+
+      // Access
+      test_top_empty();
+      test_top_standard();
+
+      // Insert
+      test_push_bitmap();
+      test_push_outOfRange();
+
+      // Remove
+      test_pop_order();
+      test_pop_fifo();
+      test_pop_unmark();
+      test_pop_compact();
+      test_pop_wide();
+
+      report("BucketQueue");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // default constructor, nothing marked
+   void test_construct_default()
+   {  // setup
+      // exercise
+      custom::bucket_queue <int> q;
+      // verify
+      assertUnit(q.empty());
+      assertUnit(q.summary == 0);
+      for (int i = 0; i < 4; i++)
+         assertUnit(q.bitmap[i] == 0);
+   }  // teardown
+
+   /***************************************
+    * TOP
+    ***************************************/
+
+   // top of an empty queue
+   void test_top_empty()
+   {  // setup
+      custom::bucket_queue <int> q;
+      bool thrown = false;
+      // exercise
+      try
+      {
+         q.top();
+      }
+      catch (const std::out_of_range &)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+   }  // teardown
+
+   // top is the oldest element of the highest priority
+   void test_top_standard()
+   {  // setup
+      custom::bucket_queue <int> q;
+      setupStandardFixture(q);
+      // exercise
+      int value = q.top();
+      // verify
+      assertUnit(value == 200);
+      assertUnit(q.top_priority() == 200);
+   }  // teardown
+
+   /***************************************
+    * PUSH
+    ***************************************/
+
+   // push sets the bucket's bit and the summary bit
+   void test_push_bitmap()
+   {  // setup
+      custom::bucket_queue <int> q;
+      // exercise
+      q.push(3, 0);
+      q.push(130, 0);
+      // verify
+      assertUnit(q.bitmap[0] == (uint64_t(1) << 3));
+      assertUnit(q.bitmap[1] == 0);
+      assertUnit(q.bitmap[2] == (uint64_t(1) << 2));
+      assertUnit(q.summary == 5);   // words 0 and 2
+      assertUnit(q.size() == 2);
+   }  // teardown
+
+   // a priority past the end is rejected
+   void test_push_outOfRange()
+   {  // setup
+      custom::bucket_queue <int> q;
+      bool thrown = false;
+      // exercise
+      try
+      {
+         q.push(256, 1);
+      }
+      catch (const std::out_of_range &)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(q.empty());
+   }  // teardown
+
+   /***************************************
+    * POP
+    ***************************************/
+
+   // highest priority first
+   void test_pop_order()
+   {  // setup
+      custom::bucket_queue <int> q;
+      setupStandardFixture(q);
+      int expected[] = {200, 70, 64, 63, 0};
+      bool sorted = true;
+      // exercise
+      for (int i = 0; i < 5; i++)
+      {
+         sorted = sorted && q.top() == expected[i];
+         q.pop();
+      }
+      // verify
+      assertUnit(sorted);
+      assertUnit(q.empty());
+   }  // teardown
+
+   // equal priorities come out in the order they went in
+   void test_pop_fifo()
+   {  // setup
+      custom::bucket_queue <int> q;
+      for (int i = 0; i < 10; i++)
+         q.push(5, i);
+      q.push(9, 99);
+      bool fifo = q.top() == 99;
+      q.pop();
+      // exercise
+      for (int i = 0; i < 10; i++)
+      {
+         fifo = fifo && q.top() == i;
+         q.pop();
+      }
+      // verify
+      assertUnit(fifo);
+   }  // teardown
+
+   // emptying a bucket clears its bits and resets it
+   void test_pop_unmark()
+   {  // setup
+      custom::bucket_queue <int> q;
+      q.push(70, 1);
+      q.push(70, 2);
+      // exercise
+      q.pop();
+      q.pop();
+      // verify
+      assertUnit(q.bitmap[1] == 0);
+      assertUnit(q.summary == 0);
+      assertUnit(q.buckets[70].head == 0);
+      assertUnit(q.buckets[70].items.size() == 0);
+   }  // teardown
+
+   // a bucket that never empties does not grow forever
+   void test_pop_compact()
+   {  // setup
+      custom::bucket_queue <int> q;
+      int next = 0;
+      for (int i = 0; i < 10; i++)
+         q.push(1, next++);
+      bool fifo = true;
+      // exercise
+      for (int i = 0; i < 1000; i++)
+      {
+         fifo = fifo && q.top() == i;
+         q.pop();
+         q.push(1, next++);
+      }
+      // verify
+      assertUnit(fifo);
+      assertUnit(q.size() == 10);
+      assertUnit(q.buckets[1].items.capacity() < 128);
+   }  // teardown
+
+   // the most priorities the summary can cover
+   void test_pop_wide()
+   {  // setup
+      custom::bucket_queue <int, 4096> q;
+      for (int i = 0; i < 4096; i += 37)
+         q.push((i * 1021) % 4096, (i * 1021) % 4096);
+      int previous = 4096;
+      bool sorted = true;
+      // exercise
+      while (!q.empty())
+      {
+         sorted = sorted && q.top() < previous;
+         previous = q.top();
+         q.pop();
+      }
+      // verify
+      assertUnit(sorted);
+      assertUnit(q.summary == 0);
+   }  // teardown
+
+   /***************************************************
+    * SETUP STANDARD FIXTURE
+    * one element in each of priorities 0, 63, 64, 70, 200
+    * and each element's value is its priority
+    ***************************************************/
+   void setupStandardFixture(custom::bucket_queue <int>& q)
+   {
+      int priorities[] = {63, 0, 200, 64, 70};
+      for (int i = 0; i < 5; i++)
+         q.push(priorities[i], priorities[i]);
+   }
+};
+
+#endif // DEBUG
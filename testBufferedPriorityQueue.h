@@ -0,0 +1,364 @@
+/***********************************************************************
+ * Header:
+ *    TEST BUFFERED PRIORITY QUEUE
+ * Summary:
+ *    Unit tests for the priority queue with thread-local push buffers
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "buffered_priority_queue.h"
+#include "unitTest.h"
+
+#include <cassert>
+#include <atomic>       // for std::atomic
+#include <thread>       // for std::thread
+#include <vector>       // for std::vector
+#include <string>       // for std::string
+#include <functional>   // for std::greater
+
+class TestBufferedPQueue : public UnitTest
+{
+
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_capacity();
+
+      // Insert
+      test_push_buffered();
+      test_push_fullMerges();
+      test_push_move();
+
+      // Remove
+      test_tryPop_empty();
+      test_tryPop_seesBuffer();
+      test_tryPop_siftUpPath();
+      test_tryPop_greater();
+      test_flush_standard();
+      test_buffer_manyQueues();
+      test_buffer_threadExit();
+      test_buffer_manyThreads();
+
+      // Threads
+      test_threads_buffersSeen();
+      test_threads_ownPush();
+      test_threads_mixed();
+
+      report("BufferedPQueue");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // the buffers hold at least one element
+   void test_construct_capacity()
+   {  // setup
+      // exercise
+      custom::buffered_priority_queue <int> q(0);
+      // verify
+      assertUnit(q.buffer_capacity() == 1);
+      assertUnit(q.empty());
+      assertUnit(q.size() == 0);
+   }  // teardown
+
+   /***************************************
+    * PUSH
+    ***************************************/
+
+   // a push below the capacity stays in the buffer
+   void test_push_buffered()
+   {  // setup
+      custom::buffered_priority_queue <int> q(8);
+      // exercise
+      q.push(5);
+      q.push(1);
+      q.push(9);
+      // verify
+      assertUnit(q.size() == 3);
+      assertUnit(q.heap.empty());
+      assertUnit(q.buffer()->numItems.load() == 3);
+      assertUnit(q.buffer()->items.size() == 3);
+   }  // teardown
+
+   // the push that fills the buffer merges it
+   void test_push_fullMerges()
+   {  // setup
+      custom::buffered_priority_queue <int> q(4);
+      q.push(3);
+      q.push(8);
+      q.push(1);
+      // exercise
+      q.push(6);
+      // verify
+      assertUnit(q.size() == 4);
+      assertUnit(q.heap.size() == 4);
+      assertUnit(q.heap.top() == 8);
+      assertUnit(q.buffer()->numItems.load() == 0);
+      assertUnit(q.buffer()->items.empty());
+   }  // teardown
+
+   // an rvalue is moved into the buffer
+   void test_push_move()
+   {  // setup
+      custom::buffered_priority_queue <std::string> q(8);
+      std::string s(100, 'x');
+      // exercise
+      q.push(std::move(s));
+      // verify
+      assertUnit(s.empty());
+      std::string top;
+      assertUnit(q.try_pop(top));
+      assertUnit(top == std::string(100, 'x'));
+   }  // teardown
+
+   /***************************************
+    * POP
+    ***************************************/
+
+   // nothing anywhere
+   void test_tryPop_empty()
+   {  // setup
+      custom::buffered_priority_queue <int> q;
+      int value = 99;
+      // exercise
+      bool popped = q.try_pop(value);
+      // verify
+      assertUnit(!popped);
+      assertUnit(value == 99);
+   }  // teardown
+
+   // a pop merges the buffer and gets the true maximum
+   void test_tryPop_seesBuffer()
+   {  // setup
+      custom::buffered_priority_queue <int> q(100);
+      int values[] = {4, 9, 1, 7, 3};
+      for (int i = 0; i < 5; i++)
+         q.push(values[i]);
+      int value = 0;
+      // exercise
+      bool popped = q.try_pop(value);
+      // verify
+      assertUnit(popped);
+      assertUnit(value == 9);
+      assertUnit(q.buffer()->numItems.load() == 0);
+      assertUnit(q.heap.size() == 4);
+      assertUnit(q.size() == 4);
+   }  // teardown
+
+   // a small batch into a big heap is sifted up, still in order
+   void test_tryPop_siftUpPath()
+   {  // setup
+      custom::buffered_priority_queue <int> q(1000);
+      for (int i = 0; i < 100; i++)
+         q.push(i * 2);
+      q.flush();
+      q.push(51);
+      q.push(201);
+      q.push(-1);
+      // exercise
+      std::vector<int> popped;
+      int value;
+      while (q.try_pop(value))
+         popped.push_back(value);
+      // verify
+      assertUnit(popped.size() == 103);
+      assertUnit(popped[0] == 201);
+      bool sorted = true;
+      for (size_t i = 1; i < popped.size(); i++)
+         sorted = sorted && popped[i - 1] >= popped[i];
+      assertUnit(sorted);
+      assertUnit(q.empty());
+   }  // teardown
+
+   // with std::greater the smallest comes first
+   void test_tryPop_greater()
+   {  // setup
+      custom::buffered_priority_queue <int, std::greater<int>> q(3);
+      int values[] = {4, 9, 1, 7, 3};
+      for (int i = 0; i < 5; i++)
+         q.push(values[i]);
+      int value = 0;
+      // exercise
+      bool sorted = q.try_pop(value) && value == 1;
+      sorted = sorted && q.try_pop(value) && value == 3;
+      sorted = sorted && q.try_pop(value) && value == 4;
+      // verify
+      assertUnit(sorted);
+      assertUnit(q.size() == 2);
+   }  // teardown
+
+   // flush empties every buffer into the heap
+   void test_flush_standard()
+   {  // setup
+      custom::buffered_priority_queue <int> q(100);
+      for (int i = 0; i < 10; i++)
+         q.push(i);
+      // exercise
+      q.flush();
+      // verify
+      assertUnit(q.buffer()->numItems.load() == 0);
+      assertUnit(q.heap.size() == 10);
+      assertUnit(q.heap.top() == 9);
+      assertUnit(q.size() == 10);
+   }  // teardown
+
+   // a thread keeps its buffer however many other queues it uses
+   void test_buffer_manyQueues()
+   {  // setup
+      std::vector<custom::buffered_priority_queue <int> *> queues;
+      for (int i = 0; i < 40; i++)
+         queues.push_back(new custom::buffered_priority_queue <int>(100));
+      queues[0]->push(1);
+      // exercise
+      for (int i = 1; i < 40; i++)
+         queues[i]->push(i);
+      queues[0]->push(2);
+      // verify
+      assertUnit(queues[0]->buffer() == queues[0]->buffers);
+      assertUnit(queues[0]->buffers[0].items.size() == 2);
+      assertUnit(queues[0]->numClaimed.load() == 1);
+      // teardown
+      for (int i = 0; i < 40; i++)
+         delete queues[i];
+   }
+
+   // an exiting thread merges its buffer and frees it
+   void test_buffer_threadExit()
+   {  // setup
+      custom::buffered_priority_queue <int> q(100);
+      // exercise
+      std::thread producer([&q]()
+      {
+         for (int i = 0; i < 3; i++)
+            q.push(i);
+      });
+      producer.join();
+      // verify
+      assertUnit(q.heap.size() == 3);
+      assertUnit(q.numHeap.load() == 3);
+      assertUnit(!q.buffers[0].claimed.load());
+      assertUnit(q.buffers[0].numItems.load() == 0);
+   }  // teardown
+
+   // more threads than buffers over time, but never at once: they all reuse the first
+   void test_buffer_manyThreads()
+   {  // setup
+      custom::buffered_priority_queue <int> q(100);
+      bool allBuffered = true;
+      // exercise
+      for (int t = 0; t < 300; t++)
+      {
+         std::thread thread([&q, &allBuffered, t]()
+         {
+            allBuffered = allBuffered && q.buffer() == q.buffers;
+            q.push(t);
+         });
+         thread.join();
+      }
+      // verify
+      assertUnit(allBuffered);
+      assertUnit(q.numClaimed.load() == 1);
+      assertUnit(q.size() == 300);
+      assertUnit(q.heap.size() == 300);
+   }  // teardown
+
+   /***************************************
+    * THREADS
+    ***************************************/
+
+   // every thread's buffer is merged before the first pop
+   void test_threads_buffersSeen()
+   {  // setup
+      custom::buffered_priority_queue <int> q(1000);
+      std::vector<std::thread> threads;
+      for (int t = 0; t < 4; t++)
+         threads.push_back(std::thread([&q, t]()
+         {
+            for (int i = 0; i < 100; i++)
+               q.push(i * 4 + t);
+         }));
+      for (size_t t = 0; t < threads.size(); t++)
+         threads[t].join();
+      // exercise
+      std::vector<int> popped;
+      int value;
+      while (q.try_pop(value))
+         popped.push_back(value);
+      // verify
+      assertUnit(popped.size() == 400);
+      bool exact = popped.size() == 400;
+      for (size_t i = 0; exact && i < popped.size(); i++)
+         exact = popped[i] == 399 - (int)i;
+      assertUnit(exact);
+   }  // teardown
+
+   // a thread always finds what it just pushed
+   void test_threads_ownPush()
+   {  // setup
+      custom::buffered_priority_queue <int> q(16);
+      std::atomic<int> numMissed(0);
+      std::vector<std::thread> threads;
+      // exercise
+      for (int t = 0; t < 4; t++)
+         threads.push_back(std::thread([&q, &numMissed]()
+         {
+            int value;
+            for (int i = 0; i < 2000; i++)
+            {
+               q.push(i);
+               if (!q.try_pop(value))
+                  numMissed++;
+            }
+         }));
+      for (size_t t = 0; t < threads.size(); t++)
+         threads[t].join();
+      // verify
+      assertUnit(numMissed.load() == 0);
+      assertUnit(q.empty());
+   }  // teardown
+
+   // pushers and poppers together: everything comes out once
+   void test_threads_mixed()
+   {  // setup
+      const int numPerThread = 3000;
+      custom::buffered_priority_queue <int> q(32);
+      std::vector<std::vector<int>> popped(4);
+      std::vector<std::thread> threads;
+      // exercise
+      for (int t = 0; t < 4; t++)
+         threads.push_back(std::thread([&q, &popped, t]()
+         {
+            int value;
+            for (int i = 0; i < numPerThread; i++)
+            {
+               q.push(t * numPerThread + i);
+               if (i % 3 == 0 && q.try_pop(value))
+                  popped[t].push_back(value);
+            }
+         }));
+      for (size_t t = 0; t < threads.size(); t++)
+         threads[t].join();
+      int value;
+      while (q.try_pop(value))
+         popped[0].push_back(value);
+      // verify
+      std::vector<int> seen(4 * numPerThread, 0);
+      for (int t = 0; t < 4; t++)
+         for (size_t i = 0; i < popped[t].size(); i++)
+            seen[popped[t][i]]++;
+      bool once = true;
+      for (size_t i = 0; i < seen.size(); i++)
+         once = once && seen[i] == 1;
+      assertUnit(once);
+      assertUnit(q.size() == 0);
+   }  // teardown
+};
+
+#endif // DEBUG
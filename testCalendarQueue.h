@@ -0,0 +1,265 @@
+/***********************************************************************
+ * Header:
+ *    TEST CALENDAR QUEUE
+ * Summary:
+ *    Unit tests for the calendar queue
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "calendar_queue.h"
+#include "unitTest.h"
+
+#include <cassert>
+
+class TestCalendarQueue : public UnitTest
+{
+
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+
+      // Access
+      test_top_empty();
+      test_top_standard();
+
+      // Insert
+      test_push_sorted();
+      test_push_earlier();
+      test_push_grow();
+
+      // Remove
+      test_pop_standard();
+      test_pop_ties();
+      test_pop_shrink();
+      test_pop_sparse();
+      test_pop_hold();
+
+      report("CalendarQueue");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // default constructor, the smallest calendar
+   void test_construct_default()
+   {  // setup
+      // exercise
+      custom::calendar_queue <double> q;
+      // verify
+      assertUnit(q.empty());
+      assertUnit(q.buckets.size() == 4);
+      assertUnit(q.width == 1.0);
+   }  // teardown
+
+   /***************************************
+    * TOP
+    ***************************************/
+
+   // top of an empty queue
+   void test_top_empty()
+   {  // setup
+      custom::calendar_queue <double> q;
+      bool thrown = false;
+      // exercise
+      try
+      {
+         q.top();
+      }
+      catch (const std::out_of_range &)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+   }  // teardown
+
+   // top is the earliest
+   void test_top_standard()
+   {  // setup
+      custom::calendar_queue <double> q;
+      setupStandardFixture(q);
+      // exercise
+      double value = q.top();
+      // verify
+      assertUnit(value == 0.5);
+   }  // teardown
+
+   /***************************************
+    * PUSH
+    ***************************************/
+
+   // each bucket is kept latest-first
+   void test_push_sorted()
+   {  // setup
+      custom::calendar_queue <double> q;
+      // exercise
+      q.push(1.25);
+      q.push(5.5);
+      q.push(1.75);
+      // verify
+      //  days are 1.0 wide and there are 4 of them: 1.25, 5.5 and 1.75 share day 1
+      assertUnit(q.buckets[1].size() == 3);
+      if (q.buckets[1].size() == 3)
+      {
+         assertUnit(q.buckets[1][0] == 5.5);
+         assertUnit(q.buckets[1][1] == 1.75);
+         assertUnit(q.buckets[1][2] == 1.25);
+      }
+   }  // teardown
+
+   // an event before the current day moves the current day back
+   void test_push_earlier()
+   {  // setup
+      custom::calendar_queue <double> q;
+      q.push(3.5);
+      q.push(2.5);
+      q.pop();
+      // exercise
+      q.push(0.25);
+      // verify
+      assertUnit(q.dayCurrent == 0);
+      assertUnit(q.top() == 0.25);
+   }  // teardown
+
+   // more than two events per day doubles the days
+   void test_push_grow()
+   {  // setup
+      custom::calendar_queue <double> q;
+      for (int i = 0; i < 8; i++)
+         q.push(i * 0.1);
+      // exercise
+      q.push(0.8);
+      // verify
+      assertUnit(q.buckets.size() == 8);
+      assertUnit(q.size() == 9);
+      assertUnit(q.width > 0.25 && q.width < 0.35);   // three times the 0.1 spacing
+   }  // teardown
+
+   /***************************************
+    * POP
+    ***************************************/
+
+   // pop the standard fixture in order
+   void test_pop_standard()
+   {  // setup
+      custom::calendar_queue <double> q;
+      setupStandardFixture(q);
+      double expected[] = {0.5, 1.0, 2.25, 7.0, 40.0, 1000.5};
+      bool sorted = true;
+      // exercise
+      for (int i = 0; i < 6; i++)
+      {
+         sorted = sorted && q.top() == expected[i];
+         q.pop();
+      }
+      // verify
+      assertUnit(sorted);
+      assertUnit(q.empty());
+   }  // teardown
+
+   // equal timestamps come out in push order
+   void test_pop_ties()
+   {  // setup
+      custom::calendar_queue <Event, EventTime> q;
+      for (int i = 0; i < 5; i++)
+         q.push(Event{2.0, i});
+      q.push(Event{1.0, 99});
+      bool fifo = q.top().id == 99;
+      q.pop();
+      // exercise
+      for (int i = 0; i < 5; i++)
+      {
+         fifo = fifo && q.top().id == i;
+         q.pop();
+      }
+      // verify
+      assertUnit(fifo);
+   }  // teardown
+
+   // the calendar shrinks as it empties
+   void test_pop_shrink()
+   {  // setup
+      custom::calendar_queue <double> q;
+      for (int i = 0; i < 100; i++)
+         q.push(i * 1.5);
+      size_t numBuckets = q.buckets.size();
+      // exercise
+      for (int i = 0; i < 95; i++)
+         q.pop();
+      // verify
+      assertUnit(numBuckets >= 64);
+      assertUnit(q.buckets.size() < numBuckets);
+      assertUnit(q.top() == 95 * 1.5);
+   }  // teardown
+
+   // events years apart need the direct search
+   void test_pop_sparse()
+   {  // setup
+      custom::calendar_queue <double> q;
+      q.push(1.0e6);
+      q.push(3.0);
+      q.push(2.0e9);
+      // exercise
+      q.pop();
+      // verify
+      assertUnit(q.top() == 1.0e6);
+      q.pop();
+      assertUnit(q.top() == 2.0e9);
+   }  // teardown
+
+   // the classic hold model: pop one, push one a random time later
+   void test_pop_hold()
+   {  // setup
+      custom::calendar_queue <double> q;
+      for (int i = 0; i < 1000; i++)
+         q.push((i * 7919) % 1000 * 0.01);
+      double previous = 0.0;
+      bool sorted = true;
+      // exercise
+      for (int i = 0; i < 20000; i++)
+      {
+         double now = q.top();
+         sorted = sorted && previous <= now;
+         previous = now;
+         q.pop();
+         q.push(now + (i * 104729) % 997 * 0.01);
+      }
+      // verify
+      assertUnit(sorted);
+      assertUnit(q.size() == 1000);
+   }  // teardown
+
+   /***************************************************
+    * EVENT
+    * A timed event with an ID so ties can be told apart
+    ***************************************************/
+   struct Event
+   {
+      double time;
+      int    id;
+   };
+   struct EventTime
+   {
+      double operator()(const Event & e) const { return e.time; }
+   };
+
+   /***************************************************
+    * SETUP STANDARD FIXTURE
+    ***************************************************/
+   void setupStandardFixture(custom::calendar_queue <double>& q)
+   {
+      double times[] = {7.0, 1.0, 1000.5, 0.5, 40.0, 2.25};
+      for (int i = 0; i < 6; i++)
+         q.push(times[i]);
+   }
+};
+
+#endif // DEBUG
@@ -0,0 +1,262 @@
+/***********************************************************************
+ * Header:
+ *    TEST COMBINING PRIORITY QUEUE
+ * Summary:
+ *    Unit tests for the flat-combining priority queue
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "combining_priority_queue.h"
+#include "unitTest.h"
+#include "testConcurrent.h"
+
+#include <cassert>
+#include <thread>    // for std::thread
+
+class TestCombiningPQueue : public UnitTest
+{
+
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+
+      // Insert
+      test_push_standard();
+
+      // Remove
+      test_tryPop_empty();
+      test_tryPop_order();
+
+      // Combine
+      test_combine_fromBatch();
+      test_combine_fromHeap();
+      test_combine_heapify();
+      test_combine_popEmpty();
+
+      // Threads
+      test_threads_producersConsumers();
+      test_threads_servedByCombiner();
+
+      report("CombiningPQueue");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // every slot free, nothing in the heap
+   void test_construct_default()
+   {  // setup
+      // exercise
+      custom::combining_priority_queue <int> q;
+      // verify
+      assertUnit(q.empty());
+      assertUnit(q.heap.empty());
+      bool allFree = true;
+      for (int i = 0; i < 64; i++)
+         allFree = allFree && q.slots[i].state.load() == 0;
+      assertUnit(allFree);
+   }  // teardown
+
+   /***************************************
+    * PUSH
+    ***************************************/
+
+   // a lone push combines itself and frees its slot
+   void test_push_standard()
+   {  // setup
+      custom::combining_priority_queue <int> q;
+      // exercise
+      q.push(5);
+      // verify
+      assertUnit(q.size() == 1);
+      assertUnit(q.heap.top() == 5);
+      bool allFree = true;
+      for (int i = 0; i < 64; i++)
+         allFree = allFree && q.slots[i].state.load() == 0;
+      assertUnit(allFree);
+   }  // teardown
+
+   /***************************************
+    * TRY POP
+    ***************************************/
+
+   // nothing to pop
+   void test_tryPop_empty()
+   {  // setup
+      custom::combining_priority_queue <int> q;
+      int value = 99;
+      // exercise
+      bool popped = q.try_pop(value);
+      // verify
+      assertUnit(!popped);
+      assertUnit(value == 99);
+   }  // teardown
+
+   // an exact priority queue
+   void test_tryPop_order()
+   {  // setup
+      custom::combining_priority_queue <int> q;
+      for (int i = 0; i < 300; i++)
+         q.push((i * 97) % 300);
+      bool sorted = true;
+      int value;
+      // exercise
+      for (int i = 299; i >= 0; i--)
+         sorted = sorted && q.try_pop(value) && value == i;
+      // verify
+      assertUnit(sorted);
+      assertUnit(q.empty());
+   }  // teardown
+
+   /***************************************
+    * COMBINE
+    * Publish requests by hand, then run one batch
+    ***************************************/
+
+   // a pushed value better than the heap top goes straight to the pop
+   void test_combine_fromBatch()
+   {  // setup
+      custom::combining_priority_queue <int> q;
+      q.push(5);
+      publishPush(q, 0, 9);
+      publishPush(q, 1, 2);
+      publishPop(q, 2);
+      // exercise
+      q.combine();
+      // verify
+      assertUnit(q.slots[2].state.load() == DONE);
+      assertUnit(q.slots[2].success);
+      assertUnit(q.slots[2].value == 9);
+      assertUnit(q.heap.size() == 2);
+      assertUnit(q.heap.top() == 5);
+      assertUnit(q.size() == 2);
+   }  // teardown
+
+   // the heap top beats everything pushed in the batch
+   void test_combine_fromHeap()
+   {  // setup
+      custom::combining_priority_queue <int> q;
+      q.push(10);
+      publishPush(q, 0, 3);
+      publishPop(q, 1);
+      publishPop(q, 2);
+      // exercise
+      q.combine();
+      // verify
+      assertUnit(q.slots[1].success && q.slots[1].value == 10);
+      assertUnit(q.slots[2].success && q.slots[2].value == 3);
+      assertUnit(q.heap.empty());
+   }  // teardown
+
+   // a batch bigger than the heap goes in with one heapify
+   void test_combine_heapify()
+   {  // setup
+      custom::combining_priority_queue <int> q;
+      q.push(4);
+      for (int i = 0; i < 10; i++)
+         publishPush(q, i, (i * 7) % 10);
+      // exercise
+      q.combine();
+      // verify
+      assertUnit(q.heap.size() == 11);
+      assertUnit(q.heap.top() == 9);
+      bool done = true;
+      for (int i = 0; i < 10; i++)
+         done = done && q.slots[i].state.load() == DONE;
+      assertUnit(done);
+   }  // teardown
+
+   // more pops than elements: the extra ones fail
+   void test_combine_popEmpty()
+   {  // setup
+      custom::combining_priority_queue <int> q;
+      publishPush(q, 0, 1);
+      publishPop(q, 1);
+      publishPop(q, 2);
+      // exercise
+      q.combine();
+      // verify
+      assertUnit(q.slots[1].success && q.slots[1].value == 1);
+      assertUnit(!q.slots[2].success);
+      assertUnit(q.slots[2].state.load() == DONE);
+   }  // teardown
+
+   /***************************************
+    * THREADS
+    ***************************************/
+
+   // four producers and four consumers: nothing lost, nothing twice
+   void test_threads_producersConsumers()
+   {  // setup
+      custom::combining_priority_queue <int> q;
+      // exercise
+      bool once = producersConsumers(q, 4, 5000);
+      // verify
+      assertUnit(once);
+      assertUnit(q.empty());
+   }  // teardown
+
+   // with the lock held elsewhere, a waiting push and pop are served by that thread's combine
+   void test_threads_servedByCombiner()
+   {  // setup
+      custom::combining_priority_queue <int> q;
+      q.lock.lock();
+      int value = 0;
+      bool success = false;
+      // exercise
+      std::thread pusher([&q]() { q.push(26); });
+      int indexPush = waitForState(q, custom::combining_priority_queue <int>::PUSH);
+      q.combine();
+      pusher.join();
+      std::thread popper([&q, &value, &success]() { success = q.try_pop(value); });
+      int indexPop = waitForState(q, custom::combining_priority_queue <int>::POP);
+      q.combine();
+      popper.join();
+      q.lock.unlock();
+      // verify
+      assertUnit(success);
+      assertUnit(value == 26);
+      assertUnit(q.empty());
+      assertUnit(q.heap.empty());
+      assertUnit(q.slots[indexPush].state.load() == FREE);
+      assertUnit(q.slots[indexPop].state.load() == FREE);
+   }  // teardown
+
+   /***************************************************
+    * PUBLISH
+    * Fill a slot the way push and try_pop do
+    ***************************************************/
+   enum { FREE = custom::combining_priority_queue <int>::FREE,
+          DONE = custom::combining_priority_queue <int>::DONE };
+   void publishPush(custom::combining_priority_queue <int> & q, int index, int value)
+   {
+      q.slots[index].value = value;
+      q.slots[index].state.store(custom::combining_priority_queue <int>::PUSH);
+   }
+   void publishPop(custom::combining_priority_queue <int> & q, int index)
+   {
+      q.slots[index].state.store(custom::combining_priority_queue <int>::POP);
+   }
+
+   // spin until another thread has published state in some slot; return that slot
+   int waitForState(custom::combining_priority_queue <int> & q, int state)
+   {
+      for (;;)
+      {
+         for (int i = 0; i < custom::combining_priority_queue <int>::NUM_SLOTS; i++)
+            if (q.slots[i].state.load() == state)
+               return i;
+         std::this_thread::yield();
+      }
+   }
+};
+
+#endif // DEBUG
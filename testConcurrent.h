@@ -0,0 +1,59 @@
+/***********************************************************************
+ * Header:
+ *    TEST CONCURRENT
+ * Summary:
+ *    Checks shared by the unit tests of the concurrent priority queues
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include <atomic>    // for std::atomic
+#include <thread>    // for std::thread
+#include <vector>    // for std::vector
+
+/***************************************************
+ * PRODUCERS CONSUMERS
+ * numThreads producers push numPerThread distinct
+ * values each while numThreads consumers try_pop until
+ * every value has been taken. TRUE when nothing was
+ * lost and nothing was popped twice.
+ ***************************************************/
+template <class Queue>
+bool producersConsumers(Queue & q, int numThreads, int numPerThread)
+{
+   std::atomic<int> numPopped(0);
+   std::vector<std::vector<int>> popped(numThreads);
+   std::vector<std::thread> threads;
+   for (int t = 0; t < numThreads; t++)
+      threads.push_back(std::thread([&q, numPerThread, t]()
+      {
+         for (int i = 0; i < numPerThread; i++)
+            q.push(t * numPerThread + i);
+      }));
+   for (int t = 0; t < numThreads; t++)
+      threads.push_back(std::thread([&q, &numPopped, &popped, numThreads, numPerThread, t]()
+      {
+         int value;
+         while (numPopped.load() < numThreads * numPerThread)
+            if (q.try_pop(value))
+            {
+               popped[t].push_back(value);
+               numPopped++;
+            }
+      }));
+   for (size_t i = 0; i < threads.size(); i++)
+      threads[i].join();
+
+   std::vector<int> seen(numThreads * numPerThread, 0);
+   for (int t = 0; t < numThreads; t++)
+      for (size_t i = 0; i < popped[t].size(); i++)
+         seen[popped[t][i]]++;
+   bool once = true;
+   for (size_t i = 0; i < seen.size(); i++)
+      once = once && seen[i] == 1;
+   return once;
+}
+
+#endif // DEBUG
@@ -0,0 +1,286 @@
+/***********************************************************************
+ * Header:
+ *    TEST INDEXED PRIORITY QUEUE
+ * Summary:
+ *    Unit tests for the indexed priority queue
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "indexed_priority_queue.h"
+#include "unitTest.h"
+
+#include <cassert>
+
+class TestIndexedPQueue : public UnitTest
+{
+
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_numIDs();
+
+      // Insert
+      test_push_standard();
+      test_push_grow();
+      test_push_duplicate();
+
+      // Update
+      test_change_up();
+      test_change_down();
+
+      // Remove
+      test_pop_standard();
+      test_remove_middle();
+      test_remove_missing();
+      test_clear_standard();
+
+      // Workload
+      test_dijkstra_order();
+
+      report("IndexedPQueue");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // the ID tables are sized once up front
+   void test_construct_numIDs()
+   {  // setup
+      // exercise
+      custom::indexed_priority_queue <int> pq(100);
+      // verify
+      assertUnit(pq.empty());
+      assertUnit(pq.positions.size() == 100);
+      assertUnit(pq.priorities.size() == 100);
+      assertUnit(pq.heap.capacity() == 100);
+      assertUnit(!pq.contains(0));
+      assertUnit(!pq.contains(99));
+   }  // teardown
+
+   /***************************************
+    * PUSH
+    ***************************************/
+
+   // push the standard fixture
+   void test_push_standard()
+   {  // setup
+      custom::indexed_priority_queue <int> pq(7);
+      // exercise
+      setupStandardFixture(pq);
+      // verify
+      assertUnit(pq.size() == 7);
+      assertUnit(pq.top() == 0);
+      assertUnit(pq.top_priority() == 10);
+      assertUnit(pq.priority(3) == 4);
+      assertHeapParameters(pq, __LINE__, __FUNCTION__);
+   }  // teardown
+
+   // an ID past the end grows the tables
+   void test_push_grow()
+   {  // setup
+      custom::indexed_priority_queue <int> pq;
+      // exercise
+      pq.push(42, 5);
+      // verify
+      assertUnit(pq.contains(42));
+      assertUnit(pq.positions.size() >= 43);
+      assertUnit(pq.top() == 42);
+   }  // teardown
+
+   // pushing an ID that is already present is an error
+   void test_push_duplicate()
+   {  // setup
+      custom::indexed_priority_queue <int> pq(7);
+      setupStandardFixture(pq);
+      bool thrown = false;
+      // exercise
+      try
+      {
+         pq.push(2, 1);
+      }
+      catch (const std::invalid_argument &)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(pq.priority(2) == 9);
+      assertUnit(pq.size() == 7);
+   }  // teardown
+
+   /***************************************
+    * CHANGE
+    ***************************************/
+
+   // raise the priority of a leaf to the top
+   void test_change_up()
+   {  // setup
+      custom::indexed_priority_queue <int> pq(7);
+      setupStandardFixture(pq);
+      // exercise
+      pq.change(4, 11);
+      // verify
+      assertUnit(pq.top() == 4);
+      assertUnit(pq.top_priority() == 11);
+      assertHeapParameters(pq, __LINE__, __FUNCTION__);
+   }  // teardown
+
+   // drop the priority of the top to the bottom
+   void test_change_down()
+   {  // setup
+      custom::indexed_priority_queue <int> pq(7);
+      setupStandardFixture(pq);
+      // exercise
+      pq.change(0, 1);
+      // verify
+      assertUnit(pq.top() == 2);
+      assertUnit(pq.priority(0) == 1);
+      assertHeapParameters(pq, __LINE__, __FUNCTION__);
+   }  // teardown
+
+   /***************************************
+    * POP and REMOVE
+    ***************************************/
+
+   // pop comes out in priority order
+   void test_pop_standard()
+   {  // setup
+      custom::indexed_priority_queue <int> pq(7);
+      setupStandardFixture(pq);
+      size_t expected[] = {0, 2, 1, 5, 6, 3, 4};
+      bool sorted = true;
+      // exercise
+      for (int i = 0; i < 7; i++)
+      {
+         sorted = sorted && pq.top() == expected[i];
+         pq.pop();
+         sorted = sorted && !pq.contains(expected[i]);
+      }
+      // verify
+      assertUnit(sorted);
+      assertUnit(pq.empty());
+   }  // teardown
+
+   // remove from the middle of the heap
+   void test_remove_middle()
+   {  // setup
+      custom::indexed_priority_queue <int> pq(7);
+      setupStandardFixture(pq);
+      // exercise
+      pq.remove(1);
+      // verify
+      assertUnit(!pq.contains(1));
+      assertUnit(pq.size() == 6);
+      assertHeapParameters(pq, __LINE__, __FUNCTION__);
+   }  // teardown
+
+   // remove an ID that is not there
+   void test_remove_missing()
+   {  // setup
+      custom::indexed_priority_queue <int> pq(7);
+      setupStandardFixture(pq);
+      pq.remove(1);
+      bool thrown = false;
+      // exercise
+      try
+      {
+         pq.remove(1);
+      }
+      catch (const std::out_of_range &)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(pq.size() == 6);
+   }  // teardown
+
+   // clear forgets every ID but keeps the tables
+   void test_clear_standard()
+   {  // setup
+      custom::indexed_priority_queue <int> pq(7);
+      setupStandardFixture(pq);
+      // exercise
+      pq.clear();
+      // verify
+      assertUnit(pq.empty());
+      for (size_t id = 0; id < 7; id++)
+         assertUnit(!pq.contains(id));
+      assertUnit(pq.positions.size() == 7);
+   }  // teardown
+
+   /***************************************
+    * WORKLOAD
+    ***************************************/
+
+   // shortest paths on a small grid with a min-heap
+   void test_dijkstra_order()
+   {  // setup
+      //  a 10x10 grid where moving right costs 1 and down costs 2
+      const size_t width = 10;
+      custom::indexed_priority_queue <int, std::greater<int>> pq(width * width);
+      int distance[width * width];
+      for (size_t id = 0; id < width * width; id++)
+         distance[id] = 1000000;
+      distance[0] = 0;
+      pq.push(0, 0);
+      // exercise
+      while (!pq.empty())
+      {
+         size_t id = pq.top();
+         pq.pop();
+         size_t next[2] = {id % width + 1 < width ? id + 1 : id, id + width < width * width ? id + width : id};
+         int cost[2] = {1, 2};
+         for (int i = 0; i < 2; i++)
+            if (next[i] != id && distance[id] + cost[i] < distance[next[i]])
+            {
+               distance[next[i]] = distance[id] + cost[i];
+               if (pq.contains(next[i]))
+                  pq.change(next[i], distance[next[i]]);
+               else
+                  pq.push(next[i], distance[next[i]]);
+            }
+      }
+      // verify
+      bool correct = true;
+      for (size_t id = 0; id < width * width; id++)
+         correct = correct && distance[id] == int(id % width + 2 * (id / width));
+      assertUnit(correct);
+   }  // teardown
+
+   /***************************************************
+    * SETUP STANDARD FIXTURE
+    *   ID:        0   1   2   3   4   5   6
+    *   priority: 10   8   9   4   3   7   5
+    ***************************************************/
+   void setupStandardFixture(custom::indexed_priority_queue <int>& pq)
+   {
+      int priorities[] = {10, 8, 9, 4, 3, 7, 5};
+      for (size_t id = 0; id < 7; id++)
+         pq.push(id, priorities[id]);
+   }
+
+   /***************************************************
+    * VERIFY HEAP
+    * The heap is in order and the position table agrees
+    ***************************************************/
+   void assertHeapParameters(const custom::indexed_priority_queue <int>& pq,
+                             int line, const char* function)
+   {
+      for (size_t i = 1; i <= pq.heap.size(); i++)
+      {
+         assertIndirect(pq.positions[pq.heap[i - 1]] == i);
+         if (i > 1)
+            assertIndirect(pq.at((i - 2) / 2 + 1) >= pq.at(i));
+      }
+   }
+};
+
+#endif // DEBUG
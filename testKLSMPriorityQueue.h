@@ -0,0 +1,362 @@
+/***********************************************************************
+ * Header:
+ *    TEST K-LSM PRIORITY QUEUE
+ * Summary:
+ *    Unit tests for the LSM runs and the k-relaxed priority queue
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "klsm_priority_queue.h"
+#include "unitTest.h"
+#include "testConcurrent.h"
+
+#include <cassert>
+#include <thread>    // for std::thread
+#include <vector>    // for std::vector
+#include <atomic>    // for std::atomic
+
+class TestKLSMPQueue : public UnitTest
+{
+
+public:
+   void run()
+   {
+      reset();
+
+      // LSM runs
+      test_runs_pushMerges();
+      test_runs_popOrder();
+      test_runs_popRebalance();
+      test_runs_takeAll();
+
+      // Queue
+      test_push_local();
+      test_push_flush();
+      test_push_kZero();
+      test_tryPop_empty();
+      test_tryPop_singleThreadExact();
+      test_tryPop_steal();
+      test_tryPop_rankBound();
+      test_local_manyQueues();
+      test_local_threadExit();
+      test_local_manyThreads();
+
+      // Threads
+      test_threads_producersConsumers();
+      test_threads_stealFromLive();
+
+      report("KLSMPQueue");
+   }
+
+   /***************************************
+    * LSM RUNS
+    ***************************************/
+
+   // runs stay in strictly falling sizes: 7 elements are runs of 4, 2, 1
+   void test_runs_pushMerges()
+   {  // setup
+      custom::lsm_runs <int> runs;
+      // exercise
+      for (int i = 0; i < 7; i++)
+         runs.push(i);
+      // verify
+      assertUnit(runs.size() == 7);
+      assertUnit(runs.runs.size() == 3);
+      assertUnit(runs.runs[0].size() == 4);
+      assertUnit(runs.runs[1].size() == 2);
+      assertUnit(runs.runs[2].size() == 1);
+      bool sorted = true;
+      for (size_t i = 1; i < runs.runs[0].size(); i++)
+         sorted = sorted && runs.runs[0][i - 1] <= runs.runs[0][i];
+      assertUnit(sorted);
+   }  // teardown
+
+   // the best back comes out first
+   void test_runs_popOrder()
+   {  // setup
+      custom::lsm_runs <int> runs;
+      for (int i = 0; i < 100; i++)
+         runs.push((i * 37) % 100);
+      bool sorted = true;
+      // exercise
+      for (int i = 99; i >= 0; i--)
+      {
+         sorted = sorted && runs.top() == i;
+         runs.pop();
+      }
+      // verify
+      assertUnit(sorted);
+      assertUnit(runs.empty());
+   }  // teardown
+
+   // a run that shrinks to the size of the next is merged with it
+   void test_runs_popRebalance()
+   {  // setup
+      custom::lsm_runs <int> runs;
+      runs.push(10);
+      runs.push(11);   // one run {10, 11}
+      runs.push(1);    // and a run {1}
+      // exercise
+      runs.pop();      // 11 leaves {10}, no bigger than {1}
+      // verify
+      assertUnit(runs.runs.size() == 1);
+      assertUnit(runs.runs[0].size() == 2);
+      assertUnit(runs.top() == 10);
+      assertUnit(runs.size() == 2);
+   }  // teardown
+
+   // take_all gives one sorted run
+   void test_runs_takeAll()
+   {  // setup
+      custom::lsm_runs <int> runs;
+      for (int i = 0; i < 11; i++)
+         runs.push((i * 7) % 11);
+      // exercise
+      custom::vector <int> all = runs.take_all();
+      // verify
+      assertUnit(runs.empty());
+      assertUnit(all.size() == 11);
+      bool sorted = true;
+      for (int i = 0; i < 11; i++)
+         sorted = sorted && all[i] == i;
+      assertUnit(sorted);
+   }  // teardown
+
+   /***************************************
+    * QUEUE
+    ***************************************/
+
+   // up to k elements stay with the thread
+   void test_push_local()
+   {  // setup
+      custom::klsm_priority_queue <int> q(4);
+      // exercise
+      for (int i = 0; i < 4; i++)
+         q.push(i);
+      // verify
+      assertUnit(q.local()->runs.size() == 4);
+      assertUnit(q.shared.empty());
+      assertUnit(q.size() == 4);
+   }  // teardown
+
+   // one more than k sends them all to the shared part as one run
+   void test_push_flush()
+   {  // setup
+      custom::klsm_priority_queue <int> q(4);
+      uint64_t version = q.sharedVersion.load();
+      // exercise
+      for (int i = 0; i < 5; i++)
+         q.push(i);
+      // verify
+      assertUnit(q.local()->runs.empty());
+      assertUnit(q.shared.size() == 5);
+      assertUnit(q.shared.runs.size() == 1);
+      assertUnit(q.sharedVersion.load() == version + 1);
+   }  // teardown
+
+   // with k = 0 nothing is kept locally
+   void test_push_kZero()
+   {  // setup
+      custom::klsm_priority_queue <int> q(0);
+      // exercise
+      q.push(3);
+      // verify
+      assertUnit(q.local()->runs.empty());
+      assertUnit(q.shared.size() == 1);
+   }  // teardown
+
+   // nothing to pop
+   void test_tryPop_empty()
+   {  // setup
+      custom::klsm_priority_queue <int> q(4);
+      int value = 99;
+      // exercise
+      bool popped = q.try_pop(value);
+      // verify
+      assertUnit(!popped);
+      assertUnit(value == 99);
+   }  // teardown
+
+   // one thread sees everything, so the order is exact
+   void test_tryPop_singleThreadExact()
+   {  // setup
+      custom::klsm_priority_queue <int> q(8);
+      for (int i = 0; i < 300; i++)
+         q.push((i * 97) % 300);
+      bool sorted = true;
+      int value;
+      // exercise
+      for (int i = 299; i >= 0; i--)
+         sorted = sorted && q.try_pop(value) && value == i;
+      // verify
+      assertUnit(sorted);
+      assertUnit(q.empty());
+   }  // teardown
+
+   // elements left in another thread's local runs are not lost
+   void test_tryPop_steal()
+   {  // setup
+      custom::klsm_priority_queue <int> q(16);
+      std::thread producer([&q]()
+      {
+         for (int i = 0; i < 10; i++)
+            q.push(i);
+      });
+      producer.join();
+      int value;
+      // exercise
+      bool popped = q.try_pop(value);
+      // verify
+      assertUnit(popped);
+      assertUnit(value == 9);
+      assertUnit(q.size() == 9);
+   }  // teardown
+
+   // with three producers done, a pop is never worse than rank 3k
+   void test_tryPop_rankBound()
+   {  // setup
+      const int k = 8;
+      const int numProducers = 3;
+      const int num = 600;
+      custom::klsm_priority_queue <int> q(k);
+      std::vector<std::thread> producers;
+      for (int t = 0; t < numProducers; t++)
+         producers.push_back(std::thread([&q, t]()
+         {
+            for (int i = t; i < num; i += numProducers)
+               q.push((i * 211) % num);
+         }));
+      for (int t = 0; t < numProducers; t++)
+         producers[t].join();
+      std::vector<bool> present(num, true);
+      int maxRank = 0;
+      int value;
+      // exercise
+      while (q.try_pop(value))
+      {
+         int rank = 0;
+         for (int i = value + 1; i < num; i++)
+            rank += present[i];
+         present[value] = false;
+         maxRank = rank > maxRank ? rank : maxRank;
+      }
+      // verify
+      assertUnit(maxRank <= k * numProducers);
+      bool none = true;
+      for (int i = 0; i < num; i++)
+         none = none && !present[i];
+      assertUnit(none);
+   }  // teardown
+
+   // a thread keeps its Local however many other queues it uses
+   void test_local_manyQueues()
+   {  // setup
+      std::vector<custom::klsm_priority_queue <int> *> queues;
+      for (int i = 0; i < 40; i++)
+         queues.push_back(new custom::klsm_priority_queue <int>(4));
+      queues[0]->push(1);
+      // exercise
+      for (int i = 1; i < 40; i++)
+         queues[i]->push(i);
+      queues[0]->push(2);
+      // verify
+      assertUnit(queues[0]->local() == queues[0]->locals);
+      assertUnit(queues[0]->locals[0].runs.size() == 2);
+      assertUnit(!queues[0]->locals[1].claimed.load());
+      // teardown
+      for (int i = 0; i < 40; i++)
+         delete queues[i];
+   }
+
+   // an exiting thread hands its elements to the shared part and frees its Local
+   void test_local_threadExit()
+   {  // setup
+      custom::klsm_priority_queue <int> q(16);
+      // exercise
+      std::thread producer([&q]()
+      {
+         for (int i = 0; i < 3; i++)
+            q.push(i);
+      });
+      producer.join();
+      // verify
+      assertUnit(q.shared.size() == 3);
+      assertUnit(q.size() == 3);
+      bool unclaimed = true;
+      for (size_t i = 0; i < custom::klsm_priority_queue <int>::MAX_LOCALS; i++)
+         unclaimed = unclaimed && !q.locals[i].claimed.load();
+      assertUnit(unclaimed);
+   }  // teardown
+
+   // more threads than Locals over time, but never at once: every one gets one
+   void test_local_manyThreads()
+   {  // setup
+      custom::klsm_priority_queue <int> q(16);
+      bool allLocal = true;
+      // exercise
+      for (int t = 0; t < 300; t++)
+      {
+         std::thread thread([&q, &allLocal, t]()
+         {
+            allLocal = allLocal && q.local() != nullptr;
+            q.push(t);
+         });
+         thread.join();
+      }
+      // verify
+      assertUnit(allLocal);
+      assertUnit(q.size() == 300);
+      assertUnit(q.shared.size() == 300);
+   }  // teardown
+
+   /***************************************
+    * THREADS
+    ***************************************/
+
+   // four producers and four consumers: nothing lost, nothing twice
+   void test_threads_producersConsumers()
+   {  // setup
+      custom::klsm_priority_queue <int> q(32);
+      // exercise
+      bool once = producersConsumers(q, 4, 5000);
+      // verify
+      assertUnit(once);
+      assertUnit(q.empty());
+   }  // teardown
+
+   // with nothing local or shared, a pop takes a live thread's local elements
+   void test_threads_stealFromLive()
+   {  // setup
+      custom::klsm_priority_queue <int> q(16);
+      std::atomic<bool> pushed(false);
+      std::atomic<bool> done(false);
+      std::thread producer([&q, &pushed, &done]()
+      {
+         for (int i = 0; i < 10; i++)
+            q.push(i);
+         pushed.store(true);
+         while (!done.load())
+            std::this_thread::yield();
+      });
+      while (!pushed.load())
+         std::this_thread::yield();
+      bool allLocal = q.shared.empty();
+      int value;
+      // exercise
+      bool popped = q.try_pop(value);
+      size_t numShared = q.shared.size();
+      done.store(true);
+      producer.join();
+      // verify
+      assertUnit(allLocal);
+      assertUnit(popped);
+      assertUnit(value == 9);
+      assertUnit(numShared == 9);
+      assertUnit(q.size() == 9);
+   }  // teardown
+};
+
+#endif // DEBUG
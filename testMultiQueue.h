@@ -0,0 +1,191 @@
+/***********************************************************************
+ * Header:
+ *    TEST MULTI QUEUE
+ * Summary:
+ *    Unit tests for the sharded concurrent priority queue
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "multi_queue.h"
+#include "unitTest.h"
+#include "testConcurrent.h"
+
+#include <cassert>
+#include <vector>    // for std::vector
+
+class TestMultiQueue : public UnitTest
+{
+
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_shards();
+      test_construct_clamp();
+
+      // Insert
+      test_push_size();
+
+      // Remove
+      test_tryPop_empty();
+      test_tryPop_oneShardExact();
+      test_tryPop_everything();
+      test_tryPop_minHeap();
+      test_tryPop_statefulCompare();
+
+      // Threads
+      test_threads_producersConsumers();
+
+      report("MultiQueue");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // shardsPerThread shards for every thread, each on its own cache line
+   void test_construct_shards()
+   {  // setup
+      // exercise
+      custom::multi_queue <int> q(4, 3, 2);
+      // verify
+      assertUnit(q.num_shards() == 12);
+      assertUnit(q.numSamples == 2);
+      assertUnit(q.empty());
+      assertUnit((char *)(q.shards + 1) - (char *)q.shards >= 64);
+   }  // teardown
+
+   // zero is treated as one and the samples are capped
+   void test_construct_clamp()
+   {  // setup
+      // exercise
+      custom::multi_queue <int> q(0, 0, 100);
+      // verify
+      assertUnit(q.num_shards() == 1);
+      assertUnit(q.numSamples == 8);
+   }  // teardown
+
+   /***************************************
+    * PUSH
+    ***************************************/
+
+   // every push lands in exactly one shard
+   void test_push_size()
+   {  // setup
+      custom::multi_queue <int> q(2, 2);
+      // exercise
+      for (int i = 0; i < 100; i++)
+         q.push(i);
+      // verify
+      assertUnit(q.size() == 100);
+      size_t total = 0;
+      for (size_t i = 0; i < q.num_shards(); i++)
+         total += q.shards[i].heap.size();
+      assertUnit(total == 100);
+   }  // teardown
+
+   /***************************************
+    * TRY POP
+    ***************************************/
+
+   // nothing to pop
+   void test_tryPop_empty()
+   {  // setup
+      custom::multi_queue <int> q(2, 2);
+      int value = 99;
+      // exercise
+      bool popped = q.try_pop(value);
+      // verify
+      assertUnit(!popped);
+      assertUnit(value == 99);
+   }  // teardown
+
+   // with one shard there is nothing to relax
+   void test_tryPop_oneShardExact()
+   {  // setup
+      custom::multi_queue <int> q(1, 1);
+      for (int i = 0; i < 200; i++)
+         q.push((i * 37) % 200);
+      bool sorted = true;
+      int value;
+      // exercise
+      for (int i = 199; i >= 0; i--)
+         sorted = sorted && q.try_pop(value) && value == i;
+      // verify
+      assertUnit(sorted);
+      assertUnit(!q.try_pop(value));
+   }  // teardown
+
+   // relaxed, but every element comes out exactly once
+   void test_tryPop_everything()
+   {  // setup
+      custom::multi_queue <int> q(4, 2);
+      for (int i = 0; i < 1000; i++)
+         q.push(i);
+      std::vector<int> seen(1000, 0);
+      int value;
+      // exercise
+      while (q.try_pop(value))
+         seen[value]++;
+      // verify
+      bool once = true;
+      for (int i = 0; i < 1000; i++)
+         once = once && seen[i] == 1;
+      assertUnit(once);
+      assertUnit(q.empty());
+   }  // teardown
+
+   // the comparator flips every shard
+   void test_tryPop_minHeap()
+   {  // setup
+      custom::multi_queue <int, std::greater<int>> q(1, 1);
+      q.push(5);
+      q.push(2);
+      q.push(8);
+      int value;
+      // exercise
+      q.try_pop(value);
+      // verify
+      assertUnit(value == 2);
+   }  // teardown
+
+   static bool greaterThan(const int & lhs, const int & rhs) { return lhs > rhs; }
+
+   // the comparator given to the queue reaches the shards
+   void test_tryPop_statefulCompare()
+   {  // setup
+      custom::multi_queue <int, bool (*)(const int &, const int &)> q(1, 1, 2, &greaterThan);
+      for (int i = 0; i < 100; i++)
+         q.push((i * 37) % 100);
+      bool sorted = true;
+      int value;
+      // exercise
+      for (int i = 0; i < 100; i++)
+         sorted = sorted && q.try_pop(value) && value == i;
+      // verify
+      assertUnit(sorted);
+      assertUnit(q.empty());
+   }  // teardown
+
+   /***************************************
+    * THREADS
+    ***************************************/
+
+   // four producers and four consumers: nothing lost, nothing twice
+   void test_threads_producersConsumers()
+   {  // setup
+      custom::multi_queue <int> q(4);
+      // exercise
+      bool once = producersConsumers(q, 4, 5000);
+      // verify
+      assertUnit(once);
+      assertUnit(q.empty());
+   }  // teardown
+};
+
+#endif // DEBUG
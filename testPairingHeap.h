@@ -0,0 +1,351 @@
+/***********************************************************************
+ * Header:
+ *    TEST PAIRING HEAP
+ * Summary:
+ *    Unit tests for the pairing heap and its node pool
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "pairing_heap.h"
+#include "unitTest.h"
+#include "spy.h"
+
+#include <cassert>
+
+class TestPairingHeap : public UnitTest
+{
+
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_constructMove_standard();
+
+      // Access
+      test_top_empty();
+      test_top_standard();
+
+      // Insert
+      test_push_empty();
+      test_push_link();
+      test_merge_emptyStandard();
+      test_merge_standardStandard();
+
+      // Update
+      test_decreaseKey_child();
+      test_decreaseKey_root();
+      test_decreaseKey_wrongWay();
+
+      // Remove
+      test_pop_order();
+      test_pop_minHeap();
+      test_clear_spy();
+
+      // Pool
+      test_pool_reuse();
+      test_pool_splice();
+
+      report("PairingHeap");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // default constructor, no allocations
+   void test_construct_default()
+   {  // setup
+      // exercise
+      custom::pairing_heap <int> heap;
+      // verify
+      assertUnit(heap.empty());
+      assertUnit(heap.root == nullptr);
+      assertUnit(heap.pool.blocks == nullptr);
+   }  // teardown
+
+   // move constructor takes the nodes and their memory
+   void test_constructMove_standard()
+   {  // setup
+      custom::pairing_heap <int> heapSrc;
+      setupStandardFixture(heapSrc);
+      // exercise
+      custom::pairing_heap <int> heapDest(std::move(heapSrc));
+      // verify
+      assertUnit(heapSrc.empty());
+      assertUnit(heapSrc.pool.blocks == nullptr);
+      assertUnit(heapDest.size() == 7);
+      assertUnit(heapDest.top() == 10);
+   }  // teardown
+
+   /***************************************
+    * TOP
+    ***************************************/
+
+   // top of an empty heap
+   void test_top_empty()
+   {  // setup
+      custom::pairing_heap <int> heap;
+      bool thrown = false;
+      // exercise
+      try
+      {
+         heap.top();
+      }
+      catch (const std::out_of_range &)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+   }  // teardown
+
+   // top of the standard fixture
+   void test_top_standard()
+   {  // setup
+      custom::pairing_heap <int> heap;
+      setupStandardFixture(heap);
+      // exercise
+      int value = heap.top();
+      // verify
+      assertUnit(value == 10);
+      assertUnit(heap.size() == 7);
+   }  // teardown
+
+   /***************************************
+    * PUSH
+    ***************************************/
+
+   // push onto an empty heap makes a root
+   void test_push_empty()
+   {  // setup
+      custom::pairing_heap <int> heap;
+      // exercise
+      custom::pairing_heap <int>::handle h = heap.push(5);
+      // verify
+      assertUnit(heap.root == h);
+      assertUnit(h->value() == 5);
+      assertUnit(h->child == nullptr && h->next == nullptr && h->prev == nullptr);
+   }  // teardown
+
+   // push a bigger value: the old root becomes its child
+   void test_push_link()
+   {  // setup
+      custom::pairing_heap <int> heap;
+      custom::pairing_heap <int>::handle h5 = heap.push(5);
+      // exercise
+      custom::pairing_heap <int>::handle h9 = heap.push(9);
+      // verify
+      //    9
+      //    |
+      //    5
+      assertUnit(heap.root == h9);
+      assertUnit(h9->child == h5);
+      assertUnit(h5->prev == h9);
+   }  // teardown
+
+   // merge a standard heap into an empty one
+   void test_merge_emptyStandard()
+   {  // setup
+      custom::pairing_heap <int> heapLHS;
+      custom::pairing_heap <int> heapRHS;
+      setupStandardFixture(heapRHS);
+      // exercise
+      heapLHS.merge(heapRHS);
+      // verify
+      assertUnit(heapRHS.empty());
+      assertUnit(heapLHS.size() == 7);
+      assertUnit(heapLHS.top() == 10);
+   }  // teardown
+
+   // merge two heaps, then pop everything in order
+   void test_merge_standardStandard()
+   {  // setup
+      custom::pairing_heap <int> heapLHS;
+      custom::pairing_heap <int> heapRHS;
+      setupStandardFixture(heapLHS);
+      custom::pairing_heap <int>::handle h = heapRHS.push(6);
+      heapRHS.push(11);
+      heapRHS.push(1);
+      // exercise
+      heapLHS.merge(heapRHS);
+      // verify
+      assertUnit(heapRHS.empty());
+      assertUnit(heapLHS.size() == 10);
+      heapLHS.decrease_key(h, 12);   // handles from rhs still work
+      int expected[] = {12, 11, 10, 9, 8, 7, 5, 4, 3, 1};
+      bool sorted = true;
+      for (int i = 0; i < 10; i++)
+      {
+         sorted = sorted && heapLHS.top() == expected[i];
+         heapLHS.pop();
+      }
+      assertUnit(sorted);
+   }  // teardown
+
+   /***************************************
+    * DECREASE KEY
+    ***************************************/
+
+   // move a child all the way to the top
+   void test_decreaseKey_child()
+   {  // setup
+      custom::pairing_heap <int> heap;
+      setupStandardFixture(heap);
+      // exercise
+      heap.decrease_key(handles[4], 20);   // 3
+      // verify
+      assertUnit(heap.top() == 20);
+      assertUnit(heap.root == handles[4]);
+      assertUnit(heap.size() == 7);
+      heap.pop();
+      assertUnit(heap.top() == 10);
+   }  // teardown
+
+   // change the root in place
+   void test_decreaseKey_root()
+   {  // setup
+      custom::pairing_heap <int> heap;
+      setupStandardFixture(heap);
+      // exercise
+      heap.decrease_key(handles[0], 15);   // 10
+      // verify
+      assertUnit(heap.root == handles[0]);
+      assertUnit(heap.top() == 15);
+   }  // teardown
+
+   // a value that belongs lower is an error
+   void test_decreaseKey_wrongWay()
+   {  // setup
+      custom::pairing_heap <int> heap;
+      setupStandardFixture(heap);
+      bool thrown = false;
+      // exercise
+      try
+      {
+         heap.decrease_key(handles[1], 1);   // 8
+      }
+      catch (const std::invalid_argument &)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(handles[1]->value() == 8);
+   }  // teardown
+
+   /***************************************
+    * POP
+    ***************************************/
+
+   // pop comes out in order
+   void test_pop_order()
+   {  // setup
+      custom::pairing_heap <int> heap;
+      for (int i = 0; i < 500; i++)
+         heap.push((i * 211) % 500);
+      bool sorted = true;
+      // exercise
+      for (int i = 499; i >= 0; i--)
+      {
+         sorted = sorted && heap.top() == i;
+         heap.pop();
+      }
+      // verify
+      assertUnit(sorted);
+      assertUnit(heap.empty());
+      assertUnit(heap.root == nullptr);
+   }  // teardown
+
+   // a min-heap with a comparator
+   void test_pop_minHeap()
+   {  // setup
+      custom::pairing_heap <int, std::greater<int>> heap;
+      for (int i = 0; i < 100; i++)
+         heap.push((i * 37) % 100);
+      bool sorted = true;
+      // exercise
+      for (int i = 0; i < 100; i++)
+      {
+         sorted = sorted && heap.top() == i;
+         heap.pop();
+      }
+      // verify
+      assertUnit(sorted);
+   }  // teardown
+
+   // clear destroys every element exactly once
+   void test_clear_spy()
+   {  // setup
+      custom::pairing_heap <Spy> heap;
+      for (int i = 0; i < 50; i++)
+         heap.push(Spy(i));
+      heap.pop();
+      Spy::reset();
+      // exercise
+      heap.clear();
+      // verify
+      assertUnit(Spy::numDestructor() == 49);
+      assertUnit(Spy::numDelete() == 49);
+      assertUnit(heap.empty());
+   }  // teardown
+
+   /***************************************
+    * POOL
+    ***************************************/
+
+   // popped nodes are reused rather than allocating a new block
+   void test_pool_reuse()
+   {  // setup
+      custom::pairing_heap <int> heap;
+      for (int i = 0; i < 10; i++)
+         heap.push(i);
+      custom::pairing_heap <int>::handle hOld = heap.root;
+      heap.pop();
+      // exercise
+      custom::pairing_heap <int>::handle h = heap.push(99);
+      // verify
+      assertUnit(h == hOld);
+      assertUnit(heap.pool.blocks->next == nullptr);
+      assertUnit(heap.root == h);
+   }  // teardown
+
+   // splicing takes over the blocks and free slots of the other pool
+   void test_pool_splice()
+   {  // setup
+      custom::node_pool <int *> poolLHS;
+      custom::node_pool <int *> poolRHS;
+      void * pLHS = poolLHS.allocate();
+      void * pRHS = poolRHS.allocate();
+      // exercise
+      poolLHS.splice(poolRHS);
+      // verify
+      assertUnit(poolRHS.blocks == nullptr);
+      assertUnit(poolRHS.freeList == nullptr);
+      assertUnit(poolLHS.blocks != nullptr && poolLHS.blocks->next != nullptr);
+      assertUnit(poolLHS.freeTail->next == nullptr);
+      // teardown
+      poolLHS.deallocate(pLHS);
+      poolLHS.deallocate(pRHS);
+   }
+
+   /***************************************************
+    * SETUP STANDARD FIXTURE
+    * push 10, 8, 9, 4, 3, 7, 5 in that order
+    * handles[i] is the handle of the i'th pushed value
+    ***************************************************/
+   custom::pairing_heap <int>::handle handles[7];
+   void setupStandardFixture(custom::pairing_heap <int>& heap)
+   {
+      int values[] = {10, 8, 9, 4, 3, 7, 5};
+      for (int i = 0; i < 7; i++)
+         handles[i] = heap.push(values[i]);
+   }
+};
+
+#endif // DEBUG
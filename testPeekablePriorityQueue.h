@@ -0,0 +1,283 @@
+/***********************************************************************
+ * Header:
+ *    TEST PEEKABLE PRIORITY QUEUE
+ * Summary:
+ *    Unit tests for the locked heap with a seqlock-published top
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "peekable_priority_queue.h"
+#include "unitTest.h"
+
+#include <cassert>
+#include <atomic>       // for std::atomic
+#include <thread>       // for std::thread
+#include <vector>       // for std::vector
+#include <cstdint>      // for uint64_t
+#include <functional>   // for std::greater
+
+class TestPeekablePQueue : public UnitTest
+{
+
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_empty();
+
+      // Peek
+      test_peek_afterPush();
+      test_peek_afterPop();
+      test_peek_drained();
+      test_peek_greater();
+      test_peek_wide();
+
+      // Publish
+      test_publish_onlyNewTop();
+      test_publish_sequenceEven();
+
+      // Threads
+      test_threads_neverTorn();
+      test_threads_readersSeeProgress();
+
+      report("PeekablePQueue");
+   }
+
+   /***************************************
+    * QUAD
+    * Four words that always hold the same value, so
+    * a torn copy shows up as words that disagree
+    ***************************************/
+   struct Quad
+   {
+      uint64_t words[4];
+
+      Quad() : words{} {}
+      Quad(uint64_t value) : words{value, value, value, value} {}
+      bool operator < (const Quad & rhs) const { return words[0] < rhs.words[0]; }
+      bool whole() const
+      {
+         return words[0] == words[1] && words[1] == words[2] && words[2] == words[3];
+      }
+   };
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // nothing to peek at
+   void test_construct_empty()
+   {  // setup
+      // exercise
+      custom::peekable_priority_queue <int> q;
+      int value = 99;
+      // verify
+      assertUnit(q.empty());
+      assertUnit(!q.peek(value));
+      assertUnit(value == 99);
+      assertUnit(q.sequence.load() == 0);
+   }  // teardown
+
+   /***************************************
+    * PEEK
+    ***************************************/
+
+   // the largest so far
+   void test_peek_afterPush()
+   {  // setup
+      custom::peekable_priority_queue <int> q;
+      int value = 0;
+      // exercise
+      q.push(4);
+      q.push(9);
+      q.push(1);
+      // verify
+      assertUnit(q.peek(value));
+      assertUnit(value == 9);
+      assertUnit(q.size() == 3);
+   }  // teardown
+
+   // a pop publishes the next one
+   void test_peek_afterPop()
+   {  // setup
+      custom::peekable_priority_queue <int> q;
+      q.push(4);
+      q.push(9);
+      q.push(7);
+      int popped = 0;
+      int value = 0;
+      // exercise
+      q.try_pop(popped);
+      // verify
+      assertUnit(popped == 9);
+      assertUnit(q.peek(value));
+      assertUnit(value == 7);
+   }  // teardown
+
+   // popping the last one publishes an empty queue
+   void test_peek_drained()
+   {  // setup
+      custom::peekable_priority_queue <int> q;
+      q.push(5);
+      int value = 0;
+      // exercise
+      bool popped = q.try_pop(value);
+      // verify
+      assertUnit(popped);
+      assertUnit(!q.peek(value));
+      assertUnit(q.hasTop.load() == 0);
+      assertUnit(!q.try_pop(value));
+   }  // teardown
+
+   // with std::greater the smallest is on top
+   void test_peek_greater()
+   {  // setup
+      custom::peekable_priority_queue <int, std::greater<int>> q;
+      int value = 0;
+      // exercise
+      q.push(4);
+      q.push(9);
+      q.push(1);
+      // verify
+      assertUnit(q.peek(value));
+      assertUnit(value == 1);
+   }  // teardown
+
+   // a type wider than one word comes back whole
+   void test_peek_wide()
+   {  // setup
+      custom::peekable_priority_queue <Quad> q;
+      Quad value;
+      // exercise
+      q.push(Quad(3));
+      q.push(Quad(8));
+      // verify
+      assertUnit(q.NUM_WORDS == 4);
+      assertUnit(q.peek(value));
+      assertUnit(value.whole());
+      assertUnit(value.words[0] == 8);
+   }  // teardown
+
+   /***************************************
+    * PUBLISH
+    ***************************************/
+
+   // a push below the top leaves the readers alone
+   void test_publish_onlyNewTop()
+   {  // setup
+      custom::peekable_priority_queue <int> q;
+      q.push(10);
+      uint64_t sequence = q.sequence.load();
+      // exercise
+      q.push(3);
+      q.push(7);
+      uint64_t sequenceBelow = q.sequence.load();
+      q.push(12);
+      // verify
+      assertUnit(sequenceBelow == sequence);
+      assertUnit(q.sequence.load() == sequence + 2);
+      int value = 0;
+      assertUnit(q.peek(value) && value == 12);
+   }  // teardown
+
+   // every publish leaves the sequence even again
+   void test_publish_sequenceEven()
+   {  // setup
+      custom::peekable_priority_queue <int> q;
+      int value;
+      // exercise
+      for (int i = 0; i < 10; i++)
+         q.push(i);
+      for (int i = 0; i < 5; i++)
+         q.try_pop(value);
+      // verify
+      assertUnit(q.sequence.load() % 2 == 0);
+      assertUnit(q.sequence.load() == 2 * (10 + 5));
+   }  // teardown
+
+   /***************************************
+    * THREADS
+    ***************************************/
+
+   // readers peek while writers churn the top: never a torn copy
+   void test_threads_neverTorn()
+   {  // setup
+      custom::peekable_priority_queue <Quad> q;
+      std::atomic<bool> done(false);
+      std::atomic<int> numTorn(0);
+      std::atomic<int> numPeeks(0);
+      std::vector<std::thread> threads;
+      q.push(Quad(0));   // never the top once a writer pushes, never popped
+      // exercise
+      for (int t = 0; t < 2; t++)
+         threads.push_back(std::thread([&q, &done, &numTorn, &numPeeks]()
+         {
+            Quad value;
+            do
+               if (q.peek(value))
+               {
+                  numPeeks++;
+                  if (!value.whole())
+                     numTorn++;
+               }
+            while (!done.load());
+         }));
+      for (int t = 0; t < 2; t++)
+         threads.push_back(std::thread([&q, t]()
+         {
+            Quad value;
+            for (uint64_t i = 0; i < 20000; i++)
+            {
+               q.push(Quad(i * 2 + t + 1));
+               if (i % 2)
+                  q.try_pop(value);
+            }
+         }));
+      threads[2].join();
+      threads[3].join();
+      done.store(true);
+      threads[0].join();
+      threads[1].join();
+      // verify
+      assertUnit(numTorn.load() == 0);
+      assertUnit(numPeeks.load() >= 2);
+      assertUnit(q.size() == 20001);
+   }  // teardown
+
+   // what a reader sees is always a value some writer pushed
+   void test_threads_readersSeeProgress()
+   {  // setup
+      custom::peekable_priority_queue <Quad> q;
+      std::atomic<bool> done(false);
+      std::atomic<int> numBad(0);
+      std::thread reader([&q, &done, &numBad]()
+      {
+         Quad value;
+         uint64_t last = 0;
+         while (!done.load())
+            if (q.peek(value))
+            {
+               // the pushes only grow, so the top never goes back
+               if (!value.whole() || value.words[0] < last || value.words[0] > 5000)
+                  numBad++;
+               last = value.words[0];
+            }
+      });
+      // exercise
+      for (uint64_t i = 1; i <= 5000; i++)
+         q.push(Quad(i));
+      done.store(true);
+      reader.join();
+      // verify
+      assertUnit(numBad.load() == 0);
+      Quad value;
+      assertUnit(q.peek(value) && value.words[0] == 5000);
+   }  // teardown
+};
+
+#endif // DEBUG
@@ -0,0 +1,384 @@
+/***********************************************************************
+ * Header:
+ *    TEST PRIORITY EXECUTOR
+ * Summary:
+ *    Unit tests for the work-stealing priority executor
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "priority_executor.h"
+#include "unitTest.h"
+
+#include <cassert>
+#include <atomic>    // for std::atomic
+#include <mutex>     // for std::mutex
+#include <thread>    // for std::this_thread
+#include <vector>    // for std::vector
+
+class TestPriorityExecutor : public UnitTest
+{
+
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_numWorkers();
+
+      // Submit
+      test_submit_runsAll();
+      test_submit_priorityOrder();
+      test_submit_forkJoin();
+      test_submit_queuedNeverWraps();
+
+      // Steal
+      test_steal_betterHalf();
+      test_steal_roundsUp();
+      test_steal_nothing();
+      test_pickVictim_richest();
+
+      // Wait and shutdown
+      test_wait_empty();
+      test_shutdown_drains();
+
+      // Statistics
+      test_stats_counts();
+
+      report("PriorityExecutor");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // at least one worker, each with empty statistics
+   void test_construct_numWorkers()
+   {  // setup
+      // exercise
+      custom::priority_executor e(0);
+      // verify
+      assertUnit(e.num_workers() == 1);
+      custom::vector<custom::priority_executor::worker_stats> stats = e.stats();
+      assertUnit(stats.size() == 1);
+      assertUnit(stats[0].numLocalPops == 0);
+      assertUnit(stats[0].numSteals == 0);
+   }  // teardown
+
+   /***************************************
+    * SUBMIT
+    ***************************************/
+
+   // every task runs exactly once
+   void test_submit_runsAll()
+   {  // setup
+      const int num = 2000;
+      custom::priority_executor e(4);
+      std::vector<std::atomic<int>> ran(num);
+      for (int i = 0; i < num; i++)
+         ran[i].store(0);
+      // exercise
+      for (int i = 0; i < num; i++)
+         e.submit(i % 7, [&ran, i]() { ran[i]++; });
+      e.wait();
+      // verify
+      bool once = true;
+      for (int i = 0; i < num; i++)
+         once = once && ran[i].load() == 1;
+      assertUnit(once);
+      assertUnit(e.numPending.load() == 0);
+      assertUnit(e.numQueued.load() == 0);
+   }  // teardown
+
+   // a task is counted before a worker can take it, so the count never wraps
+   void test_submit_queuedNeverWraps()
+   {  // setup
+      const int num = 20000;
+      custom::priority_executor e(4);
+      std::atomic<bool> done(false);
+      std::atomic<bool> wrapped(false);
+      std::thread watcher([&e, &done, &wrapped]()
+      {
+         while (!done.load())
+            if (e.numQueued.load() > size_t(num))
+               wrapped.store(true);
+      });
+      // exercise
+      for (int i = 0; i < num; i++)
+         e.submit(i % 7, []() {});
+      e.wait();
+      done.store(true);
+      watcher.join();
+      // verify
+      assertUnit(!wrapped.load());
+      assertUnit(e.numQueued.load() == 0);
+   }  // teardown
+
+   // one worker runs the highest priority first, equal ones in order
+   void test_submit_priorityOrder()
+   {  // setup
+      custom::priority_executor e(1);
+      std::atomic<bool> started(false);
+      std::atomic<bool> release(false);
+      e.submit(0, gate(started, release));
+      while (!started.load())
+         std::this_thread::yield();
+      std::mutex lock;
+      std::vector<int> order;
+      int priorities[] = { 1, 5, 3, 5, 1, 9 };
+      // exercise
+      for (int i = 0; i < 6; i++)
+         e.submit(priorities[i], [&lock, &order, i]()
+         {
+            std::lock_guard<std::mutex> guard(lock);
+            order.push_back(i);
+         });
+      release.store(true);
+      e.wait();
+      // verify
+      assertUnit(order.size() == 6);
+      int expected[] = { 5, 1, 3, 2, 0, 4 };
+      bool inOrder = order.size() == 6;
+      for (size_t i = 0; inOrder && i < 6; i++)
+         inOrder = order[i] == expected[i];
+      assertUnit(inOrder);
+   }  // teardown
+
+   // tasks that submit tasks: wait() covers the whole tree
+   void test_submit_forkJoin()
+   {  // setup
+      custom::priority_executor e(4);
+      std::atomic<int> numNodes(0);
+      // exercise
+      e.submit(0, [&e, &numNodes]() { fork(e, numNodes, 10); });
+      e.wait();
+      // verify
+      assertUnit(numNodes.load() == (1 << 11) - 1);
+   }  // teardown
+
+   /***************************************
+    * STEAL
+    ***************************************/
+
+   // the thief takes the best half, runs the best, queues the rest
+   void test_steal_betterHalf()
+   {  // setup
+      custom::priority_executor e(2);
+      std::atomic<bool> release(false);
+      blockAll(e, release);
+      std::atomic<int> ran(-1);
+      for (int i = 0; i < 6; i++)
+         place(e, 0, i, ran);
+      custom::priority_executor::Task task;
+      // exercise
+      bool stolen = e.steal(1, task);
+      // verify
+      assertUnit(stolen);
+      assertUnit(task.priority == 5);
+      assertUnit(e.workers[0].tasks.size() == 3);
+      assertUnit(e.workers[0].tasks.top().priority == 2);
+      assertUnit(e.workers[1].tasks.size() == 2);
+      assertUnit(e.workers[1].tasks.top().priority == 4);
+      assertUnit(e.workers[1].numSteals.load() == 1);
+      assertUnit(e.workers[1].numStolen.load() == 3);
+      assertUnit(e.numQueued.load() == 5);
+      // teardown
+      task.work();
+      e.finished();
+      release.store(true);
+      e.wait();
+   }
+
+   // a single task is stolen whole
+   void test_steal_roundsUp()
+   {  // setup
+      custom::priority_executor e(2);
+      std::atomic<bool> release(false);
+      blockAll(e, release);
+      std::atomic<int> ran(-1);
+      place(e, 0, 7, ran);
+      custom::priority_executor::Task task;
+      // exercise
+      bool stolen = e.steal(1, task);
+      // verify
+      assertUnit(stolen);
+      assertUnit(task.priority == 7);
+      assertUnit(e.workers[0].tasks.empty());
+      assertUnit(e.workers[1].tasks.empty());
+      assertUnit(e.numQueued.load() == 0);
+      // teardown
+      task.work();
+      e.finished();
+      release.store(true);
+      e.wait();
+   }
+
+   // nobody has anything to steal
+   void test_steal_nothing()
+   {  // setup
+      custom::priority_executor e(2);
+      std::atomic<bool> release(false);
+      blockAll(e, release);
+      custom::priority_executor::Task task;
+      // exercise
+      bool stolen = e.steal(1, task);
+      // verify
+      assertUnit(!stolen);
+      assertUnit(e.workers[1].numSteals.load() == 0);
+      // teardown
+      release.store(true);
+      e.wait();
+   }
+
+   // the richest policy goes for the longest queue, never itself
+   void test_pickVictim_richest()
+   {  // setup
+      custom::priority_executor e(3, custom::priority_executor::STEAL_RICHEST);
+      std::atomic<bool> release(false);
+      blockAll(e, release);
+      e.workers[0].numTasks.store(2);
+      e.workers[1].numTasks.store(9);
+      e.workers[2].numTasks.store(4);
+      uint64_t random = 1;
+      // exercise
+      size_t victimOf0 = e.pickVictim(0, random);
+      size_t victimOf1 = e.pickVictim(1, random);
+      // verify
+      assertUnit(victimOf0 == 1);
+      assertUnit(victimOf1 == 2);
+      // teardown
+      for (size_t i = 0; i < 3; i++)
+         e.workers[i].numTasks.store(0);
+      release.store(true);
+      e.wait();
+   }
+
+   /***************************************
+    * WAIT and SHUTDOWN
+    ***************************************/
+
+   // nothing submitted, nothing to wait for
+   void test_wait_empty()
+   {  // setup
+      custom::priority_executor e(2);
+      // exercise
+      e.wait();
+      // verify
+      assertUnit(e.numPending.load() == 0);
+   }  // teardown
+
+   // shutdown runs what is queued first, and twice is harmless
+   void test_shutdown_drains()
+   {  // setup
+      custom::priority_executor e(2);
+      std::atomic<int> numRan(0);
+      for (int i = 0; i < 500; i++)
+         e.submit(i, [&numRan]() { numRan++; });
+      // exercise
+      e.shutdown();
+      e.shutdown();
+      // verify
+      assertUnit(numRan.load() == 500);
+      assertUnit(e.threads.empty());
+      assertUnit(e.workers == nullptr);
+      assertUnit(e.stats().empty());
+   }  // teardown
+
+   /***************************************
+    * STATS
+    ***************************************/
+
+   // every task ran from a local pop or as the first of a steal
+   void test_stats_counts()
+   {  // setup
+      custom::priority_executor e(3);
+      std::atomic<int> numNodes(0);
+      // exercise
+      for (int i = 0; i < 4; i++)
+         e.submit(i, [&e, &numNodes]() { fork(e, numNodes, 7); });
+      e.wait();
+      // verify
+      custom::vector<custom::priority_executor::worker_stats> stats = e.stats();
+      uint64_t numRun = 0;
+      uint64_t numStolen = 0;
+      for (size_t i = 0; i < stats.size(); i++)
+      {
+         numRun += stats[i].numLocalPops + stats[i].numSteals;
+         numStolen += stats[i].numStolen;
+         assertUnit(stats[i].numStolen >= stats[i].numSteals);
+         assertUnit(stats[i].idleMilliseconds >= 0.0);
+      }
+      assertUnit(numNodes.load() == 4 * ((1 << 8) - 1));
+      assertUnit(numRun == (uint64_t)numNodes.load());
+      assertUnit(numStolen <= numRun);
+   }  // teardown
+
+   /***************************************************
+    * FORK
+    * A binary tree of tasks, depth levels below this one
+    ***************************************************/
+   static void fork(custom::priority_executor & e, std::atomic<int> & numNodes, int depth)
+   {
+      numNodes++;
+      if (depth == 0)
+         return;
+      for (int i = 0; i < 2; i++)
+         e.submit(depth, [&e, &numNodes, depth]() { fork(e, numNodes, depth - 1); });
+   }
+
+   /***************************************************
+    * GATE
+    * A task that holds its worker until released
+    ***************************************************/
+   static std::function<void()> gate(std::atomic<bool> & started, std::atomic<bool> & release)
+   {
+      return [&started, &release]()
+      {
+         started.store(true);
+         while (!release.load())
+            std::this_thread::yield();
+      };
+   }
+
+   /***************************************************
+    * BLOCK ALL
+    * Park every worker in a gate so the queues hold still.
+    * A parked worker cannot take a second gate, so each
+    * worker ends up with one whoever queued it.
+    ***************************************************/
+   void blockAll(custom::priority_executor & e, std::atomic<bool> & release)
+   {
+      std::atomic<size_t> numStarted(0);
+      for (size_t i = 0; i < e.num_workers(); i++)
+         e.submit(0, [&numStarted, &release]()
+         {
+            numStarted++;
+            while (!release.load())
+               std::this_thread::yield();
+         });
+      while (numStarted.load() < e.num_workers())
+         std::this_thread::yield();
+   }
+
+   /***************************************************
+    * PLACE
+    * Queue a task on a given worker, behind the executor's back
+    ***************************************************/
+   void place(custom::priority_executor & e, size_t index, int priority, std::atomic<int> & ran)
+   {
+      custom::priority_executor::Task task;
+      task.priority = priority;
+      task.sequence = e.sequence++;
+      task.work = [&ran, priority]() { ran.store(priority); };
+      e.numPending++;
+      e.numQueued++;
+      std::lock_guard<std::mutex> guard(e.workers[index].lock);
+      e.workers[index].tasks.push(std::move(task));
+      e.workers[index].numTasks.store(e.workers[index].tasks.size());
+   }
+};
+
+#endif // DEBUG
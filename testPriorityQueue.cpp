@@ -14,10 +14,41 @@
 #define DEBUG   
 #endif
  //#undef DEBUG  // Remove this comment to disable unit tests
+ //#define BENCHMARK  // Remove this comment to enable the benchmarks
 
 #include "testPriorityQueue.h"  // for the priority queue unit tests
 #include "testSpy.h"            // for the spy unit tests
 #include "testVector.h"         // for the vector unit tests
+#include "testAddressablePriorityQueue.h" // for the addressable priority queue unit tests
+#include "testIndexedPriorityQueue.h"     // for the indexed priority queue unit tests
+#include "testPairingHeap.h"              // for the pairing heap unit tests
+#include "testRadixHeap.h"                // for the radix heap unit tests
+#include "testBucketQueue.h"              // for the bucket queue unit tests
+#include "testCalendarQueue.h"            // for the calendar queue unit tests
+#include "testMultiQueue.h"               // for the multi queue unit tests
+#include "testSkiplistPriorityQueue.h"    // for the skiplist priority queue unit tests
+#include "testCombiningPriorityQueue.h"   // for the combining priority queue unit tests
+#include "testBlockingPriorityQueue.h"    // for the blocking priority queue unit tests
+#include "testKLSMPriorityQueue.h"        // for the k-LSM priority queue unit tests
+#include "testPriorityExecutor.h"         // for the priority executor unit tests
+#include "testBufferedPriorityQueue.h"     // for the buffered priority queue unit tests
+#include "testPeekablePriorityQueue.h"     // for the peekable priority queue unit tests
+#include "testAsyncPriorityQueue.h"        // for the async priority queue unit tests
+#include "testBoundedPriorityQueue.h"      // for the bounded priority queue unit tests
+#include "benchPriorityQueue.h" // for the priority queue benchmarks
+#include "benchPairingHeap.h"   // for the pairing heap benchmarks
+#include "benchRadixHeap.h"     // for the radix heap benchmarks
+#include "benchBucketQueue.h"   // for the bucket queue benchmarks
+#include "benchCalendarQueue.h" // for the calendar queue benchmarks
+#include "benchMultiQueue.h"    // for the multi queue benchmarks
+#include "benchSkiplistPriorityQueue.h" // for the skiplist priority queue benchmarks
+#include "benchCombiningPriorityQueue.h" // for the combining priority queue benchmarks
+#include "benchKLSMPriorityQueue.h"     // for the k-LSM priority queue benchmarks
+#include "benchPriorityExecutor.h"      // for the priority executor benchmarks
+#include "benchBufferedPriorityQueue.h" // for the buffered priority queue benchmarks
+#include "benchPeekablePriorityQueue.h" // for the peekable priority queue benchmarks
+#include "benchAsyncPriorityQueue.h"    // for the async priority queue benchmarks
+#include "benchBoundedPriorityQueue.h"  // for the bounded priority queue benchmarks
 int Spy::counters[] = {};
 
 /**********************************************************************
@@ -31,7 +62,41 @@ int main()
    TestSpy().run();
    TestVector().run();
    TestPQueue().run();
+   TestAddressablePQueue().run();
+   TestIndexedPQueue().run();
+   TestPairingHeap().run();
+   TestRadixHeap().run();
+   TestBucketQueue().run();
+   TestCalendarQueue().run();
+   TestMultiQueue().run();
+   TestSkiplistPQueue().run();
+   TestCombiningPQueue().run();
+   TestBlockingPQueue().run();
+   TestKLSMPQueue().run();
+   TestPriorityExecutor().run();
+   TestBufferedPQueue().run();
+   TestPeekablePQueue().run();
+   TestAsyncPQueue().run();
+   TestBoundedPQueue().run();
 #endif // DEBUG
+
+#ifdef BENCHMARK
+   // timing
+   BenchPQueue().run();
+   BenchPairingHeap().run();
+   BenchRadixHeap().run();
+   BenchBucketQueue().run();
+   BenchCalendarQueue().run();
+   BenchMultiQueue().run();
+   BenchSkiplistPQueue().run();
+   BenchCombiningPQueue().run();
+   BenchKLSMPQueue().run();
+   BenchPriorityExecutor().run();
+   BenchBufferedPQueue().run();
+   BenchPeekablePQueue().run();
+   BenchAsyncPQueue().run();
+   BenchBoundedPQueue().run();
+#endif // BENCHMARK
    
    return 0;
 }
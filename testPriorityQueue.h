@@ -17,6 +17,8 @@
 
 #include <cassert>
 #include <memory>
+#include <vector>    // for std::vector
+#include <iterator>  // for std::make_move_iterator
 
 
 class TestPQueue : public UnitTest
@@ -36,10 +38,13 @@ public:
       test_constructRange_empty();
       test_constructRange_one();
       test_constructRange_staandard();
+      test_constructRange_heapifies();
+      test_constructRange_moveIterators();
       test_constructMoveInit_empty();
       test_constructMoveInit_one();
       test_constructMoveInit_standard();
       test_constructMoveInit_twoLevels();
+      test_constructCopyInit_leavesSource();
 
       // Assign
       test_swap_emptyEmpty();
@@ -68,6 +73,19 @@ public:
       test_pop_one();
       test_pop_two();
       test_pop_standard();
+      test_popBottomUp_empty();
+      test_popBottomUp_standard();
+      test_popBottomUp_order();
+      test_popBottomUp_comparisons();
+
+      // Exchange
+      test_replaceTop_empty();
+      test_replaceTop_standard();
+      test_replaceTop_oneSift();
+      test_pushPop_empty();
+      test_pushPop_better();
+      test_pushPop_equal();
+      test_pushPop_worse();
 
       // Status
       test_size_empty();
@@ -83,6 +101,53 @@ public:
       test_heapify_oneLevel();
       test_heapify_twoLevels();
 
+      // Compare
+      test_compare_emptyBase();
+      test_compare_minHeapPush();
+      test_compare_minHeapPop();
+      test_compare_functionPointer();
+      test_compare_final();
+
+      // Arity
+      test_arity_percolateDown();
+      test_arity_push();
+      test_arity_heapify();
+      test_arity_popOrder();
+
+      // Moves
+      test_moves_pushLevelZero();
+      test_moves_pushLevelTwo();
+      test_moves_pushCopyLevelThree();
+      test_moves_percolateDownTwoLevels();
+      test_moves_popStandard();
+      test_moves_emplaceLevelZero();
+      test_moves_emplaceLevelTwo();
+      test_emplace_pair();
+
+      // Batch
+      test_pushBatch_siftUp();
+      test_pushBatch_rebuild();
+      test_pushBatch_parallel();
+      test_pushBatch_parallelArity();
+      test_popBatch_zero();
+      test_popBatch_few();
+      test_popBatch_many();
+      test_popBatch_parallel();
+      test_popBatch_all();
+      test_assign_replaces();
+      test_assign_keepsCapacity();
+      test_appendAndHeapify_siftUp();
+      test_appendAndHeapify_rebuild();
+      test_appendAndHeapify_copies();
+
+      // Merge
+      test_merge_emptyIntoStandard();
+      test_merge_standardIntoEmpty();
+      test_merge_self();
+      test_merge_smallSiftsUp();
+      test_merge_similarRebuilds();
+      test_merge_keepsLarger();
+
       report("PQueue");
    }
 
@@ -248,6 +313,52 @@ public:
       teardownStandardFixture(pq);
    }
    
+   // priority_queue({1, 2, 3, 4, 5, 6, 7}) is built into a heap
+   void test_constructRange_heapifies()
+   {  // setup
+      std::initializer_list<int> il{ 1, 2, 3, 4, 5, 6, 7 };
+      // exercise
+      custom::priority_queue<int> pq(il.begin(), il.end());
+      // verify
+      //             7
+      //          5      6
+      //         4 2    1 3
+      assertUnit(pq.container.size() == 7);
+      assertUnit(pq.container.capacity() == 7);
+      if (pq.container.size() == 7)
+      {
+         assertUnit(pq.container[0] == int(7));
+         assertUnit(pq.container[1] == int(5));
+         assertUnit(pq.container[2] == int(6));
+         assertUnit(pq.container[3] == int(4));
+         assertUnit(pq.container[4] == int(2));
+         assertUnit(pq.container[5] == int(1));
+         assertUnit(pq.container[6] == int(3));
+      }
+      assertUnit(isHeap(pq));
+      // teardown
+      teardownStandardFixture(pq);
+   }
+
+   // through move iterators nothing is copied
+   void test_constructRange_moveIterators()
+   {  // setup
+      std::vector<Spy> v;
+      for (int i = 0; i < 7; i++)
+         v.push_back(Spy(i));
+      Spy::reset();
+      // exercise
+      custom::priority_queue <Spy> pq(std::make_move_iterator(v.begin()),
+                                       std::make_move_iterator(v.end()));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(pq.size() == 7);
+      assertUnit(pq.top().get() == 6);
+      assertUnit(isHeap(pq));
+      assertUnit(v[0].empty());
+   }  // teardown
+
    /***************************************
     * MOVE CONTAINER INITIALIZE CONSTRUCTOR
     ***************************************/
@@ -342,6 +453,31 @@ public:
       teardownStandardFixture(pq);
    }
 
+   /***************************************
+    * COPY CONTAINER INITIALIZE CONSTRUCTOR
+    ***************************************/
+
+   // priority_queue(v) copies v, leaves it alone, and builds a heap
+   void test_constructCopyInit_leavesSource()
+   {  // setup
+      custom::vector <int> v{ 1, 2, 3, 4, 5, 6, 7 };
+      // exercise
+      custom::priority_queue <int> pq(v);
+      // verify
+      assertUnit(pq.container.size() == 7);
+      if (pq.container.size() == 7)
+         assertUnit(pq.container[0] == int(7));
+      assertUnit(isHeap(pq));
+      assertUnit(v.size() == 7);
+      if (v.size() == 7)
+      {
+         assertUnit(v[0] == int(1));
+         assertUnit(v[6] == int(7));
+      }
+      // teardown
+      teardownStandardFixture(pq);
+   }
+
    /***************************************
     * SIZE EMPTY
     ***************************************/
@@ -711,220 +847,906 @@ public:
    }
 
    /***************************************
-    * TOP
+    * COMPARE
     ***************************************/
 
-   // top of an empty priority queue
-   void test_top_empty()
+   // a stateless comparator should not take up any space
+   void test_compare_emptyBase()
    {  // setup
-      custom::priority_queue <int> pq;
-      int value(99);
       // exercise
-      try
-      {
-         value = pq.top();
-         // verify
-         assertUnit(false);
-      }
-      catch (const std::out_of_range& error)
-      {
-          std::cerr << "Caught exception: " << error.what() << std::endl;
-          assertUnit(error.what() == std::string("std:out_of_range"));
-      }
-      assertUnit(value == int(99));
-      assertEmptyFixture(pq);
+      // verify
+      assertUnit(sizeof(custom::priority_queue <int>) == sizeof(custom::vector <int>));
+      assertUnit(sizeof(custom::priority_queue <int, std::greater<int>>) == sizeof(custom::vector <int>));
    }  // teardown
 
-   // top of the standard fixture
-   void test_top_standard()
+   // push onto a min-heap
+   void test_compare_minHeapPush()
    {  // setup
-      //  +---+---+---+---+---+---+---+---+---+
-      //  | 10| 8 | 9 | 4 | 3 | 7 | 5 |   |   |
-      //  +---+---+---+---+---+---+---+---+---+
-      custom::priority_queue <int> pq;
-      setupStandardFixture(pq);
-      int value(99);
+      //                3
+      //          4            7
+      custom::priority_queue <int, std::greater<int>> pq;
+      pq.container = {int(3), int(4), int(7)};
+      pq.container.reserve(4);
       // exercise
-      value = pq.top();
+      pq.push(int(1));
       // verify
-      assertUnit(value == int(10));
-      assertStandardFixture(pq);
+      //    1   2   3   4
+      //                1
+      //          3            7
+      //       4
+      assertUnit(pq.container.size() == 4);
+      if (pq.container.size() == 4)
+      {
+         assertUnit(pq.container[0] == int(1));
+         assertUnit(pq.container[1] == int(3));
+         assertUnit(pq.container[2] == int(7));
+         assertUnit(pq.container[3] == int(4));
+      }
       // teardown
-      teardownStandardFixture(pq);
-   }  
+      pq.container.clear();
+   }
 
-  /***************************************
-   * POP
-   ***************************************/
+   static bool greaterThan(const int & lhs, const int & rhs) { return lhs > rhs; }
 
-   // pop an empty priority queue
-   void test_pop_empty()
+   // a comparator that is final cannot be a base, so it is a member
+   struct FinalGreater final
+   {
+      bool operator()(const int & lhs, const int & rhs) const { return lhs > rhs; }
+   };
+
+   // a function pointer is held as a member and gives a min-heap
+   void test_compare_functionPointer()
    {  // setup
-      custom::priority_queue <int> pq;
+      typedef custom::priority_queue <int, bool (*)(const int &, const int &)> PQueue;
+      PQueue pq(&greaterThan);
       // exercise
+      pq.push(5);
+      pq.push(3);
+      pq.push(8);
+      PQueue pqCopy(pq);
       pq.pop();
       // verify
-      assertEmptyFixture(pq);
+      assertUnit(sizeof(PQueue) > sizeof(custom::vector <int>));
+      assertUnit(pq.size() == 2);
+      assertUnit(pq.top() == 5);
+      assertUnit(pqCopy.size() == 3);
+      assertUnit(pqCopy.top() == 3);
+      swap(pq, pqCopy);
+      assertUnit(pq.top() == 3);
+      assertUnit(pqCopy.top() == 5);
    }  // teardown
 
-   // pop a priority queue with a single element
-   void test_pop_one()
+   // a final comparator works like any other
+   void test_compare_final()
    {  // setup
-      //  +----+
-      //  | 99 |
-      //  +----+
-      custom::priority_queue <int> pq;
-      pq.container.push_back(int(99));
+      custom::priority_queue <int, FinalGreater> pq;
       // exercise
-      pq.pop();
+      pq.push(5);
+      pq.push(3);
+      pq.push(8);
       // verify
-      //  +----+
-      //  |    |
-      //  +----+
-      assertEmptyFixture(pq);
-      // teardown
-   }
+      assertUnit(pq.top() == 3);
+      pq.pop();
+      assertUnit(pq.top() == 5);
+   }  // teardown
 
-   // pop a priority queue with two elements
-   void test_pop_two()
+   // pop from a min-heap
+   void test_compare_minHeapPop()
    {  // setup
-      //               10
-      //         8
-      //  +---+---+
-      //  | 10| 8 |
-      //  +---+---+
-      custom::priority_queue <int> pq;
-      pq.container.push_back(int(10));
-      pq.container.push_back(int(8));
+      //                3
+      //          4            7
+      //       9     5
+      custom::priority_queue <int, std::greater<int>> pq;
+      pq.container = {int(3), int(4), int(7), int(9), int(5)};
       // exercise
       pq.pop();
       // verify
-      //  +---+
-      //  | 8 |
-      //  +---+
-      assertUnit(pq.container.size() == 1);
-      if (pq.container.size() == 1)
-         assertUnit(pq.container[0] == int(8));
+      //    1   2   3   4
+      //                4
+      //          5            7
+      //       9
+      assertUnit(pq.container.size() == 4);
+      if (pq.container.size() == 4)
+      {
+         assertUnit(pq.container[0] == int(4));
+         assertUnit(pq.container[1] == int(5));
+         assertUnit(pq.container[2] == int(7));
+         assertUnit(pq.container[3] == int(9));
+      }
       // teardown
-      teardownStandardFixture(pq);
+      pq.container.clear();
    }
 
-   // pop a priority queue with three elements
-   void test_pop_three()
+   /***************************************
+    * ARITY
+    ***************************************/
+
+   // percolate down a 4-ary heap
+   void test_arity_percolateDown()
    {  // setup
-      //               10
-      //         8            9
-      //  +---+---+---+
-      //  | 10| 8 | 9 |
-      //  +---+---+---+
-      custom::priority_queue <int> pq;
-      pq.container.push_back(int(10));
-      pq.container.push_back(int(8));
-      pq.container.push_back(int(9));
+      //    1   2   3   4   5
+      //               1
+      //       5    9     7    3
+      custom::priority_queue <int, std::less<int>, 4> pq;
+      pq.container = {int(1), int(5), int(9), int(7), int(3)};
       // exercise
-      pq.pop();
+      bool returnValue = pq.percolateDown(1 /*indexHeap*/);
       // verify
+      //    1   2   3   4   5
       //               9
-      //         8
-      //  +---+---+
-      //  | 9 | 8 |
-      //  +---+---+
-      assertUnit(pq.container.size() == 2);
-      if (pq.container.size() == 2)
+      //       5    1     7    3
+      assertUnit(returnValue == true);
+      assertUnit(pq.container.size() == 5);
+      if (pq.container.size() == 5)
       {
          assertUnit(pq.container[0] == int(9));
-         assertUnit(pq.container[1] == int(8));
+         assertUnit(pq.container[1] == int(5));
+         assertUnit(pq.container[2] == int(1));
+         assertUnit(pq.container[3] == int(7));
+         assertUnit(pq.container[4] == int(3));
       }
       // teardown
-      teardownStandardFixture(pq);
+      pq.container.clear();
    }
-   
-   // pop from the standard fixture
-   void test_pop_standard()
+
+   // push onto a 4-ary heap, up one level
+   void test_arity_push()
    {  // setup
-      //               10
-      //         8            9
-      //      4     3      7     5
-      //  +---+---+---+---+---+---+---+---+---+
-      //  | 10| 8 | 9 | 4 | 3 | 7 | 5 |   |   |
-      //  +---+---+---+---+---+---+---+---+---+
-      custom::priority_queue <int> pq;
-      setupStandardFixture(pq);
+      //    1   2   3   4   5
+      //               9
+      //       5    1     7    3
+      custom::priority_queue <int, std::less<int>, 4> pq;
+      pq.container = {int(9), int(5), int(1), int(7), int(3)};
+      pq.container.reserve(6);
       // exercise
-      pq.pop();
+      pq.push(int(8));
       // verify
-      //    0   1   2   3   4   5
-      //  +---+---+---+---+---+---+---+---+---+
-      //  | 9 | 8 | 7 | 4 | 3 | 5 |   |   |   |
-      //  +---+---+---+---+---+---+---+---+---+
-      //                9
-      //          8            7
-      //       4     3      5
+      //    1   2   3   4   5   6
+      //               9
+      //       8    1     7    3
+      //       5
       assertUnit(pq.container.size() == 6);
       if (pq.container.size() == 6)
       {
          assertUnit(pq.container[0] == int(9));
          assertUnit(pq.container[1] == int(8));
-         assertUnit(pq.container[2] == int(7));
-         assertUnit(pq.container[3] == int(4));
+         assertUnit(pq.container[2] == int(1));
+         assertUnit(pq.container[3] == int(7));
          assertUnit(pq.container[4] == int(3));
          assertUnit(pq.container[5] == int(5));
       }
       // teardown
-      teardownStandardFixture(pq);
+      pq.container.clear();
    }
 
-   
+   // heapify a 4-ary heap with two levels
+   void test_arity_heapify()
+   {  // setup
+      //    1   2   3   4   5   6   7
+      //               1
+      //       2    3     4    5
+      //      6 7
+      custom::priority_queue <int, std::less<int>, 4> pq;
+      pq.container = {1, 2, 3, 4, 5, 6, 7};
+      // exercise
+      pq.heapify();
+      // verify
+      //    1   2   3   4   5   6   7
+      //               7
+      //       6    3     4    5
+      //      1 2
+      assertUnit(pq.container.size() == 7);
+      if (pq.container.size() == 7)
+      {
+         assertUnit(pq.container[0] == int(7));
+         assertUnit(pq.container[1] == int(6));
+         assertUnit(pq.container[2] == int(3));
+         assertUnit(pq.container[3] == int(4));
+         assertUnit(pq.container[4] == int(5));
+         assertUnit(pq.container[5] == int(1));
+         assertUnit(pq.container[6] == int(2));
+      }
+      // teardown
+      pq.container.clear();
+   }
+
+   // an 8-ary heap pops in sorted order
+   void test_arity_popOrder()
+   {  // setup
+      custom::priority_queue <int, std::less<int>, 8> pq;
+      for (int i = 0; i < 100; i++)
+         pq.push((i * 37) % 100);
+      // exercise
+      bool sorted = true;
+      for (int i = 99; i >= 0; i--)
+      {
+         sorted = sorted && pq.top() == i;
+         pq.pop();
+      }
+      // verify
+      assertUnit(sorted);
+      assertUnit(pq.empty());
+   }  // teardown
 
    /***************************************
-    * PUSH
+    * MOVES
+    * The percolate routines move a hole rather than
+    * swapping, so each level costs exactly one move.
     ***************************************/
 
-   void test_push_empty()
+   // push that stays at the bottom: only the move into the container
+   void test_moves_pushLevelZero()
    {  // setup
-      custom::priority_queue <int> pq;
-      int s(10);
+      //                10
+      //          8            9
+      //       4     3      7     5
+      custom::priority_queue <Spy> pq;
+      setupStandardFixture(pq);
+      Spy s(1);
+      Spy::reset();
       // exercise
-      pq.push(s);
+      pq.push(std::move(s));
       // verify
-      //  +----+
-      //  | 10 |
-      //  +----+
-      assertUnit(pq.container.size() == 1);
-      if (pq.container.size() == 1)
-         assertUnit(pq.container[0] == int(10));
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numSwap() == 0);
+      assertUnit(Spy::numCopyMove() + Spy::numAssignMove() == 1);
+      assertUnit(pq.container.size() == 8);
+      if (pq.container.size() == 8)
+         assertUnit(pq.container[7].get() == 1);
       // teardown
-      teardownStandardFixture(pq);
+      pq.container.clear();
    }
 
-   // push an element to the bottom of a priority queue - level zero
-   void test_push_levelZero()
+   // push that goes up two levels
+   void test_moves_pushLevelTwo()
    {  // setup
-      //  +---+---+---+---+---+---+---+---+---+
-      //  | 10| 8 | 9 | 4 | 3 | 7 | 5 |   |   |
-      //  +---+---+---+---+---+---+---+---+---+
       //                10
       //          8            9
       //       4     3      7     5
-      custom::priority_queue <int> pq;
+      custom::priority_queue <Spy> pq;
       setupStandardFixture(pq);
-      int s(1);
+      Spy s(9);
+      Spy::reset();
       // exercise
-      pq.push(s);
+      pq.push(std::move(s));
       // verify
       //    1   2   3   4   5   6   7   8
-      //  +---+---+---+---+---+---+---+---+---+
-      //  | 10| 8 | 9 | 4 | 3 | 7 | 5 | 1 |   |
-      //  +---+---+---+---+---+---+---+---+---+
       //                10
-      //          8            9
-      //       4     3      7     5
-      //      1
+      //          9            9
+      //       8     3      7     5
+      //      4
+      // one move in, one out to the side, two levels, one into the hole
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numSwap() == 0);
+      assertUnit(Spy::numCopyMove() + Spy::numAssignMove() == 1 + 1 + 2 + 1);
       assertUnit(pq.container.size() == 8);
       if (pq.container.size() == 8)
       {
-         assertUnit(pq.container[0] == int(10));
-         assertUnit(pq.container[1] == int(8));
+         assertUnit(pq.container[0].get() == 10);
+         assertUnit(pq.container[1].get() == 9);
+         assertUnit(pq.container[3].get() == 8);
+         assertUnit(pq.container[7].get() == 4);
+      }
+      // teardown
+      pq.container.clear();
+   }
+
+   // emplace that stays at the bottom: built in place, nothing moved
+   void test_moves_emplaceLevelZero()
+   {  // setup
+      //                10
+      //          8            9
+      //       4     3      7     5
+      custom::priority_queue <Spy> pq;
+      setupStandardFixture(pq);
+      Spy::reset();
+      // exercise
+      pq.emplace(1);
+      // verify
+      assertUnit(Spy::numNondefault() == 1);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      assertUnit(pq.container.size() == 8);
+      if (pq.container.size() == 8)
+         assertUnit(pq.container[7].get() == 1);
+      // teardown
+      pq.container.clear();
+   }
+
+   // emplace that goes up two levels: only the moves of the sift itself
+   void test_moves_emplaceLevelTwo()
+   {  // setup
+      //                10
+      //          8            9
+      //       4     3      7     5
+      custom::priority_queue <Spy> pq;
+      setupStandardFixture(pq);
+      Spy::reset();
+      // exercise
+      pq.emplace(9);
+      // verify
+      //                10
+      //          9            9
+      //       8     3      7     5
+      //      4
+      // one out to the side, two levels, one into the hole
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numCopyMove() + Spy::numAssignMove() == 1 + 2 + 1);
+      assertUnit(pq.container.size() == 8);
+      if (pq.container.size() == 8)
+      {
+         assertUnit(pq.container[1].get() == 9);
+         assertUnit(pq.container[3].get() == 8);
+         assertUnit(pq.container[7].get() == 4);
+      }
+      // teardown
+      pq.container.clear();
+   }
+
+   // several constructor arguments
+   void test_emplace_pair()
+   {  // setup
+      custom::priority_queue <std::pair<int, int>> pq;
+      // exercise
+      pq.emplace(3, 1);
+      pq.emplace(7, 2);
+      pq.emplace(5, 3);
+      // verify
+      assertUnit(pq.size() == 3);
+      assertUnit(pq.top().first == 7 && pq.top().second == 2);
+   }  // teardown
+
+   // copy push that goes to the top
+   void test_moves_pushCopyLevelThree()
+   {  // setup
+      //                10
+      //          8            9
+      //       4     3      7     5
+      custom::priority_queue <Spy> pq;
+      setupStandardFixture(pq);
+      Spy s(11);
+      Spy::reset();
+      // exercise
+      pq.push(s);
+      // verify
+      //    1   2   3   4   5   6   7   8
+      //                11
+      //          10            9
+      //       8     3      7     5
+      //      4
+      // one copy in, one move out to the side, three levels, one into the hole
+      assertUnit(Spy::numAssign() == 1);
+      assertUnit(Spy::numSwap() == 0);
+      assertUnit(Spy::numCopyMove() + Spy::numAssignMove() == 1 + 3 + 1);
+      assertUnit(pq.container.size() == 8);
+      if (pq.container.size() == 8)
+      {
+         assertUnit(pq.container[0].get() == 11);
+         assertUnit(pq.container[1].get() == 10);
+         assertUnit(pq.container[3].get() == 8);
+         assertUnit(pq.container[7].get() == 4);
+      }
+      // teardown
+      pq.container.clear();
+   }
+
+   // percolate down two levels
+   void test_moves_percolateDownTwoLevels()
+   {  // setup
+      //    1   2   3   4   5   6   7
+      //               5
+      //         8            10
+      //      4     3      7     9
+      custom::priority_queue <Spy> pq;
+      setupStandardFixture(pq);
+      pq.container[1-1] = Spy(5);
+      pq.container[3-1] = Spy(10);
+      pq.container[7-1] = Spy(9);
+      Spy::reset();
+      // exercise
+      bool returnValue = pq.percolateDown(1 /*indexHeap*/);
+      // verify
+      //               10
+      //         8            9
+      //      4     3      7     5
+      // one out to the side, two levels, one into the hole
+      assertUnit(returnValue == true);
+      assertUnit(Spy::numSwap() == 0);
+      assertUnit(Spy::numCopy() + Spy::numAssign() == 0);
+      assertUnit(Spy::numCopyMove() + Spy::numAssignMove() == 1 + 2 + 1);
+      if (pq.container.size() == 7)
+      {
+         assertUnit(pq.container[0].get() == 10);
+         assertUnit(pq.container[2].get() == 9);
+         assertUnit(pq.container[6].get() == 5);
+      }
+      // teardown
+      pq.container.clear();
+   }
+
+   // pop from the standard fixture
+   void test_moves_popStandard()
+   {  // setup
+      //                10
+      //          8            9
+      //       4     3      7     5
+      custom::priority_queue <Spy> pq;
+      setupStandardFixture(pq);
+      Spy::reset();
+      // exercise
+      pq.pop();
+      // verify
+      //    0   1   2   3   4   5
+      //                9
+      //          8            7
+      //       4     3      5
+      // the back out to the side, two levels, one into the hole
+      assertUnit(Spy::numSwap() == 0);
+      assertUnit(Spy::numCopy() + Spy::numAssign() == 0);
+      assertUnit(Spy::numCopyMove() + Spy::numAssignMove() == 1 + 2 + 1);
+      assertUnit(pq.container.size() == 6);
+      if (pq.container.size() == 6)
+      {
+         assertUnit(pq.container[0].get() == 9);
+         assertUnit(pq.container[2].get() == 7);
+         assertUnit(pq.container[5].get() == 5);
+      }
+      // teardown
+      pq.container.clear();
+   }
+
+   /***************************************
+    * TOP
+    ***************************************/
+
+   // top of an empty priority queue
+   void test_top_empty()
+   {  // setup
+      custom::priority_queue <int> pq;
+      int value(99);
+      // exercise
+      try
+      {
+         value = pq.top();
+         // verify
+         assertUnit(false);
+      }
+      catch (const std::out_of_range& error)
+      {
+          std::cerr << "Caught exception: " << error.what() << std::endl;
+          assertUnit(error.what() == std::string("std:out_of_range"));
+      }
+      assertUnit(value == int(99));
+      assertEmptyFixture(pq);
+   }  // teardown
+
+   // top of the standard fixture
+   void test_top_standard()
+   {  // setup
+      //  +---+---+---+---+---+---+---+---+---+
+      //  | 10| 8 | 9 | 4 | 3 | 7 | 5 |   |   |
+      //  +---+---+---+---+---+---+---+---+---+
+      custom::priority_queue <int> pq;
+      setupStandardFixture(pq);
+      int value(99);
+      // exercise
+      value = pq.top();
+      // verify
+      assertUnit(value == int(10));
+      assertStandardFixture(pq);
+      // teardown
+      teardownStandardFixture(pq);
+   }  
+
+  /***************************************
+   * POP
+   ***************************************/
+
+   // pop an empty priority queue
+   void test_pop_empty()
+   {  // setup
+      custom::priority_queue <int> pq;
+      // exercise
+      pq.pop();
+      // verify
+      assertEmptyFixture(pq);
+   }  // teardown
+
+   // pop a priority queue with a single element
+   void test_pop_one()
+   {  // setup
+      //  +----+
+      //  | 99 |
+      //  +----+
+      custom::priority_queue <int> pq;
+      pq.container.push_back(int(99));
+      // exercise
+      pq.pop();
+      // verify
+      //  +----+
+      //  |    |
+      //  +----+
+      assertEmptyFixture(pq);
+      // teardown
+   }
+
+   // pop a priority queue with two elements
+   void test_pop_two()
+   {  // setup
+      //               10
+      //         8
+      //  +---+---+
+      //  | 10| 8 |
+      //  +---+---+
+      custom::priority_queue <int> pq;
+      pq.container.push_back(int(10));
+      pq.container.push_back(int(8));
+      // exercise
+      pq.pop();
+      // verify
+      //  +---+
+      //  | 8 |
+      //  +---+
+      assertUnit(pq.container.size() == 1);
+      if (pq.container.size() == 1)
+         assertUnit(pq.container[0] == int(8));
+      // teardown
+      teardownStandardFixture(pq);
+   }
+
+   // pop a priority queue with three elements
+   void test_pop_three()
+   {  // setup
+      //               10
+      //         8            9
+      //  +---+---+---+
+      //  | 10| 8 | 9 |
+      //  +---+---+---+
+      custom::priority_queue <int> pq;
+      pq.container.push_back(int(10));
+      pq.container.push_back(int(8));
+      pq.container.push_back(int(9));
+      // exercise
+      pq.pop();
+      // verify
+      //               9
+      //         8
+      //  +---+---+
+      //  | 9 | 8 |
+      //  +---+---+
+      assertUnit(pq.container.size() == 2);
+      if (pq.container.size() == 2)
+      {
+         assertUnit(pq.container[0] == int(9));
+         assertUnit(pq.container[1] == int(8));
+      }
+      // teardown
+      teardownStandardFixture(pq);
+   }
+   
+   // pop from the standard fixture
+   void test_pop_standard()
+   {  // setup
+      //               10
+      //         8            9
+      //      4     3      7     5
+      //  +---+---+---+---+---+---+---+---+---+
+      //  | 10| 8 | 9 | 4 | 3 | 7 | 5 |   |   |
+      //  +---+---+---+---+---+---+---+---+---+
+      custom::priority_queue <int> pq;
+      setupStandardFixture(pq);
+      // exercise
+      pq.pop();
+      // verify
+      //    0   1   2   3   4   5
+      //  +---+---+---+---+---+---+---+---+---+
+      //  | 9 | 8 | 7 | 4 | 3 | 5 |   |   |   |
+      //  +---+---+---+---+---+---+---+---+---+
+      //                9
+      //          8            7
+      //       4     3      5
+      assertUnit(pq.container.size() == 6);
+      if (pq.container.size() == 6)
+      {
+         assertUnit(pq.container[0] == int(9));
+         assertUnit(pq.container[1] == int(8));
+         assertUnit(pq.container[2] == int(7));
+         assertUnit(pq.container[3] == int(4));
+         assertUnit(pq.container[4] == int(3));
+         assertUnit(pq.container[5] == int(5));
+      }
+      // teardown
+      teardownStandardFixture(pq);
+   }
+
+   
+
+   /***************************************
+    * POP BOTTOM UP
+    ***************************************/
+
+   // bottom-up pop of an empty priority queue
+   void test_popBottomUp_empty()
+   {  // setup
+      custom::priority_queue <int> pq;
+      // exercise
+      pq.pop_bottom_up();
+      // verify
+      assertEmptyFixture(pq);
+   }  // teardown
+
+   // bottom-up pop from the standard fixture
+   void test_popBottomUp_standard()
+   {  // setup
+      //                10
+      //          8            9
+      //       4     3      7     5
+      custom::priority_queue <Spy> pq;
+      setupStandardFixture(pq);
+      Spy::reset();
+      // exercise
+      pq.pop_bottom_up();
+      // verify
+      //    0   1   2   3   4   5
+      //                9
+      //          8            7
+      //       4     3      5
+      // one to choose between 8 and 9, one to see that 5 stays below 7
+      assertUnit(Spy::numLessthan() == 2);
+      assertUnit(pq.container.size() == 6);
+      if (pq.container.size() == 6)
+      {
+         assertUnit(pq.container[0].get() == 9);
+         assertUnit(pq.container[1].get() == 8);
+         assertUnit(pq.container[2].get() == 7);
+         assertUnit(pq.container[3].get() == 4);
+         assertUnit(pq.container[4].get() == 3);
+         assertUnit(pq.container[5].get() == 5);
+      }
+      // teardown
+      pq.container.clear();
+   }
+
+   // bottom-up pop comes out in the same order as pop
+   void test_popBottomUp_order()
+   {  // setup
+      custom::priority_queue <int> pqTop;
+      custom::priority_queue <int> pqBottom;
+      for (int i = 0; i < 200; i++)
+      {
+         pqTop.push((i * 71) % 53);
+         pqBottom.push((i * 71) % 53);
+      }
+      // exercise
+      bool same = true;
+      while (!pqTop.empty() && !pqBottom.empty())
+      {
+         same = same && pqTop.top() == pqBottom.top();
+         pqTop.pop();
+         pqBottom.pop_bottom_up();
+      }
+      // verify
+      assertUnit(same);
+      assertUnit(pqTop.empty());
+      assertUnit(pqBottom.empty());
+   }  // teardown
+
+   // bottom-up pop makes far fewer comparisons
+   void test_popBottomUp_comparisons()
+   {  // setup
+      custom::priority_queue <Spy> pqTop;
+      custom::priority_queue <Spy> pqBottom;
+      for (int i = 0; i < 255; i++)
+      {
+         pqTop.push(Spy((i * 97) % 255));
+         pqBottom.push(Spy((i * 97) % 255));
+      }
+      // exercise
+      Spy::reset();
+      while (!pqTop.empty())
+         pqTop.pop();
+      int numTop = Spy::numLessthan();
+      Spy::reset();
+      while (!pqBottom.empty())
+         pqBottom.pop_bottom_up();
+      int numBottom = Spy::numLessthan();
+      // verify
+      assertUnit(numBottom < numTop * 3 / 4);
+   }  // teardown
+
+   /***************************************
+    * EXCHANGE
+    * replace_top and push_pop: a pop and a
+    * push for the price of one sift down
+    ***************************************/
+
+   // nothing to replace
+   void test_replaceTop_empty()
+   {  // setup
+      custom::priority_queue <int> pq;
+      // exercise
+      try
+      {
+         pq.replace_top(5);
+         // verify
+         assertUnit(false);
+      }
+      catch (const std::out_of_range& error)
+      {
+          assertUnit(error.what() == std::string("std:out_of_range"));
+      }
+      assertEmptyFixture(pq);
+   }  // teardown
+
+   // the top goes, 6 goes down two levels
+   void test_replaceTop_standard()
+   {  // setup
+      //                10
+      //          8            9
+      //       4     3      7     5
+      custom::priority_queue <int> pq;
+      setupStandardFixture(pq);
+      // exercise
+      int top = pq.replace_top(6);
+      // verify
+      //                9
+      //          8            7
+      //       4     3      6     5
+      assertUnit(top == 10);
+      assertUnit(pq.container.size() == 7);
+      if (pq.container.size() == 7)
+      {
+         assertUnit(pq.container[0] == int(9));
+         assertUnit(pq.container[1] == int(8));
+         assertUnit(pq.container[2] == int(7));
+         assertUnit(pq.container[3] == int(4));
+         assertUnit(pq.container[4] == int(3));
+         assertUnit(pq.container[5] == int(6));
+         assertUnit(pq.container[6] == int(5));
+      }
+      // teardown
+      teardownStandardFixture(pq);
+   }
+
+   // one sift down: two compares a level, one move a level
+   void test_replaceTop_oneSift()
+   {  // setup
+      custom::priority_queue <Spy> pq;
+      setupStandardFixture(pq);
+      Spy s(6);
+      Spy::reset();
+      // exercise
+      Spy top = pq.replace_top(std::move(s));
+      // verify
+      assertUnit(top.get() == 10);
+      assertUnit(Spy::numLessthan() == 2 + 2);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAssignMove() == 2 + 1);
+      assertUnit(pq.container.size() == 7);
+      if (pq.container.size() == 7)
+      {
+         assertUnit(pq.container[0].get() == 9);
+         assertUnit(pq.container[5].get() == 6);
+      }
+      // teardown
+      pq.container.clear();
+   }
+
+   // into an empty queue and straight back out
+   void test_pushPop_empty()
+   {  // setup
+      custom::priority_queue <int> pq;
+      // exercise
+      int value = pq.push_pop(5);
+      // verify
+      assertUnit(value == 5);
+      assertEmptyFixture(pq);
+   }  // teardown
+
+   // better than the top: one compare, the heap untouched
+   void test_pushPop_better()
+   {  // setup
+      custom::priority_queue <Spy> pq;
+      setupStandardFixture(pq);
+      Spy s(11);
+      Spy::reset();
+      // exercise
+      Spy value = pq.push_pop(std::move(s));
+      // verify
+      assertUnit(value.get() == 11);
+      assertUnit(Spy::numLessthan() == 1);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      assertUnit(pq.container.size() == 7);
+      if (pq.container.size() == 7)
+         assertUnit(pq.container[0].get() == 10);
+      // teardown
+      pq.container.clear();
+   }
+
+   // as good as the top: it could come back out, so it does
+   void test_pushPop_equal()
+   {  // setup
+      custom::priority_queue <int> pq;
+      setupStandardFixture(pq);
+      // exercise
+      int value = pq.push_pop(10);
+      // verify
+      assertUnit(value == 10);
+      assertStandardFixture(pq);
+      // teardown
+      teardownStandardFixture(pq);
+   }
+
+   // worse than the top: the top comes out, 6 goes down
+   void test_pushPop_worse()
+   {  // setup
+      custom::priority_queue <int> pq;
+      setupStandardFixture(pq);
+      // exercise
+      int value = pq.push_pop(6);
+      // verify
+      assertUnit(value == 10);
+      assertUnit(pq.size() == 7);
+      assertUnit(pq.top() == 9);
+      assertUnit(isHeap(pq));
+      // teardown
+      teardownStandardFixture(pq);
+   }
+
+   /***************************************
+    * PUSH
+    ***************************************/
+
+   void test_push_empty()
+   {  // setup
+      custom::priority_queue <int> pq;
+      int s(10);
+      // exercise
+      pq.push(s);
+      // verify
+      //  +----+
+      //  | 10 |
+      //  +----+
+      assertUnit(pq.container.size() == 1);
+      if (pq.container.size() == 1)
+         assertUnit(pq.container[0] == int(10));
+      // teardown
+      teardownStandardFixture(pq);
+   }
+
+   // push an element to the bottom of a priority queue - level zero
+   void test_push_levelZero()
+   {  // setup
+      //  +---+---+---+---+---+---+---+---+---+
+      //  | 10| 8 | 9 | 4 | 3 | 7 | 5 |   |   |
+      //  +---+---+---+---+---+---+---+---+---+
+      //                10
+      //          8            9
+      //       4     3      7     5
+      custom::priority_queue <int> pq;
+      setupStandardFixture(pq);
+      int s(1);
+      // exercise
+      pq.push(s);
+      // verify
+      //    1   2   3   4   5   6   7   8
+      //  +---+---+---+---+---+---+---+---+---+
+      //  | 10| 8 | 9 | 4 | 3 | 7 | 5 | 1 |   |
+      //  +---+---+---+---+---+---+---+---+---+
+      //                10
+      //          8            9
+      //       4     3      7     5
+      //      1
+      assertUnit(pq.container.size() == 8);
+      if (pq.container.size() == 8)
+      {
+         assertUnit(pq.container[0] == int(10));
+         assertUnit(pq.container[1] == int(8));
          assertUnit(pq.container[2] == int(9));
          assertUnit(pq.container[3] == int(4));
          assertUnit(pq.container[4] == int(3));
@@ -1225,6 +2047,378 @@ public:
       teardownStandardFixture(pq);
    }
 
+   /***************************************
+    * BATCH
+    * push_batch and pop_batch, sequential and with
+    * the work split among threads
+    ***************************************/
+
+   // a small batch into a big heap is sifted up
+   void test_pushBatch_siftUp()
+   {  // setup
+      custom::priority_queue <int> pq;
+      for (int i = 0; i < 100; i++)
+         pq.push(i);
+      int batch[] = { 500, -3, 42 };
+      // exercise
+      pq.push_batch(batch, batch + 3);
+      // verify
+      assertUnit(pq.size() == 103);
+      assertUnit(pq.top() == 500);
+      assertUnit(isHeap(pq));
+   }  // teardown
+
+   // a batch as big as the heap rebuilds it
+   void test_pushBatch_rebuild()
+   {  // setup
+      custom::priority_queue <int> pq;
+      pq.push(5);
+      std::vector<int> batch;
+      for (int i = 0; i < 1000; i++)
+         batch.push_back((i * 7919) % 1000);
+      // exercise
+      pq.push_batch(batch.begin(), batch.end());
+      // verify
+      assertUnit(pq.size() == 1001);
+      assertUnit(pq.top() == 999);
+      assertUnit(isHeap(pq));
+   }  // teardown
+
+   // big enough for four threads, and still a heap
+   void test_pushBatch_parallel()
+   {  // setup
+      custom::priority_queue <int> pq;
+      std::vector<int> batch;
+      for (int i = 0; i < 300000; i++)
+         batch.push_back((int)((i * 2654435761u) % 300007));
+      // exercise
+      pq.push_batch(batch.begin(), batch.end(), 4);
+      // verify
+      assertUnit(pq.size() == 300000);
+      assertUnit(isHeap(pq));
+   }  // teardown
+
+   // the subtrees split the same way with four children
+   void test_pushBatch_parallelArity()
+   {  // setup
+      custom::priority_queue <int, std::less<int>, 4> pq;
+      std::vector<int> batch;
+      for (int i = 0; i < 200000; i++)
+         batch.push_back((int)((i * 2654435761u) % 200003));
+      // exercise
+      pq.push_batch(batch.begin(), batch.end(), 3);
+      // verify
+      assertUnit(pq.size() == 200000);
+      assertUnit(isHeap(pq));
+   }  // teardown
+
+   // nothing asked, nothing taken
+   void test_popBatch_zero()
+   {  // setup
+      custom::priority_queue <int> pq;
+      setupStandardFixture(pq);
+      custom::vector <int> out;
+      // exercise
+      size_t num = pq.pop_batch(0, out);
+      // verify
+      assertUnit(num == 0);
+      assertUnit(out.empty());
+      assertStandardFixture(pq);
+   }  // teardown
+
+   // a few are popped one at a time, best first
+   void test_popBatch_few()
+   {  // setup
+      custom::priority_queue <int> pq;
+      setupStandardFixture(pq);
+      custom::vector <int> out;
+      out.push_back(99);
+      // exercise
+      size_t num = pq.pop_batch(2, out);
+      // verify
+      assertUnit(num == 2);
+      assertUnit(out.size() == 3);
+      assertUnit(out[0] == 99 && out[1] == 10 && out[2] == 9);
+      assertUnit(pq.size() == 5);
+      assertUnit(pq.top() == 8);
+      assertUnit(isHeap(pq));
+   }  // teardown
+
+   // many are partitioned off, sorted, and the rest rebuilt
+   void test_popBatch_many()
+   {  // setup
+      custom::priority_queue <int> pq;
+      for (int i = 0; i < 1000; i++)
+         pq.push((i * 7919) % 1000);
+      custom::vector <int> out;
+      // exercise
+      size_t num = pq.pop_batch(600, out);
+      // verify
+      assertUnit(num == 600);
+      bool exact = out.size() == 600;
+      for (size_t i = 0; exact && i < out.size(); i++)
+         exact = out[i] == 999 - (int)i;
+      assertUnit(exact);
+      assertUnit(pq.size() == 400);
+      assertUnit(pq.top() == 399);
+      assertUnit(isHeap(pq));
+   }  // teardown
+
+   // the sort and the rebuild split among threads
+   void test_popBatch_parallel()
+   {  // setup
+      custom::priority_queue <int> pq;
+      std::vector<int> batch;
+      for (int i = 0; i < 300000; i++)
+         batch.push_back(i);
+      for (size_t i = batch.size() - 1; i > 0; i--)
+         std::swap(batch[i], batch[(i * 2654435761u) % (i + 1)]);
+      pq.push_batch(batch.begin(), batch.end());
+      custom::vector <int> out;
+      // exercise
+      size_t num = pq.pop_batch(150000, out, 4);
+      // verify
+      assertUnit(num == 150000);
+      bool exact = out.size() == 150000;
+      for (size_t i = 0; exact && i < out.size(); i++)
+         exact = out[i] == 299999 - (int)i;
+      assertUnit(exact);
+      assertUnit(pq.size() == 150000);
+      assertUnit(pq.top() == 149999);
+      assertUnit(isHeap(pq));
+   }  // teardown
+
+   // asking for more than there is takes everything
+   void test_popBatch_all()
+   {  // setup
+      custom::priority_queue <int> pq;
+      setupStandardFixture(pq);
+      custom::vector <int> out;
+      // exercise
+      size_t num = pq.pop_batch(100, out);
+      // verify
+      assertUnit(num == 7);
+      assertUnit(out.size() == 7);
+      assertUnit(out[0] == 10 && out[3] == 7 && out[6] == 3);
+      assertUnit(pq.empty());
+   }  // teardown
+
+   // assign throws away what was there
+   void test_assign_replaces()
+   {  // setup
+      custom::priority_queue <int> pq;
+      pq.push(100);
+      pq.push(200);
+      int values[] = { 3, 9, 4, 1, 8 };
+      // exercise
+      pq.assign(values, values + 5);
+      // verify
+      assertUnit(pq.size() == 5);
+      assertUnit(pq.top() == 9);
+      assertUnit(isHeap(pq));
+   }  // teardown
+
+   // assigning fewer keeps the buffer
+   void test_assign_keepsCapacity()
+   {  // setup
+      custom::priority_queue <int> pq;
+      for (int i = 0; i < 20; i++)
+         pq.push(i);
+      size_t capacity = pq.container.capacity();
+      int values[] = { 3, 9, 4 };
+      // exercise
+      pq.assign(values, values + 3);
+      // verify
+      assertUnit(pq.container.capacity() == capacity);
+      assertUnit(pq.size() == 3);
+      assertUnit(pq.top() == 9);
+   }  // teardown
+
+   // a few small ones sift up: one compare each, no rebuild
+   void test_appendAndHeapify_siftUp()
+   {  // setup
+      custom::priority_queue <Spy> pq;
+      for (int i = 0; i < 100; i++)
+         pq.push(Spy(i + 10));
+      Spy batch[] = { Spy(1), Spy(2), Spy(3) };
+      Spy::reset();
+      // exercise
+      pq.append_and_heapify(std::make_move_iterator(batch), std::make_move_iterator(batch + 3));
+      // verify
+      assertUnit(Spy::numLessthan() == 3);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(pq.size() == 103);
+      assertUnit(isHeap(pq));
+   }  // teardown
+
+   // a batch bigger than the heap rebuilds it in linear time
+   void test_appendAndHeapify_rebuild()
+   {  // setup
+      custom::priority_queue <Spy> pq;
+      for (int i = 0; i < 100; i++)
+         pq.push(Spy(i));
+      std::vector<Spy> batch;
+      for (int i = 100; i < 1100; i++)
+         batch.push_back(Spy(i));
+      Spy::reset();
+      // exercise
+      pq.append_and_heapify(std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+      // verify: sifting each up would take about 10 compares apiece
+      assertUnit(Spy::numLessthan() < 2 * 2 * 1100);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(pq.size() == 1100);
+      assertUnit(pq.top().get() == 1099);
+      assertUnit(isHeap(pq));
+   }  // teardown
+
+   // plain iterators copy, so the caller keeps its batch
+   void test_appendAndHeapify_copies()
+   {  // setup
+      custom::priority_queue <Spy> pq;
+      for (int i = 0; i < 10; i++)
+         pq.push(Spy(i));
+      const Spy batch[] = { Spy(20), Spy(30) };
+      Spy::reset();
+      // exercise
+      pq.append_and_heapify(batch, batch + 2);
+      // verify
+      assertUnit(Spy::numCopy() + Spy::numAssign() == 2);
+      assertUnit(batch[0].get() == 20);
+      assertUnit(batch[1].get() == 30);
+      assertUnit(pq.size() == 12);
+      assertUnit(pq.top().get() == 30);
+      assertUnit(isHeap(pq));
+   }  // teardown
+
+   /***************************************
+    * MERGE
+    ***************************************/
+
+   // nothing to take
+   void test_merge_emptyIntoStandard()
+   {  // setup
+      custom::priority_queue <int> pq;
+      setupStandardFixture(pq);
+      custom::priority_queue <int> rhs;
+      // exercise
+      pq.merge(std::move(rhs));
+      // verify
+      assertStandardFixture(pq);
+      assertEmptyFixture(rhs);
+      // teardown
+      teardownStandardFixture(pq);
+   }
+
+   // into an empty queue the containers just trade places
+   void test_merge_standardIntoEmpty()
+   {  // setup
+      custom::priority_queue <int> pq;
+      custom::priority_queue <int> rhs;
+      setupStandardFixture(rhs);
+      const int * data = &rhs.container[0];
+      // exercise
+      pq.merge(std::move(rhs));
+      // verify
+      assertStandardFixture(pq);
+      assertUnit(&pq.container[0] == data);
+      assertEmptyFixture(rhs);
+      // teardown
+      teardownStandardFixture(pq);
+   }
+
+   // merging with itself changes nothing
+   void test_merge_self()
+   {  // setup
+      custom::priority_queue <int> pq;
+      setupStandardFixture(pq);
+      // exercise
+      pq.merge(std::move(pq));
+      // verify
+      assertStandardFixture(pq);
+      // teardown
+      teardownStandardFixture(pq);
+   }
+
+   // a few small ones into a big heap: moved in and sifted up, not rebuilt
+   void test_merge_smallSiftsUp()
+   {  // setup
+      custom::priority_queue <Spy> pq;
+      for (int i = 0; i < 100; i++)
+         pq.push(Spy(i + 10));
+      custom::priority_queue <Spy> rhs;
+      rhs.push(Spy(1));
+      rhs.push(Spy(2));
+      rhs.push(Spy(3));
+      Spy::reset();
+      // exercise
+      pq.merge(std::move(rhs));
+      // verify
+      assertUnit(Spy::numLessthan() == 3);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(pq.size() == 103);
+      assertUnit(pq.top().get() == 109);
+      assertUnit(isHeap(pq));
+      assertUnit(rhs.empty());
+   }  // teardown
+
+   // two of about the same size: one rebuild
+   void test_merge_similarRebuilds()
+   {  // setup
+      custom::priority_queue <Spy> pq;
+      custom::priority_queue <Spy> rhs;
+      for (int i = 0; i < 500; i++)
+      {
+         pq.push(Spy(i * 2));
+         rhs.push(Spy(i * 2 + 1));
+      }
+      Spy::reset();
+      // exercise
+      pq.merge(std::move(rhs));
+      // verify: sifting each up would take about 10 compares apiece
+      assertUnit(Spy::numLessthan() < 2 * 2 * 1000);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(pq.size() == 1000);
+      assertUnit(pq.top().get() == 999);
+      assertUnit(isHeap(pq));
+      assertUnit(rhs.empty());
+   }  // teardown
+
+   // the smaller queue is the one that gets moved
+   void test_merge_keepsLarger()
+   {  // setup
+      custom::priority_queue <int> pq;
+      pq.push(4);
+      pq.push(11);
+      custom::priority_queue <int> rhs;
+      for (int i = 0; i < 20; i++)
+         rhs.push(i);
+      rhs.container.reserve(30);
+      const int * data = &rhs.container[0];
+      // exercise
+      pq.merge(std::move(rhs));
+      // verify
+      assertUnit(&pq.container[0] == data);
+      assertUnit(pq.size() == 22);
+      assertUnit(pq.top() == 19);
+      assertUnit(isHeap(pq));
+      assertUnit(rhs.empty());
+   }  // teardown
+
+   /***************************************************
+    * IS HEAP
+    * No child belongs above its parent
+    ***************************************************/
+   template <class T, class Compare, size_t Arity>
+   bool isHeap(const custom::priority_queue <T, Compare, Arity> & pq)
+   {
+      for (size_t i = 2; i <= pq.size(); i++)
+         if (pq.compare(pq.container[pq.indexParent(i) - 1], pq.container[i - 1]))
+            return false;
+      return true;
+   }
+
    /***************************************************
     * SETUP STANDARD FIXTURE
     *                 10
@@ -1241,6 +2435,12 @@ public:
       pq.container.reserve(9);
    }
    
+   void setupStandardFixture(custom::priority_queue <Spy>& pq)
+   {
+      pq.container = {Spy(10), Spy(8), Spy(9), Spy(4), Spy(3), Spy(7), Spy(5)};
+      pq.container.reserve(9);
+   }
+   
    /***************************************************
     * VERIFY EMPTY FIXTURE
     ***************************************************/
@@ -0,0 +1,251 @@
+/***********************************************************************
+ * Header:
+ *    TEST RADIX HEAP
+ * Summary:
+ *    Unit tests for the radix heap
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "radix_heap.h"
+#include "unitTest.h"
+
+#include <cassert>
+#include <string>
+
+class TestRadixHeap : public UnitTest
+{
+
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+
+      // Access
+      test_top_empty();
+      test_top_standard();
+      test_top_keepsBound();
+
+      // Insert
+      test_push_buckets();
+      test_push_belowLast();
+      test_push_equalLast();
+
+      // Remove
+      test_pop_standard();
+      test_pop_redistribute();
+      test_pop_monotone();
+
+      report("RadixHeap");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // default constructor, no allocations
+   void test_construct_default()
+   {  // setup
+      // exercise
+      custom::radix_heap <uint32_t, int> heap;
+      // verify
+      assertUnit(heap.empty());
+      assertUnit(heap.last == 0);
+      assertUnit(heap.NUM_BUCKETS == 33);
+      for (int i = 0; i < heap.NUM_BUCKETS; i++)
+         assertUnit(heap.buckets[i].capacity() == 0);
+   }  // teardown
+
+   /***************************************
+    * TOP
+    ***************************************/
+
+   // top of an empty heap
+   void test_top_empty()
+   {  // setup
+      custom::radix_heap <uint32_t, int> heap;
+      bool thrown = false;
+      // exercise
+      try
+      {
+         heap.top();
+      }
+      catch (const std::out_of_range &)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+   }  // teardown
+
+   // top is the smallest key
+   void test_top_standard()
+   {  // setup
+      custom::radix_heap <uint32_t, std::string> heap;
+      heap.push(10, "ten");
+      heap.push(3, "three");
+      heap.push(7, "seven");
+      // exercise
+      auto top = heap.top();
+      // verify
+      assertUnit(top.first == 3);
+      assertUnit(top.second == "three");
+      assertUnit(heap.last == 0);
+   }  // teardown
+
+   // looking at the top does not stop a smaller key from coming in
+   void test_top_keepsBound()
+   {  // setup
+      custom::radix_heap <uint32_t, int> heap;
+      heap.push(10, 10);
+      heap.push(20, 20);
+      assertUnit(heap.top().first == 10);
+      // exercise
+      heap.push(8, 8);     // the bucket of 10
+      assertUnit(heap.top().first == 8);
+      heap.push(5, 5);     // a bucket before it
+      // verify
+      assertUnit(heap.size() == 4);
+      assertUnit(heap.top().first == 5);
+      assertUnit(heap.last == 0);
+      assertUnit(heap.buckets[0].empty());
+   }  // teardown
+
+   /***************************************
+    * PUSH
+    ***************************************/
+
+   // keys land in the bucket of their highest differing bit
+   void test_push_buckets()
+   {  // setup
+      custom::radix_heap <uint32_t, int> heap;
+      // exercise
+      heap.push(0, 0);
+      heap.push(1, 1);
+      heap.push(3, 3);
+      heap.push(4, 4);
+      heap.push(255, 255);
+      // verify
+      assertUnit(heap.size() == 5);
+      assertUnit(heap.buckets[0].size() == 1);
+      assertUnit(heap.buckets[1].size() == 1);
+      assertUnit(heap.buckets[2].size() == 1);
+      assertUnit(heap.buckets[3].size() == 1);
+      assertUnit(heap.buckets[8].size() == 1);
+   }  // teardown
+
+   // a key below the last popped key is rejected
+   void test_push_belowLast()
+   {  // setup
+      custom::radix_heap <uint32_t, int> heap;
+      heap.push(5, 5);
+      heap.pop();
+      bool thrown = false;
+      // exercise
+      try
+      {
+         heap.push(4, 4);
+      }
+      catch (const std::invalid_argument &)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(heap.empty());
+   }  // teardown
+
+   // a key equal to the last popped key goes straight to bucket 0
+   void test_push_equalLast()
+   {  // setup
+      custom::radix_heap <uint32_t, int> heap;
+      heap.push(5, 5);
+      heap.push(9, 9);
+      heap.pop();
+      // exercise
+      heap.push(5, 50);
+      // verify
+      assertUnit(heap.buckets[0].size() == 1);
+      assertUnit(heap.top().second == 50);
+   }  // teardown
+
+   /***************************************
+    * POP
+    ***************************************/
+
+   // pop everything in order
+   void test_pop_standard()
+   {  // setup
+      custom::radix_heap <uint32_t, int> heap;
+      int keys[] = {10, 8, 9, 4, 3, 7, 5};
+      for (int i = 0; i < 7; i++)
+         heap.push(keys[i], keys[i] * 10);
+      int expected[] = {3, 4, 5, 7, 8, 9, 10};
+      bool sorted = true;
+      // exercise
+      for (int i = 0; i < 7; i++)
+      {
+         sorted = sorted && heap.top().first == uint32_t(expected[i]);
+         sorted = sorted && heap.top().second == expected[i] * 10;
+         heap.pop();
+      }
+      // verify
+      assertUnit(sorted);
+      assertUnit(heap.empty());
+   }  // teardown
+
+   // emptying bucket 0 spreads the next bucket into lower ones
+   void test_pop_redistribute()
+   {  // setup
+      custom::radix_heap <uint32_t, int> heap;
+      heap.push(0, 0);
+      heap.push(12, 12);   // 1100
+      heap.push(13, 13);   // 1101
+      heap.push(15, 15);   // 1111
+      heap.pop();          // bucket 0 is now empty, the rest are in bucket 4
+      // exercise
+      heap.pop();
+      // verify
+      assertUnit(heap.last == 12);
+      assertUnit(heap.buckets[4].size() == 0);
+      assertUnit(heap.buckets[0].size() == 0);   // 12 was popped
+      assertUnit(heap.buckets[1].size() == 1);   // 13
+      assertUnit(heap.buckets[2].size() == 1);   // 15
+      assertUnit(heap.top().first == 13);
+   }  // teardown
+
+   // a Dijkstra-like workload: every push is at least the key just popped
+   void test_pop_monotone()
+   {  // setup
+      custom::radix_heap <uint64_t, int> heap;
+      heap.push(0, 0);
+      uint64_t previous = 0;
+      bool sorted = true;
+      int count = 0;
+      // exercise
+      while (!heap.empty() && count < 5000)
+      {
+         uint64_t key = heap.top().first;
+         sorted = sorted && previous <= key;
+         previous = key;
+         heap.pop();
+         count++;
+         if (count < 2000)
+         {
+            heap.push(key + (count * 7919) % 1000, count);
+            heap.push(key + (count * 104729) % 100000, count);
+         }
+      }
+      // verify
+      assertUnit(sorted);
+      assertUnit(count == 4000 - 1);
+      assertUnit(heap.empty());
+   }  // teardown
+};
+
+#endif // DEBUG
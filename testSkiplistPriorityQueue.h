@@ -0,0 +1,328 @@
+/***********************************************************************
+ * Header:
+ *    TEST SKIPLIST PRIORITY QUEUE
+ * Summary:
+ *    Unit and stress tests for the lock-free skiplist priority queue
+ *    and the epoch domain that reclaims its nodes
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "skiplist_priority_queue.h"
+#include "epoch.h"
+#include "unitTest.h"
+#include "testConcurrent.h"
+
+#include <cassert>
+#include <thread>    // for std::thread
+#include <vector>    // for std::vector
+
+class TestSkiplistPQueue : public UnitTest
+{
+
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+
+      // Insert
+      test_push_levelZero();
+      test_push_order();
+
+      // Remove
+      test_tryPop_empty();
+      test_tryPop_order();
+      test_tryPop_minHeap();
+      test_tryPop_restructure();
+      test_tryPop_pushBehindPrefix();
+
+      // Reclaim
+      test_epoch_retireWhilePinned();
+      test_epoch_nested();
+
+      // Threads
+      test_threads_stress();
+      test_threads_orderPerProducer();
+
+      report("SkiplistPQueue");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // every level of the head is the end of the list
+   void test_construct_default()
+   {  // setup
+      // exercise
+      custom::skiplist_priority_queue <int> q;
+      // verify
+      assertUnit(q.empty());
+      bool allNull = true;
+      for (size_t i = 0; i < 24; i++)
+         allNull = allNull && q.head[i].load() == 0;
+      assertUnit(allNull);
+   }  // teardown
+
+   /***************************************
+    * PUSH
+    ***************************************/
+
+   // the first push is linked at level 0 and finished inserting
+   void test_push_levelZero()
+   {  // setup
+      custom::skiplist_priority_queue <int> q;
+      // exercise
+      q.push(7);
+      // verify
+      typedef custom::skiplist_priority_queue <int>::Node Node;
+      Node * first = custom::skiplist_priority_queue <int>::node(q.head[0].load());
+      assertUnit(first != nullptr);
+      if (first)
+      {
+         assertUnit(first->data == 7);
+         assertUnit(!first->inserting.load());
+         assertUnit(first->next()[0].load() == 0);
+      }
+      assertUnit(!q.empty());
+   }  // teardown
+
+   // level 0 is in pop order: largest first
+   void test_push_order()
+   {  // setup
+      custom::skiplist_priority_queue <int> q;
+      // exercise
+      int values[] = {5, 9, 1, 7, 3};
+      for (int i = 0; i < 5; i++)
+         q.push(values[i]);
+      // verify
+      typedef custom::skiplist_priority_queue <int>::Node Node;
+      int expected[] = {9, 7, 5, 3, 1};
+      Node * p = custom::skiplist_priority_queue <int>::node(q.head[0].load());
+      bool sorted = true;
+      for (int i = 0; i < 5; i++)
+      {
+         sorted = sorted && p && p->data == expected[i];
+         p = p ? custom::skiplist_priority_queue <int>::node(p->next()[0].load()) : nullptr;
+      }
+      assertUnit(sorted);
+      assertUnit(p == nullptr);
+   }  // teardown
+
+   /***************************************
+    * TRY POP
+    ***************************************/
+
+   // nothing to pop
+   void test_tryPop_empty()
+   {  // setup
+      custom::skiplist_priority_queue <int> q;
+      int value = 99;
+      // exercise
+      bool popped = q.try_pop(value);
+      // verify
+      assertUnit(!popped);
+      assertUnit(value == 99);
+   }  // teardown
+
+   // with one thread it is an exact priority queue
+   void test_tryPop_order()
+   {  // setup
+      custom::skiplist_priority_queue <int> q;
+      for (int i = 0; i < 500; i++)
+         q.push((i * 211) % 500);
+      bool sorted = true;
+      int value;
+      // exercise
+      for (int i = 499; i >= 0; i--)
+         sorted = sorted && q.try_pop(value) && value == i;
+      // verify
+      assertUnit(sorted);
+      assertUnit(q.empty());
+      assertUnit(!q.try_pop(value));
+   }  // teardown
+
+   // the comparator flips the order
+   void test_tryPop_minHeap()
+   {  // setup
+      custom::skiplist_priority_queue <int, std::greater<int>> q;
+      for (int i = 0; i < 100; i++)
+         q.push((i * 37) % 100);
+      bool sorted = true;
+      int value;
+      // exercise
+      for (int i = 0; i < 100; i++)
+         sorted = sorted && q.try_pop(value) && value == i;
+      // verify
+      assertUnit(sorted);
+   }  // teardown
+
+   // a long deleted prefix is cut off and the head does not point into it
+   void test_tryPop_restructure()
+   {  // setup
+      typedef custom::skiplist_priority_queue <int> Queue;
+      Queue q;
+      for (int i = 0; i < 200; i++)
+         q.push(i);
+      int value;
+      // exercise
+      for (int i = 0; i < 100; i++)
+         q.try_pop(value);
+      // verify
+      // the prefix left at the front is shorter than the bound
+      size_t numDeleted = 0;
+      uintptr_t link = q.head[0].load();
+      while (Queue::isMarked(link))
+      {
+         numDeleted++;
+         link = Queue::node(link)->next()[0].load();
+      }
+      assertUnit(numDeleted < Queue::BOUND_OFFSET);
+      assertUnit(Queue::node(link)->data == 99);
+      // every upper level of the head points at a node still linked at level 0
+      bool linked = true;
+      for (size_t i = 1; i < Queue::MAX_LEVEL; i++)
+      {
+         Queue::Node * target = Queue::node(q.head[i].load());
+         Queue::Node * p = Queue::node(q.head[0].load());
+         while (p && p != target)
+            p = Queue::node(p->next()[0].load());
+         linked = linked && p == target;
+      }
+      assertUnit(linked);
+   }  // teardown
+
+   // a new best goes behind the deleted prefix, which is left as it was
+   void test_tryPop_pushBehindPrefix()
+   {  // setup
+      typedef custom::skiplist_priority_queue <int> Queue;
+      Queue q;
+      for (int i = 0; i < 10; i++)
+         q.push(i);
+      int value;
+      for (int i = 0; i < 3; i++)
+         q.try_pop(value);
+      // exercise
+      q.push(20);
+      // verify
+      size_t numDeleted = 0;
+      uintptr_t link = q.head[0].load();
+      while (Queue::isMarked(link))
+      {
+         numDeleted++;
+         link = Queue::node(link)->next()[0].load();
+      }
+      assertUnit(numDeleted == 3);
+      assertUnit(Queue::node(link)->data == 20);
+      assertUnit(q.try_pop(value) && value == 20);
+      assertUnit(q.try_pop(value) && value == 6);
+   }  // teardown
+
+   /***************************************
+    * EPOCH
+    ***************************************/
+
+   static void countDelete(void * p) { (*static_cast<int *>(p))++; }
+
+   // nothing retired is freed while a thread is still pinned
+   void test_epoch_retireWhilePinned()
+   {  // setup
+      custom::epoch_domain & domain = custom::epoch_domain::instance();
+      int numDeleted = 0;
+      std::atomic<bool> pinned(false);
+      std::atomic<bool> release(false);
+      std::thread reader([&]()
+      {
+         custom::epoch_domain::guard guard;
+         pinned.store(true);
+         while (!release.load())
+            std::this_thread::yield();
+      });
+      while (!pinned.load())
+         std::this_thread::yield();
+      // exercise
+      domain.retire(&numDeleted, &countDelete);
+      for (int i = 0; i < 10; i++)
+      {
+         domain.tryAdvance();
+         domain.collect();
+      }
+      int numWhilePinned = numDeleted;
+      release.store(true);
+      reader.join();
+      for (int i = 0; i < 10; i++)
+      {
+         domain.tryAdvance();
+         domain.collect();
+      }
+      // verify
+      assertUnit(numWhilePinned == 0);
+      assertUnit(numDeleted == 1);
+   }  // teardown
+
+   // an inner guard does not unpin the outer one
+   void test_epoch_nested()
+   {  // setup
+      custom::epoch_domain & domain = custom::epoch_domain::instance();
+      // exercise
+      custom::epoch_domain::guard outer;
+      {
+         custom::epoch_domain::guard inner;
+      }
+      // verify
+      assertUnit(domain.local().nesting == 1);
+      assertUnit(domain.local().pinned.load() & 1);
+   }  // teardown
+
+   /***************************************
+    * THREADS
+    ***************************************/
+
+   // four producers and four consumers: nothing lost, nothing twice
+   void test_threads_stress()
+   {  // setup
+      custom::skiplist_priority_queue <int> q;
+      // exercise
+      bool once = producersConsumers(q, 4, 20000);
+      // verify
+      assertUnit(once);
+      assertUnit(q.empty());
+   }  // teardown
+
+   // pushed before the consumers start, so each consumer sees a falling sequence
+   void test_threads_orderPerProducer()
+   {  // setup
+      const int numThreads = 4;
+      custom::skiplist_priority_queue <int> q;
+      for (int i = 0; i < 20000; i++)
+         q.push(i);
+      std::vector<int> falling(numThreads, 1);
+      std::vector<std::thread> threads;
+      // exercise
+      for (int t = 0; t < numThreads; t++)
+         threads.push_back(std::thread([&q, &falling, t]()
+         {
+            int previous = 20000;
+            int value;
+            while (q.try_pop(value))
+            {
+               if (value >= previous)
+                  falling[t] = 0;
+               previous = value;
+            }
+         }));
+      for (size_t i = 0; i < threads.size(); i++)
+         threads[i].join();
+      // verify
+      for (int t = 0; t < numThreads; t++)
+         assertUnit(falling[t]);
+      assertUnit(q.empty());
+   }  // teardown
+};
+
+#endif // DEBUG
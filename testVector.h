@@ -14,6 +14,7 @@
 #include <vector>
 #include "vector.h"
 #include "unitTest.h"
+#include "spy.h"
 
 
 #include <cassert>
@@ -86,6 +87,9 @@ public:
       test_pushback_moveEmpty();
       test_pushback_moveExcessCapacity();
       test_pushback_moveRequireReallocate();
+      test_emplaceback_empty();
+      test_emplaceback_requireReallocate();
+      test_emplaceback_noCopies();
       test_resize_emptyZero();
       test_resize_emptyFourDefault();
       test_resize_emptyFourValue();
@@ -107,6 +111,7 @@ public:
       test_clear_empty();
       test_clear_full();
       test_clear_partiallyFilled();
+      test_clear_releasesElements();
       test_shrink_empty();
       test_shrink_toEmpty();
       test_shrink_standard();
@@ -137,7 +142,7 @@ public:
       v.numCapacity = 99;
       v.numElements = 99;
       // exercise
-      alloc.construct(&v); // call the constructor by itself
+      std::allocator_traits<std::allocator<custom::vector<int>>>::construct(alloc, &v); // call the constructor by itself
       // verify
       assertEmptyFixture(v);
    }  // teardown
@@ -152,7 +157,7 @@ public:
       v.numCapacity = 99;
       v.numElements = 99;
       // exercise
-      alloc.construct(&v, 0); // call the constructor by itself
+      std::allocator_traits<std::allocator<custom::vector<int>>>::construct(alloc, &v, 0); // call the constructor by itself
       // verify
       assertEmptyFixture(v);
       
@@ -168,7 +173,7 @@ public:
       v.numCapacity = 99;
       v.numElements = 99;
       // exercise
-      alloc.construct(&v, 4); // call the constructor by itself
+      std::allocator_traits<std::allocator<custom::vector<int>>>::construct(alloc, &v, 4); // call the constructor by itself
       // verify
       //      0    1    2    3
       //    +----+----+----+----+
@@ -202,7 +207,7 @@ public:
       v.numCapacity = 99;
       v.numElements = 99;
       // exercise
-      alloc.construct(&v, 4, 99); // call the constructor by itself
+      std::allocator_traits<std::allocator<custom::vector<int>>>::construct(alloc, &v, 4, 99); // call the constructor by itself
       // verify
       //      0    1    2    3
       //    +----+----+----+----+
@@ -1607,6 +1612,23 @@ public:
    }
    
    
+   // clear lets go of what the elements held
+   void test_clear_releasesElements()
+   {  // setup
+      std::shared_ptr<int> p = std::make_shared<int>(26);
+      custom::vector<std::shared_ptr<int>> v;
+      v.push_back(p);
+      v.push_back(p);
+      assertUnit(p.use_count() == 3);
+      // exercise
+      v.clear();
+      // verify
+      assertUnit(p.use_count() == 1);
+      assertUnit(v.numElements == 0);
+      assertUnit(v.numCapacity >= 2);
+   }  // teardown
+   
+   
    /***************************************
     * PUSH BACK
     ***************************************/
@@ -1769,6 +1791,87 @@ public:
       teardownStandardFixture(v);
    }
    
+   // build an element at the back when empty
+   void test_emplaceback_empty()
+   {  // setup
+      custom::vector<int> v;
+      // exercise
+      int & back = v.emplace_back(99);
+      // verify
+      //      0
+      //    +----+
+      //    | 99 |
+      //    +----+
+      assertUnit(v.data != nullptr);
+      if (v.data)
+      {
+         assertUnit(v.data[0] == int(99));
+         assertUnit(&back == v.data);
+      }
+      assertUnit(v.numCapacity == 1);
+      assertUnit(v.numElements == 1);
+      // teardown
+      teardownStandardFixture(v);
+   }
+
+   // build an element at the back when there is not room. Capacity should double
+   void test_emplaceback_requireReallocate()
+   {  // setup
+      //      0    1    2
+      //    +----+----+----+
+      //    | 26 | 49 | 67 |
+      //    +----+----+----+
+      custom::vector<int> v;
+      v.data = new int[3];
+      v.data[0] = 26;
+      v.data[1] = 49;
+      v.data[2] = 67;
+      v.numElements = 3;
+      v.numCapacity = 3;
+      // exercise
+      v.emplace_back(99);
+      // verify
+      //      0    1    2    3    4    5
+      //    +----+----+----+----+----+----+
+      //    | 26 | 49 | 67 | 99 |    |    |
+      //    +----+----+----+----+----+----+
+      assertUnit(v.data != nullptr);
+      if (v.data)
+      {
+         assertUnit(v.data[0] == int(26));
+         assertUnit(v.data[2] == int(67));
+         if (v.numElements > 3)
+            assertUnit(v.data[3] == int(99));
+      }
+      assertUnit(v.numCapacity == 6);
+      assertUnit(v.numElements == 4);
+      // teardown
+      teardownStandardFixture(v);
+   }
+
+   // with room to spare the element is built in its slot: no copy, no move
+   void test_emplaceback_noCopies()
+   {  // setup
+      custom::vector<Spy> v;
+      v.reserve(4);
+      Spy::reset();
+      // exercise
+      v.emplace_back(26);
+      v.emplace_back(49);
+      // verify
+      assertUnit(Spy::numNondefault() == 2);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      assertUnit(v.numElements == 2);
+      if (v.numElements == 2)
+      {
+         assertUnit(v.data[0].get() == 26);
+         assertUnit(v.data[1].get() == 49);
+      }
+   }  // teardown
+
    // add an element to the back when there is not room. Capacity should double
    void test_pushback_moveRequireReallocate()
    {  // setup
@@ -0,0 +1,157 @@
+/***********************************************************************
+ * Header:
+ *    THREAD SLOTS
+ * Summary:
+ *    Remembers, for every thread, which per-thread slot it claimed in
+ *    each concurrent container it has used, and gives the slot back
+ *    when the thread exits
+ *
+ *    This will contain the class definition of:
+ *        thread_slots           : One container's side of the bookkeeping
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <atomic>       // for std::atomic
+#include <mutex>        // for std::mutex
+#include <memory>       // for std::shared_ptr
+#include "vector.h"
+
+namespace custom
+{
+
+/*************************************************
+ * THREAD SLOTS
+ * A container that hands each thread a slot of its
+ * own keeps one of these. Every thread has a list of
+ * (container, slot) entries that is only ever touched
+ * by that thread, so finding the slot takes no lock.
+ * An entry stays for as long as its container lives:
+ * one thread can use any number of containers without
+ * losing its slot in any of them. When the thread
+ * exits, release(container, slot) runs for every
+ * container still alive, which moves what is left in
+ * the slot somewhere shared and frees the slot for the
+ * next thread. Entries of destroyed containers are
+ * dropped the next time the thread claims a slot.
+ *************************************************/
+class thread_slots
+{
+public:
+   typedef void (* Release)(void * container, void * slot);
+
+   thread_slots(void * container, Release release) :
+      owner(std::make_shared<Owner>(container, release)) {}
+   thread_slots(const thread_slots &) = delete;
+   thread_slots & operator = (const thread_slots &) = delete;
+  ~thread_slots() { close(); }
+
+   void   close();                // no release runs after this; call before the slots go
+   void * find() const;           // the slot of the calling thread, or nullptr
+   void   remember(void * slot);  // the calling thread has just claimed slot
+
+private:
+   // shared by the container and every thread that has a slot in it
+   struct Owner
+   {
+      Owner(void * container, Release release) :
+         container(container), release(release), alive(true) {}
+      std::mutex        lock;       // held while a thread exits and while the container dies
+      void *            container;
+      Release           release;
+      std::atomic<bool> alive;
+   };
+
+   struct Entry
+   {
+      std::shared_ptr<Owner> owner;
+      void *                 slot;
+   };
+
+   // the calling thread's entries; released when it exits
+   struct Thread
+   {
+     ~Thread();
+      custom::vector<Entry> entries;
+   };
+
+   static Thread & local()
+   {
+      thread_local Thread thread;
+      return thread;
+   }
+
+   std::shared_ptr<Owner> owner;
+};
+
+/************************************************
+ * THREAD SLOTS :: CLOSE
+ * Once this returns no exiting thread will touch the
+ * container, and one that is exiting now has finished
+ ***********************************************/
+inline void thread_slots::close()
+{
+   std::lock_guard<std::mutex> guard(owner->lock);
+   owner->alive.store(false);
+}
+
+/************************************************
+ * THREAD SLOTS :: FIND
+ ***********************************************/
+inline void * thread_slots::find() const
+{
+   Thread & thread = local();
+   for (size_t i = 0; i < thread.entries.size(); i++)
+      if (thread.entries[i].owner == owner)
+         return thread.entries[i].slot;
+   return nullptr;
+}
+
+/************************************************
+ * THREAD SLOTS :: REMEMBER
+ * Drop the entries of dead containers first so the
+ * list is only as long as the live ones
+ ***********************************************/
+inline void thread_slots::remember(void * slot)
+{
+   Thread & thread = local();
+   assert(find() == nullptr);
+
+   size_t numLive = 0;
+   for (size_t i = 0; i < thread.entries.size(); i++)
+      if (thread.entries[i].owner->alive.load())
+      {
+         if (i != numLive)
+            thread.entries[numLive] = std::move(thread.entries[i]);
+         numLive++;
+      }
+   // pop_back leaves the slot constructed, so let go of the owner first
+   while (thread.entries.size() > numLive)
+   {
+      thread.entries.back().owner.reset();
+      thread.entries.pop_back();
+   }
+
+   Entry entry = { owner, slot };
+   thread.entries.push_back(std::move(entry));
+}
+
+/************************************************
+ * THREAD SLOTS :: THREAD :: DESTRUCTOR
+ * Give back every slot of a container still alive.
+ * The owner lock keeps the container from dying
+ * until the release is done.
+ ***********************************************/
+inline thread_slots::Thread::~Thread()
+{
+   for (size_t i = 0; i < entries.size(); i++)
+   {
+      Owner & owner = *entries[i].owner;
+      std::lock_guard<std::mutex> guard(owner.lock);
+      if (owner.alive.load())
+         owner.release(owner.container, entries[i].slot);
+   }
+}
+
+};
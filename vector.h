@@ -24,6 +24,7 @@
 #include <cassert>  // because I am paranoid
 #include <new>      // std::bad_alloc
 #include <memory>   // for std::allocator
+#include <utility>  // for std::forward
 
 class TestVector; // forward declaration for unit tests
 class TestStack;
@@ -91,6 +92,8 @@ public:
 
    void push_back(const T& t);
    void push_back(T&& t);
+   template <class ... Args>
+   T &  emplace_back(Args && ... args);
    void reserve(size_t newCapacity);
    void resize(size_t newElements);
    void resize(size_t newElements, const T& t);
@@ -261,13 +264,13 @@ vector<T>::vector(vector&& rhs) : data(rhs.data), numCapacity(rhs.numCapacity),
 
 /*****************************************
  * VECTOR :: DESTRUCTOR
- * Call the destructor for each element from 0..numElements
- * and then free the memory
+ * Free the memory. delete [] calls the destructor
+ * for every slot of the array
  ****************************************/
 template <typename T>
 vector<T>::~vector()
 {
-   clear();
+   delete [] data;
 }
 
 /*****************************************
@@ -309,7 +312,7 @@ vector<T>& vector<T>::operator=(vector&& rhs)
 {
    if (this != &rhs)
    {
-      clear();
+      delete [] data;
       data = rhs.data;
       numCapacity = rhs.numCapacity;
       numElements = rhs.numElements;
@@ -352,6 +355,35 @@ void vector<T>::push_back(T&& t)
    data[numElements++] = std::move(t);
 }
 
+/*****************************************
+ * VECTOR :: EMPLACE BACK
+ * Build a new element at the end from args, with no
+ * temporary to copy or move. The slot already holds a
+ * default-constructed T, so destroy that one and
+ * construct in its place; if the constructor throws,
+ * put a default one back so delete [] stays balanced.
+ ****************************************/
+template <typename T>
+template <class ... Args>
+T & vector<T>::emplace_back(Args && ... args)
+{
+   if (numElements == numCapacity)
+      reserve(numCapacity == 0 ? 1 : numCapacity * 2);
+   T * p = data + numElements;
+   p->~T();
+   try
+   {
+      new (p) T(std::forward<Args>(args)...);
+   }
+   catch (...)
+   {
+      new (p) T();
+      throw;
+   }
+   numElements++;
+   return *p;
+}
+
 /*****************************************
  * VECTOR :: RESERVE
  * This method will grow the current buffer
@@ -399,14 +431,16 @@ void vector<T>::resize(size_t newElements, const T& t)
 
 /*****************************************
  * VECTOR :: CLEAR
- * Deletes data and resets number of elements but maintains capacity
+ * Resets number of elements but maintains capacity
  ****************************************/
 template <typename T>
 void vector<T>::clear()
 {
-   // Call destructor on each element
-   for (size_t i = 0; i < numElements; ++i)
-      data[i].~T();
+   // Every slot of the array stays constructed so push_back can assign
+   // into it; delete [] destroys them all when the array is freed.
+   // Assigning a default value lets go of what the old elements held.
+   for (size_t i = 0; i < numElements; i++)
+      data[i] = T();
    numElements = 0;
    // data remains allocated
    // numCapacity remains unchanged